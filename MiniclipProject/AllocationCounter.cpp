@@ -0,0 +1,67 @@
+#include "AllocationCounter.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+namespace {
+std::atomic<uint64_t> AllocationCount = 0;
+std::atomic<uint64_t> DeallocationCount = 0;
+}
+
+uint64_t AllocationCounter::GetAllocationCount()
+{
+    return AllocationCount.load(std::memory_order_relaxed);
+}
+
+uint64_t AllocationCounter::GetDeallocationCount()
+{
+    return DeallocationCount.load(std::memory_order_relaxed);
+}
+
+// The nothrow forms of the standard library call these, so they are counted as well
+
+void* operator new(std::size_t size)
+{
+    AllocationCount.fetch_add(1, std::memory_order_relaxed);
+
+    while (true) {
+        if (void* memory = std::malloc(size == 0 ? 1 : size)) {
+            return memory;
+        }
+
+        auto newHandler = std::get_new_handler();
+        if (!newHandler) {
+            throw std::bad_alloc();
+        }
+        newHandler();
+    }
+}
+
+void* operator new[](std::size_t size)
+{
+    return operator new(size);
+}
+
+void operator delete(void* memory) noexcept
+{
+    if (memory) {
+        DeallocationCount.fetch_add(1, std::memory_order_relaxed);
+        std::free(memory);
+    }
+}
+
+void operator delete[](void* memory) noexcept
+{
+    operator delete(memory);
+}
+
+void operator delete(void* memory, std::size_t) noexcept
+{
+    operator delete(memory);
+}
+
+void operator delete[](void* memory, std::size_t) noexcept
+{
+    operator delete(memory);
+}
@@ -0,0 +1,12 @@
+#pragma once
+
+#include <cstdint>
+
+// Counts the calls to the global operator new and delete of the whole program, so a long run can tell
+// if memory is leaking or if frames allocate more than they should. The counting replaces the global operators,
+// so it's only linked into the game and RollbackBenchmark, where it costs an atomic increment per allocation.
+class AllocationCounter {
+public:
+    static uint64_t GetAllocationCount();
+    static uint64_t GetDeallocationCount();
+};
@@ -12,7 +12,7 @@ static constexpr const char* const TileDisappearEffectPath = "./Assets/Sounds/di
 }
 
 AudioPlayer::AudioPlayer()
-    : _randomEngine(_randomDevice())
+    : _random(RandomGenerator::MakeSeed())
 {
 }
 
@@ -53,8 +53,6 @@ bool AudioPlayer::Initialize()
 
     LoadSoundEffects();
 
-    _randomDistribution = std::uniform_int_distribution<int>(0, int(_backgroundTracks.size() - 1));
-
     return true;
 }
 
@@ -73,7 +71,7 @@ void AudioPlayer::Update()
         return;
 
     if (Mix_PlayingMusic() == 0) {
-        auto newTrackIndex = _randomDistribution(_randomEngine);
+        auto newTrackIndex = _random.NextInt(int(_backgroundTracks.size()));
         if (newTrackIndex == _lastPlayedMusicIndex) {
             newTrackIndex = (newTrackIndex + 1) % _backgroundTracks.size();
         }
@@ -1,15 +1,15 @@
 #pragma once
 
+#include "IAudioSink.h"
+#include "RandomGenerator.h"
+
 #include <SDL_mixer.h>
 
-#include <random>
 #include <unordered_map>
 #include <vector>
 
-class AudioPlayer {
+class AudioPlayer : public IAudioSink {
 public:
-    enum class SoundEffect { TileDisappear };
-
     AudioPlayer();
     ~AudioPlayer();
 
@@ -17,15 +17,13 @@ public:
     void ToggleIsMusicEnabled();
     void Update();
 
-    void PlaySoundEffect(SoundEffect effect);
+    void PlaySoundEffect(SoundEffect effect) override;
 
 private:
     std::vector<Mix_Music*> _backgroundTracks;
     int _lastPlayedMusicIndex = 0;
 
-    std::random_device _randomDevice;
-    std::mt19937 _randomEngine;
-    std::uniform_int_distribution<int> _randomDistribution;
+    RandomGenerator _random;
 
     std::unordered_map<SoundEffect, Mix_Chunk*> _soundEffects;
 
@@ -0,0 +1,188 @@
+#include "AutoplayDriver.h"
+
+#include <string>
+
+namespace {
+SDL_Event MakeMouseButtonEvent(Uint32 type, Vec2 position)
+{
+    SDL_Event event {};
+    event.button.type = type;
+    event.button.timestamp = SDL_GetTicks();
+    event.button.button = SDL_BUTTON_LEFT;
+    event.button.state = type == SDL_MOUSEBUTTONDOWN ? SDL_PRESSED : SDL_RELEASED;
+    event.button.clicks = 1;
+    event.button.x = position.x;
+    event.button.y = position.y;
+
+    return event;
+}
+
+SDL_Event MakeMouseMotionEvent(Vec2 from, Vec2 to, bool isButtonDown)
+{
+    SDL_Event event {};
+    event.motion.type = SDL_MOUSEMOTION;
+    event.motion.timestamp = SDL_GetTicks();
+    event.motion.state = isButtonDown ? SDL_BUTTON_LMASK : 0;
+    event.motion.x = to.x;
+    event.motion.y = to.y;
+    event.motion.xrel = to.x - from.x;
+    event.motion.yrel = to.y - from.y;
+
+    return event;
+}
+
+SDL_Event MakeKeyDownEvent(SDL_Keycode key)
+{
+    SDL_Event event {};
+    event.key.type = SDL_KEYDOWN;
+    event.key.timestamp = SDL_GetTicks();
+    event.key.state = SDL_PRESSED;
+    event.key.keysym.sym = key;
+    event.key.keysym.scancode = SDL_GetScancodeFromKey(key);
+
+    return event;
+}
+}
+
+AutoplayDriver::AutoplayDriver(GameWorld& gameWorld, const MainMenu& menu, SoakMonitor& soakMonitor, uint64_t seed, uint64_t durationMs)
+    : _gameWorld(&gameWorld)
+    , _menu(&menu)
+    , _soakMonitor(&soakMonitor)
+    , _random(seed, 3) // The board uses streams 0 and 1, the bots 2
+    , _durationMs(durationMs)
+    , _cellsSwitchedToken(gameWorld.CellsSwitched.Subscribe([this](Vec2, Vec2) {
+        _idleMs = 0;
+        _hasReportedStuckState = false;
+        _soakMonitor->RecordMove();
+    }))
+{
+}
+
+void AutoplayDriver::Update(bool isPlaying, uint64_t deltaTimeMs)
+{
+    _elapsedMs += deltaTimeMs;
+
+    if (_durationMs > 0 && _elapsedMs >= _durationMs) {
+        if (!_hasQuit) {
+            SDL_Event event {};
+            event.quit.type = SDL_QUIT;
+            event.quit.timestamp = SDL_GetTicks();
+            PushEvents({ event });
+            _hasQuit = true;
+        }
+        return;
+    }
+
+    if (isPlaying) {
+        _idleMs += deltaTimeMs;
+        if (_idleMs >= StuckTimeoutMs && !_hasReportedStuckState) {
+            _soakMonitor->RecordProblem("No switch was accepted for " + std::to_string(_idleMs / 1000) + " s, interaction is "
+                + (_gameWorld->IsInteractionEnabled() ? "enabled" : "disabled") + ", the board is " + (_gameWorld->IsSettled() ? "settled" : "moving") + ", "
+                + std::to_string(_gameWorld->GetAvailableMoves().size()) + " available moves");
+            _hasReportedStuckState = true;
+        }
+    } else {
+        _idleMs = 0;
+    }
+
+    if (!_steps.empty()) {
+        PushEvents(_steps.front());
+        _steps.pop_front();
+        return;
+    }
+
+    if (_waitMs > deltaTimeMs) {
+        _waitMs -= deltaTimeMs;
+        return;
+    }
+    _waitMs = 0;
+
+    if (isPlaying) {
+        if (_gameWorld->IsInteractionEnabled()) {
+            PlanMove();
+        }
+    } else {
+        PlanMenuClick();
+    }
+}
+
+void AutoplayDriver::PlanMove()
+{
+    if (_random.NextInt(PauseOneIn) == 0) {
+        _steps.push_back({ MakeKeyDownEvent(SDLK_ESCAPE) });
+        return;
+    }
+
+    auto legalMoves = _gameWorld->GetAvailableMoves();
+    if (legalMoves.empty()) {
+        return;
+    }
+
+    const auto& move = legalMoves[size_t(_random.NextInt(int(legalMoves.size())))];
+    auto source = _gameWorld->GetCellCenter(move.Source);
+    auto destination = _gameWorld->GetCellCenter(move.Destination);
+
+    QueueMouseMotion(source, false);
+
+    if (_random.NextInt(2) == 0) {
+        // Dragged over, the board switches the cells as soon as the tile is dragged far enough
+        _steps.push_back({ MakeMouseButtonEvent(SDL_MOUSEBUTTONDOWN, source) });
+        for (int i = 1; i <= DragStepCount; ++i) {
+            QueueMouseMotion(source + (destination - source) * i / DragStepCount, true);
+        }
+        _steps.push_back({ MakeMouseButtonEvent(SDL_MOUSEBUTTONUP, destination) });
+    } else {
+        // Selected by clicking on one cell and then on the other
+        QueueClick(source);
+        QueueMouseMotion(destination, false);
+        QueueClick(destination);
+    }
+
+    // Like a player looking at the board before the next move. Sometimes long enough for the hint to show up.
+    _waitMs = _random.NextInt(20) == 0 ? 6000 : uint64_t(100 + _random.NextInt(500));
+}
+
+void AutoplayDriver::PlanMenuClick()
+{
+    std::optional<Vec2> button;
+
+    if ((button = _menu->GetButtonCenter(ButtonType::Back))) {
+        // The leaderboard is showing
+    } else if ((button = _menu->GetButtonCenter(ButtonType::Resume))) {
+        // The game was paused
+    } else if (_random.NextInt(LeaderboardOneIn) == 0) {
+        button = _menu->GetButtonCenter(ButtonType::Leaderboard);
+    } else {
+        // The modes take turns, so both get played for the same number of games
+        button = _menu->GetButtonCenter(_nextGameMode == 0 ? ButtonType::Classic : ButtonType::QuickDeath);
+        _nextGameMode = 1 - _nextGameMode;
+    }
+
+    if (button) {
+        QueueMouseMotion(*button, false);
+        QueueClick(*button);
+    }
+
+    _waitMs = 500;
+}
+
+void AutoplayDriver::QueueMouseMotion(Vec2 position, bool isButtonDown)
+{
+    _steps.push_back({ MakeMouseMotionEvent(_cursorPosition, position, isButtonDown) });
+    _cursorPosition = position;
+}
+
+void AutoplayDriver::QueueClick(Vec2 position)
+{
+    _steps.push_back({ MakeMouseButtonEvent(SDL_MOUSEBUTTONDOWN, position), MakeMouseButtonEvent(SDL_MOUSEBUTTONUP, position) });
+    _cursorPosition = position;
+}
+
+void AutoplayDriver::PushEvents(const std::vector<SDL_Event>& events)
+{
+    for (auto event : events) {
+        if (SDL_PushEvent(&event) < 0) {
+            _soakMonitor->RecordProblem(std::string("Failed to push an event: ") + SDL_GetError());
+        }
+    }
+}
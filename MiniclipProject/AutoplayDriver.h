@@ -0,0 +1,60 @@
+#pragma once
+
+#include "Event.h"
+#include "GameWorld.h"
+#include "MainMenu.h"
+#include "RandomGenerator.h"
+#include "SoakMonitor.h"
+#include "Vec2.h"
+
+#include <SDL.h>
+
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <vector>
+
+// Plays the game unattended by pushing synthesized mouse and keyboard events into the SDL event queue.
+// They go through Game::ProcessEvents, InputProcessor, Player and MainMenu the same way as the events of a real mouse,
+// so everything a player can trigger (drags, clicks, pausing, the menus, animations, audio, high scores) runs as in real play.
+class AutoplayDriver {
+public:
+    // Reported once when the board doesn't accept a switch for this long during a game
+    static constexpr uint64_t StuckTimeoutMs = 30 * 1000;
+
+    // With a duration of 0 the game is played until the window is closed
+    AutoplayDriver(GameWorld& gameWorld, const MainMenu& menu, SoakMonitor& soakMonitor, uint64_t seed, uint64_t durationMs);
+
+    // Call once per frame, before the events are processed. isPlaying tells if the board or the menu takes the input.
+    void Update(bool isPlaying, uint64_t deltaTimeMs);
+
+private:
+    // A drag is spread over several frames like a real one, every frame pushes the events of the next step
+    static constexpr int DragStepCount = 6;
+    // One move in this many pauses the game before it, to go through the menu and back
+    static constexpr int PauseOneIn = 40;
+    // The menu shows the leaderboard this often before a new game is started
+    static constexpr int LeaderboardOneIn = 5;
+
+    GameWorld* _gameWorld;
+    const MainMenu* _menu;
+    SoakMonitor* _soakMonitor;
+    RandomGenerator _random;
+    uint64_t _durationMs;
+    std::unique_ptr<EventToken> _cellsSwitchedToken;
+
+    std::deque<std::vector<SDL_Event>> _steps;
+    Vec2 _cursorPosition { 0, 0 };
+    uint64_t _elapsedMs = 0;
+    uint64_t _waitMs = 0;
+    uint64_t _idleMs = 0;
+    bool _hasReportedStuckState = false;
+    bool _hasQuit = false;
+    int _nextGameMode = 0;
+
+    void PlanMove();
+    void PlanMenuClick();
+    void QueueMouseMotion(Vec2 position, bool isButtonDown);
+    void QueueClick(Vec2 position);
+    void PushEvents(const std::vector<SDL_Event>& events);
+};
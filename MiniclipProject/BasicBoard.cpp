@@ -0,0 +1,46 @@
+#include "BasicBoard.h"
+
+namespace {
+template <int Rows, int Cols, int Kinds>
+constexpr FixedBoardFunctions MakeFixedBoardFunctions()
+{
+    using FixedBoard = BasicBoard<Rows, Cols, Kinds>;
+
+    return FixedBoardFunctions {
+        [](const Board& board) {
+            return FixedBoard::FindMatches(board.TypeData()).ToDestructionData();
+        },
+        [](const Board& board, Vec2 lhs, Vec2 rhs) {
+            return FixedBoard::FindMatchesAfterSwap(board.TypeData(), lhs, rhs).ToDestructionData();
+        },
+        [](Board& board, BoardGenerator& boardGenerator, GravityResult& result) {
+            FixedBoard::ApplyGravity(board.TypeData(), board.StateData(), boardGenerator, result);
+        },
+    };
+}
+
+struct FixedBoardConfiguration {
+    int ColCount;
+    int RowCount;
+    int TileKindCount;
+    FixedBoardFunctions Functions;
+};
+
+// The configurations the game and the tools actually use. Each one costs a copy of the scanning code, so only add the common ones.
+constexpr FixedBoardConfiguration FixedBoardConfigurations[] = {
+    { 8, 8, 5, MakeFixedBoardFunctions<8, 8, 5>() },
+    { 8, 8, 6, MakeFixedBoardFunctions<8, 8, 6>() },
+    { 10, 10, 6, MakeFixedBoardFunctions<10, 10, 6>() },
+};
+}
+
+const FixedBoardFunctions* FindFixedBoardFunctions(int colCount, int rowCount, int tileKindCount)
+{
+    for (const auto& configuration : FixedBoardConfigurations) {
+        if (configuration.ColCount == colCount && configuration.RowCount == rowCount && configuration.TileKindCount == tileKindCount) {
+            return &configuration.Functions;
+        }
+    }
+
+    return nullptr;
+}
@@ -0,0 +1,245 @@
+#pragma once
+
+#include "Board.h"
+#include "BoardGenerator.h"
+#include "CascadeResolver.h"
+#include "CellMask.h"
+#include "MatchDetector.h"
+#include "Vec2.h"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+
+// The board rules for a size and tile kind count that are known at compile time. Every loop bound is a constant,
+// so the scans unroll, and a whole column fits into a single word.
+// MatchDetector and CascadeResolver use these for the sizes listed in BasicBoard.cpp and the runtime sized loops for everything else.
+template <int Rows, int Cols, int Kinds>
+class BasicBoard {
+public:
+    static_assert(Rows >= 1 && Rows <= 64, "A column has to fit into a single word");
+    static_assert(Cols >= 1 && Kinds >= 1 && Kinds <= 256);
+
+    static constexpr int RowCount = Rows;
+    static constexpr int ColCount = Cols;
+    static constexpr int TileKindCount = Kinds;
+    static constexpr int CellCount = Rows * Cols;
+
+    // Bit y of word x is the cell at column x and row y, so a whole column is a single word
+    using ColumnMasks = std::array<uint64_t, Cols>;
+
+    struct Matches {
+        ColumnMasks Destroyed {};
+        int HighestRowCombo = 0;
+        int HighestColumnCombo = 0;
+
+        bool Any() const
+        {
+            return std::any_of(Destroyed.begin(), Destroyed.end(), [](uint64_t column) { return column != 0; });
+        }
+
+        CellDestructionData ToDestructionData() const
+        {
+            CellMask destroyedMask(Cols, Rows);
+            for (int x = 0; x < Cols; ++x) {
+                for (auto column = Destroyed[x]; column != 0; column &= column - 1) {
+                    destroyedMask.Set(Vec2 { x, std::countr_zero(column) });
+                }
+            }
+
+            return CellDestructionData(std::move(destroyedMask), HighestRowCombo, HighestColumnCombo);
+        }
+    };
+
+    BasicBoard()
+    {
+        _states.fill(CellState::Normal);
+    }
+
+    uint8_t& Type(Vec2 index) { return _types[IndexOf(index)]; }
+    uint8_t Type(Vec2 index) const { return _types[IndexOf(index)]; }
+    CellState& State(Vec2 index) { return _states[IndexOf(index)]; }
+    CellState State(Vec2 index) const { return _states[IndexOf(index)]; }
+
+    void CopyFrom(const Board& board)
+    {
+        assert(board.GetColCount() == Cols && board.GetRowCount() == Rows);
+        std::copy(board.TypeData(), board.TypeData() + CellCount, _types.begin());
+        std::copy(board.StateData(), board.StateData() + CellCount, _states.begin());
+    }
+
+    void CopyTo(Board& board) const
+    {
+        assert(board.GetColCount() == Cols && board.GetRowCount() == Rows);
+        std::copy(_types.begin(), _types.end(), board.TypeData());
+        std::copy(_states.begin(), _states.end(), board.StateData());
+    }
+
+    Matches FindMatches() const { return FindMatches(_types.data()); }
+    void ApplyGravity(BoardGenerator& boardGenerator, GravityResult& result) { ApplyGravity(_types.data(), _states.data(), boardGenerator, result); }
+
+    // The static versions work on column major arrays, laid out the same way as the ones of Board
+
+    static Matches FindMatches(const uint8_t* types)
+    {
+        // Runs are found from the cells that are equal to their neighbour, so the tile kinds don't have to be separated at all.
+        // sameAsBelow[x] has bit y set if cell (x, y) has the same kind as (x, y + 1), sameAsRight[x] if it's the same as (x + 1, y).
+        ColumnMasks sameAsBelow;
+        std::array<uint64_t, std::max(Cols - 1, 1)> sameAsRight {};
+
+        for (int x = 0; x < Cols; ++x) {
+            const uint8_t* column = types + x * Rows;
+            sameAsBelow[x] = EqualBytes<Rows - 1>(column, column + 1);
+
+            if (x + 1 < Cols) {
+                sameAsRight[x] = EqualBytes<Rows>(column, column + Rows);
+            }
+        }
+
+        Matches matches;
+        matches.HighestColumnCombo = FindColumnRuns(sameAsBelow, matches.Destroyed);
+        matches.HighestRowCombo = FindRowRuns(sameAsRight, matches.Destroyed);
+
+        return matches;
+    }
+
+    static Matches FindMatchesAfterSwap(const uint8_t* types, Vec2 lhs, Vec2 rhs)
+    {
+        // Scanning a swapped copy of the whole board is cheaper than scanning the affected lines one cell at a time
+        std::array<uint8_t, CellCount> swapped;
+        std::copy(types, types + CellCount, swapped.begin());
+        std::swap(swapped[IndexOf(lhs)], swapped[IndexOf(rhs)]);
+
+        return FindMatches(swapped.data());
+    }
+
+    // Same result (including the order of the moves and of the generated tiles) as CascadeResolver::ApplyGravity
+    static void ApplyGravity(uint8_t* types, CellState* states, BoardGenerator& boardGenerator, GravityResult& result)
+    {
+        result.Reset(Cols, CellCount);
+
+        for (int x = 0; x < Cols; ++x) {
+            CascadeResolver::ApplyGravityToColumn(x, types + x * Rows, states + x * Rows, Rows, boardGenerator, result);
+        }
+    }
+
+private:
+    std::array<uint8_t, CellCount> _types {};
+    std::array<CellState, CellCount> _states;
+
+    static constexpr int IndexOf(Vec2 index)
+    {
+        assert(index.x >= 0 && index.x < Cols && index.y >= 0 && index.y < Rows);
+        return index.x * Rows + index.y;
+    }
+
+    // Bit i of the result is set if a[i] == b[i], for the first Count bytes
+    template <int Count>
+    static uint64_t EqualBytes(const uint8_t* a, const uint8_t* b)
+    {
+        static_assert(std::endian::native == std::endian::little, "The bytes are expected in memory order in the words");
+
+        uint64_t equal = 0;
+        int i = 0;
+
+        // 8 bytes at a time: a byte of the difference is 0 if and only if its high bit ends up set below
+        for (; i + 8 <= Count; i += 8) {
+            uint64_t aBytes, bBytes;
+            std::memcpy(&aBytes, a + i, 8);
+            std::memcpy(&bBytes, b + i, 8);
+
+            constexpr uint64_t Low7Bits = 0x7F7F7F7F7F7F7F7Full;
+            auto difference = aBytes ^ bBytes;
+            auto zeroBytes = ~(((difference & Low7Bits) + Low7Bits) | difference | Low7Bits);
+
+            // Gathers the high bit of every byte into the top byte of the product
+            equal |= (((zeroBytes >> 7) * 0x0102040810204080ull) >> 56) << i;
+        }
+
+        for (; i < Count; ++i) {
+            equal |= uint64_t(a[i] == b[i]) << i;
+        }
+
+        return equal;
+    }
+
+    static int FindColumnRuns(const ColumnMasks& sameAsBelow, ColumnMasks& destroyed)
+    {
+        int longestRun = 0;
+
+        for (int x = 0; x < Cols; ++x) {
+            // A run of 3 starts at every cell that is the same as the next 2 below it
+            auto runStarts = sameAsBelow[x] & (sameAsBelow[x] >> 1);
+            if (runStarts == 0) {
+                continue;
+            }
+
+            destroyed[x] |= runStarts | (runStarts << 1) | (runStarts << 2);
+
+            int runLength = MatchDetector::MinimumRunLength;
+            while ((runStarts &= sameAsBelow[x] >> (runLength - 1)) != 0) {
+                ++runLength;
+            }
+
+            longestRun = std::max(longestRun, runLength);
+        }
+
+        return longestRun;
+    }
+
+    template <size_t Size>
+    static int FindRowRuns(const std::array<uint64_t, Size>& sameAsRight, ColumnMasks& destroyed)
+    {
+        if constexpr (Cols < MatchDetector::MinimumRunLength) {
+            return 0;
+        } else {
+            constexpr int StartCount = Cols - 2;
+
+            std::array<uint64_t, StartCount> runStarts;
+            uint64_t anyRun = 0;
+
+            for (int x = 0; x < StartCount; ++x) {
+                runStarts[x] = sameAsRight[x] & sameAsRight[x + 1];
+                anyRun |= runStarts[x];
+            }
+
+            if (anyRun == 0) {
+                return 0;
+            }
+
+            for (int x = 0; x < StartCount; ++x) {
+                destroyed[x] |= runStarts[x];
+                destroyed[x + 1] |= runStarts[x];
+                destroyed[x + 2] |= runStarts[x];
+            }
+
+            int longestRun = MatchDetector::MinimumRunLength;
+            for (; longestRun < Cols; ++longestRun) {
+                anyRun = 0;
+                for (int x = 0; x < Cols - longestRun; ++x) {
+                    runStarts[x] &= sameAsRight[x + longestRun - 1];
+                    anyRun |= runStarts[x];
+                }
+
+                if (anyRun == 0) {
+                    break;
+                }
+            }
+
+            return longestRun;
+        }
+    }
+};
+
+// The entry points of a BasicBoard instantiation, working on a runtime sized Board of the same size
+struct FixedBoardFunctions {
+    CellDestructionData (*FindMatches)(const Board& board);
+    CellDestructionData (*FindMatchesAfterSwap)(const Board& board, Vec2 lhs, Vec2 rhs);
+    void (*ApplyGravity)(Board& board, BoardGenerator& boardGenerator, GravityResult& result);
+};
+
+// Returns nullptr if there is no compile-time specialized version for this configuration
+const FixedBoardFunctions* FindFixedBoardFunctions(int colCount, int rowCount, int tileKindCount);
@@ -0,0 +1,82 @@
+// Measures how many new boards (no runs, and optionally a minimum number of legal moves) can be generated per millisecond.
+// Fails if a small board with many kinds, where the generated boards often run out of attempts, ends up with too few moves.
+// Usage: BoardGenerationBenchmark [boards per configuration]
+
+#include "../Board.h"
+#include "../BoardGenerator.h"
+#include "../MoveFinder.h"
+
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace {
+constexpr int BatchSize = 256;
+
+using Clock = std::chrono::steady_clock;
+
+// Printed at the end, so the optimizer can't throw away the results
+size_t Checksum = 0;
+
+double ElapsedMs(Clock::time_point start)
+{
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+void RunBenchmark(int colCount, int rowCount, int tileKindCount, int minLegalMoves, int boardCount)
+{
+    BoardGenerator boardGenerator(tileKindCount, uint64_t(colCount * 100 + tileKindCount));
+    std::vector<Board> boards(BatchSize, Board(colCount, rowCount));
+
+    int batchCount = (boardCount + BatchSize - 1) / BatchSize;
+
+    auto start = Clock::now();
+    for (int i = 0; i < batchCount; ++i) {
+        boardGenerator.FillBoards(boards, minLegalMoves);
+        Checksum += boards[i % BatchSize].Type(Vec2 { 0, 0 });
+    }
+    double elapsedMs = ElapsedMs(start);
+
+    std::cout << colCount << "x" << rowCount << "x" << tileKindCount << ", "
+              << minLegalMoves << ", "
+              << batchCount * BatchSize / elapsedMs << ", "
+              << elapsedMs * 1e6 / (batchCount * BatchSize) << std::endl;
+}
+
+// Returns the number of boards that have fewer than minLegalMoves legal moves
+int CountBoardsWithoutEnoughMoves(int colCount, int rowCount, int tileKindCount, int minLegalMoves, int boardCount)
+{
+    BoardGenerator boardGenerator(tileKindCount, uint64_t(colCount * 100 + tileKindCount));
+    Board board(colCount, rowCount);
+
+    int failedBoardCount = 0;
+    for (int i = 0; i < boardCount; ++i) {
+        bool hasEnoughMoves = boardGenerator.FillBoard(board, minLegalMoves);
+        failedBoardCount += !hasEnoughMoves || MoveFinder::CountLegalMoves(board, minLegalMoves) < minLegalMoves;
+    }
+
+    return failedBoardCount;
+}
+}
+
+int main(int argc, char* argv[])
+{
+    int boardCount = argc > 1 ? std::stoi(argv[1]) : 200000;
+
+    std::cout << "board, min legal moves, boards/ms, ns per board" << std::endl;
+
+    for (int minLegalMoves : { 0, 3 }) {
+        RunBenchmark(8, 8, 5, minLegalMoves, boardCount);
+        RunBenchmark(8, 8, 6, minLegalMoves, boardCount);
+        RunBenchmark(10, 10, 6, minLegalMoves, boardCount);
+        RunBenchmark(16, 12, 7, minLegalMoves, boardCount);
+    }
+
+    int failedBoardCount = CountBoardsWithoutEnoughMoves(3, 4, 8, 3, boardCount / 100);
+    std::cout << "3x4x8 boards with fewer than 3 legal moves: " << failedBoardCount << std::endl;
+
+    std::cout << "checksum: " << Checksum << std::endl;
+
+    return failedBoardCount == 0 ? 0 : 1;
+}
@@ -0,0 +1,80 @@
+// Measures how often a board runs out of legal moves after a cascade settles, for different tile kind counts,
+// and how much the dead board check and the reshuffle cost.
+// Usage: DeadBoardBenchmark [moves per tile kind count]
+
+#include "../Board.h"
+#include "../BoardGenerator.h"
+#include "../CascadeResolver.h"
+#include "../MatchDetector.h"
+#include "../MoveFinder.h"
+#include "../RandomGenerator.h"
+
+#include <chrono>
+#include <iostream>
+#include <string>
+
+namespace {
+constexpr int BoardSize = 8;
+constexpr int MinLegalMovesAfterShuffle = 3;
+
+using Clock = std::chrono::steady_clock;
+
+double ElapsedNs(Clock::time_point start)
+{
+    return double(std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count());
+}
+}
+
+int main(int argc, char* argv[])
+{
+    int movesPerConfiguration = argc > 1 ? std::stoi(argv[1]) : 100000;
+    RandomGenerator moveSelector(12345);
+
+    std::cout << "kinds, settled boards, dead boards, dead %, check ns, shuffle us, failed shuffles" << std::endl;
+
+    for (int tileKindCount = 4; tileKindCount <= 8; ++tileKindCount) {
+        Board board(BoardSize, BoardSize);
+        MatchDetector matchDetector(BoardSize, BoardSize, tileKindCount);
+        BoardGenerator boardGenerator(tileKindCount, uint64_t(tileKindCount));
+        CascadeResolver cascadeResolver(BoardSize, BoardSize, tileKindCount);
+
+        boardGenerator.FillBoard(board, MinLegalMovesAfterShuffle);
+
+        int deadBoards = 0;
+        int failedShuffles = 0;
+        double checkTimeNs = 0;
+        double shuffleTimeNs = 0;
+
+        for (int move = 0; move < movesPerConfiguration; ++move) {
+            auto checkStart = Clock::now();
+            bool isDead = MoveFinder::CountLegalMoves(board, 1) == 0;
+            checkTimeNs += ElapsedNs(checkStart);
+
+            if (isDead) {
+                ++deadBoards;
+
+                auto shuffleStart = Clock::now();
+                if (!boardGenerator.Shuffle(board, MinLegalMovesAfterShuffle)) {
+                    ++failedShuffles;
+                    boardGenerator.FillBoard(board, MinLegalMovesAfterShuffle);
+                }
+                shuffleTimeNs += ElapsedNs(shuffleStart);
+            }
+
+            auto legalMoves = MoveFinder::FindLegalMoves(board, matchDetector);
+            auto& chosenMove = legalMoves[moveSelector.NextInt(int(legalMoves.size()))];
+
+            cascadeResolver.ResolveSwap(board, boardGenerator, chosenMove.Source, chosenMove.Destination);
+        }
+
+        std::cout << tileKindCount << ", "
+                  << movesPerConfiguration << ", "
+                  << deadBoards << ", "
+                  << 100.0 * deadBoards / movesPerConfiguration << ", "
+                  << checkTimeNs / movesPerConfiguration << ", "
+                  << (deadBoards > 0 ? shuffleTimeNs / deadBoards / 1000.0 : 0.0) << ", "
+                  << failedShuffles << std::endl;
+    }
+
+    return 0;
+}
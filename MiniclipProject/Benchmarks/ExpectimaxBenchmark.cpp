@@ -0,0 +1,150 @@
+// Measures how long the expectimax solver takes to score the moves of a board at every depth, with and without
+// its transposition table, and which depth it reaches within the time budget of a frame. Fails if a search with
+// the budget takes noticeably longer than it.
+// Usage: ExpectimaxBenchmark [boards per configuration] [samples] [time budget ms]
+
+#include "../Board.h"
+#include "../BoardGenerator.h"
+#include "../ExpectimaxSolver.h"
+
+#include <algorithm>
+#include <chrono>
+#include <ctime>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace {
+constexpr int ColCount = 8;
+constexpr int RowCount = 8;
+constexpr int TileKindCount = 5;
+constexpr int MaxDepth = 3;
+// The search stops within a poll of the deadline, which is well below this. A search that used more processor time
+// than the budget and this checks its deadline too rarely. One that only took longer on the clock wasn't running all
+// the time, which is only warned about, as the machine may be busy with something else.
+constexpr double AllowedOvershootMs = 0.5;
+
+using Clock = std::chrono::steady_clock;
+
+// Printed at the end, so the optimizer can't throw away the results
+double Checksum = 0.0;
+
+double ElapsedMs(Clock::time_point start)
+{
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+std::vector<Board> MakeBoards(int boardCount)
+{
+    BoardGenerator boardGenerator(TileKindCount, 1);
+    std::vector<Board> boards(size_t(boardCount), Board(ColCount, RowCount));
+    boardGenerator.FillBoards(boards, 1);
+
+    return boards;
+}
+
+const char* GetModeName(GameMode mode)
+{
+    return mode == GameMode::Classic ? "classic" : "quickdeath";
+}
+
+void RunFixedDepth(const std::vector<Board>& boards, GameMode mode, int depth, int sampleCount, bool isUsingTable)
+{
+    ExpectimaxOptions options { depth, sampleCount, ExpectimaxOptions {}.MovesPerBoard, 0.0 };
+    if (!isUsingTable) {
+        options.TranspositionTableBytes = 0;
+    }
+    ExpectimaxSolver solver(ColCount, RowCount, TileKindCount, mode, GameRules {}, options);
+
+    double worstMs = 0.0;
+    uint64_t searchedBoardCount = 0;
+    uint64_t tableHitCount = 0;
+    auto start = Clock::now();
+    for (const auto& board : boards) {
+        auto boardStart = Clock::now();
+        Checksum += solver.ScoreMoves(board).front().ExpectedValue;
+        worstMs = std::max(worstMs, ElapsedMs(boardStart));
+        searchedBoardCount += solver.GetSearchedBoardCount();
+        tableHitCount += solver.GetTableHitCount();
+    }
+    double elapsedMs = ElapsedMs(start);
+
+    std::cout << GetModeName(mode) << ", " << depth << ", " << (isUsingTable ? "yes" : "no") << ", " << elapsedMs / boards.size() << ", " << worstMs
+              << ", " << searchedBoardCount << ", " << tableHitCount << std::endl;
+}
+
+struct Overshoot {
+    double WallMs = 0.0;
+    double ProcessorMs = 0.0;
+};
+
+// Returns how far the slowest searches went over the budget
+Overshoot RunTimeBudget(const std::vector<Board>& boards, GameMode mode, int sampleCount, double timeBudgetMs)
+{
+    ExpectimaxSolver solver(ColCount, RowCount, TileKindCount, mode, GameRules {}, ExpectimaxOptions { MaxDepth, sampleCount, ExpectimaxOptions {}.MovesPerBoard, timeBudgetMs });
+
+    std::vector<int> depthCounts(MaxDepth + 1, 0);
+    double worstMs = 0.0;
+    double worstProcessorMs = 0.0;
+    int overBudgetCount = 0;
+    for (const auto& board : boards) {
+        auto boardStart = Clock::now();
+        auto processorStart = std::clock();
+        Checksum += solver.ScoreMoves(board).front().ExpectedValue;
+        double boardMs = ElapsedMs(boardStart);
+        worstProcessorMs = std::max(worstProcessorMs, 1000.0 * double(std::clock() - processorStart) / CLOCKS_PER_SEC);
+        worstMs = std::max(worstMs, boardMs);
+        overBudgetCount += boardMs > timeBudgetMs + AllowedOvershootMs;
+        ++depthCounts[size_t(solver.GetCompletedDepth())];
+    }
+
+    std::cout << GetModeName(mode) << " within " << timeBudgetMs << " ms, worst " << worstMs << " ms (" << worstProcessorMs << " ms of processor time), "
+              << overBudgetCount << " over it, boards finished at depth";
+    for (int depth = 0; depth <= MaxDepth; ++depth) {
+        std::cout << " " << depth << ": " << depthCounts[size_t(depth)];
+    }
+    std::cout << std::endl;
+
+    return Overshoot { worstMs - timeBudgetMs, worstProcessorMs - timeBudgetMs };
+}
+}
+
+int main(int argc, char* argv[])
+{
+    int boardCount = argc > 1 ? std::stoi(argv[1]) : 100;
+    int sampleCount = argc > 2 ? std::stoi(argv[2]) : ExpectimaxOptions {}.SampleCount;
+    double timeBudgetMs = argc > 3 ? std::stod(argv[3]) : ExpectimaxOptions {}.TimeBudgetMs;
+
+    auto boards = MakeBoards(boardCount);
+
+    std::cout << "mode, depth, table, ms per board, worst ms, boards searched, table hits" << std::endl;
+    for (auto mode : { GameMode::Classic, GameMode::QuickDeath }) {
+        for (int depth = 1; depth <= MaxDepth; ++depth) {
+            for (bool isUsingTable : { false, true }) {
+                RunFixedDepth(boards, mode, depth, sampleCount, isUsingTable);
+            }
+        }
+    }
+
+    Overshoot worstOvershoot;
+    for (auto mode : { GameMode::Classic, GameMode::QuickDeath }) {
+        auto overshoot = RunTimeBudget(boards, mode, sampleCount, timeBudgetMs);
+        worstOvershoot.WallMs = std::max(worstOvershoot.WallMs, overshoot.WallMs);
+        worstOvershoot.ProcessorMs = std::max(worstOvershoot.ProcessorMs, overshoot.ProcessorMs);
+    }
+
+    std::cout << "checksum: " << Checksum << std::endl;
+
+    if (timeBudgetMs <= 0) {
+        return 0;
+    }
+    if (worstOvershoot.ProcessorMs > AllowedOvershootMs) {
+        std::cerr << "A search used " << worstOvershoot.ProcessorMs << " ms of processor time over its budget of " << timeBudgetMs << " ms" << std::endl;
+        return 1;
+    }
+    if (worstOvershoot.WallMs > AllowedOvershootMs) {
+        std::cerr << "Warning: a search took " << worstOvershoot.WallMs << " ms over its budget of " << timeBudgetMs << " ms, while it wasn't running all the time" << std::endl;
+    }
+
+    return 0;
+}
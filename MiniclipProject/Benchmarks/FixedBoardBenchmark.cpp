@@ -0,0 +1,122 @@
+// Compares the compile-time sized BasicBoard scans with the runtime sized ones on the same boards.
+// Usage: FixedBoardBenchmark [iterations]
+
+#include "../BasicBoard.h"
+#include "../Board.h"
+#include "../BoardGenerator.h"
+#include "../CascadeResolver.h"
+#include "../MatchDetector.h"
+#include "../RandomGenerator.h"
+
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace {
+using Clock = std::chrono::steady_clock;
+
+// Printed at the end, so the optimizer can't throw away the results
+size_t Checksum = 0;
+
+template <class Action>
+double MeasureNs(int iterations, Action&& action)
+{
+    auto start = Clock::now();
+    for (int i = 0; i < iterations; ++i) {
+        action(i);
+    }
+
+    return double(std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count()) / iterations;
+}
+
+void PrintRow(const std::string& configuration, const std::string& operation, double runtimeNs, double fixedNs)
+{
+    std::cout << configuration << ", " << operation << ", " << runtimeNs << ", " << fixedNs << ", " << runtimeNs / fixedNs << std::endl;
+}
+
+template <int Rows, int Cols, int Kinds>
+void RunBenchmark(int iterations)
+{
+    using FixedBoard = BasicBoard<Rows, Cols, Kinds>;
+    constexpr int BoardCount = 256;
+
+    auto configuration = std::to_string(Cols) + "x" + std::to_string(Rows) + "x" + std::to_string(Kinds);
+
+    // Random boards have plenty of runs, the generated ones have none, like the boards the player swaps on
+    RandomGenerator random(uint64_t(Rows * 1000 + Kinds));
+    BoardGenerator boardGenerator(Kinds, 1);
+    std::vector<Board> randomBoards;
+    std::vector<Board> stableBoards;
+    std::vector<Board> destroyedBoards;
+
+    for (int i = 0; i < BoardCount; ++i) {
+        Board board(Cols, Rows);
+        for (int x = 0; x < Cols; ++x) {
+            for (int y = 0; y < Rows; ++y) {
+                board.Type(Vec2 { x, y }) = uint8_t(random.NextInt(Kinds));
+            }
+        }
+        randomBoards.push_back(board);
+
+        boardGenerator.FillBoard(board);
+        stableBoards.push_back(board);
+
+        // About what a cascade step destroys: a few short runs
+        for (int run = 0; run < 3; ++run) {
+            Vec2 start { random.NextInt(Cols - 2), random.NextInt(Rows - 2) };
+            Vec2 direction = random.NextInt(2) == 0 ? Vec2 { 1, 0 } : Vec2 { 0, 1 };
+            for (int j = 0; j < 3; ++j) {
+                board.State(start + direction * j) = CellState::Destroyed;
+            }
+        }
+        destroyedBoards.push_back(board);
+    }
+
+    MatchDetector runtimeDetector(Cols, Rows, Kinds, false);
+    MatchDetector fixedDetector(Cols, Rows, Kinds, true);
+
+    PrintRow(configuration, "FindMatches",
+        MeasureNs(iterations, [&](int i) { Checksum += runtimeDetector.FindMatches(randomBoards[i % BoardCount]).DestroyedCells.size(); }),
+        MeasureNs(iterations, [&](int i) { Checksum += fixedDetector.FindMatches(randomBoards[i % BoardCount]).DestroyedCells.size(); }));
+
+    PrintRow(configuration, "FindMatches (fixed scan only)",
+        MeasureNs(iterations, [&](int i) { Checksum += size_t(runtimeDetector.FindMatches(randomBoards[i % BoardCount]).HighestRowCombo); }),
+        MeasureNs(iterations, [&](int i) { Checksum += size_t(FixedBoard::FindMatches(randomBoards[i % BoardCount].TypeData()).HighestRowCombo); }));
+
+    Vec2 swapSource { Cols / 2, Rows / 2 };
+    Vec2 swapDestination { Cols / 2 + 1, Rows / 2 };
+    PrintRow(configuration, "FindMatchesAfterSwap",
+        MeasureNs(iterations, [&](int i) { Checksum += runtimeDetector.FindMatchesAfterSwap(stableBoards[i % BoardCount], swapSource, swapDestination).DestroyedCells.size(); }),
+        MeasureNs(iterations, [&](int i) { Checksum += fixedDetector.FindMatchesAfterSwap(stableBoards[i % BoardCount], swapSource, swapDestination).DestroyedCells.size(); }));
+
+    // Both sides pay for copying the board back, so the difference is the gravity itself
+    Board gravityBoard(Cols, Rows);
+    GravityResult gravityResult;
+    PrintRow(configuration, "ApplyGravity",
+        MeasureNs(iterations, [&](int i) {
+            gravityBoard = destroyedBoards[i % BoardCount];
+            CascadeResolver::ApplyGravity(gravityBoard, boardGenerator, gravityResult, false);
+            Checksum += size_t(gravityResult.MoveCount);
+        }),
+        MeasureNs(iterations, [&](int i) {
+            gravityBoard = destroyedBoards[i % BoardCount];
+            CascadeResolver::ApplyGravity(gravityBoard, boardGenerator, gravityResult, true);
+            Checksum += size_t(gravityResult.MoveCount);
+        }));
+}
+}
+
+int main(int argc, char* argv[])
+{
+    int iterations = argc > 1 ? std::stoi(argv[1]) : 1000000;
+
+    std::cout << "board, operation, runtime ns, fixed ns, speedup" << std::endl;
+
+    RunBenchmark<8, 8, 5>(iterations);
+    RunBenchmark<10, 10, 6>(iterations);
+
+    std::cout << "checksum: " << Checksum << std::endl;
+
+    return 0;
+}
@@ -0,0 +1,98 @@
+// Measures how the scans of the chunked large board scale with the number of threads, on square and non-square boards.
+// Usage: LargeBoardBenchmark [max thread count] [repetitions]
+
+#include "../LargeBoard.h"
+#include "../WorkStealingPool.h"
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+using Clock = std::chrono::steady_clock;
+
+constexpr int TileKindCount = 5;
+constexpr uint64_t Seed = 2024;
+// Settling a big board takes hundreds of steps, the first ones are enough to see the cost of a step
+constexpr int CascadeStepLimit = 50;
+
+double ElapsedMs(Clock::time_point start)
+{
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+struct Timings {
+    double FindMatchesMs = 0;
+    double GravityMs = 0;
+    double CascadeStepMs = 0;
+};
+
+Timings Measure(int colCount, int rowCount, int threadCount, int repetitions)
+{
+    WorkStealingPool pool(threadCount);
+    LargeBoardEngine engine(TileKindCount, Seed, pool);
+    LargeBoard board(colCount, rowCount);
+    Timings timings;
+
+    for (int i = 0; i < repetitions; ++i) {
+        engine.Fill(board);
+
+        // A freshly filled board is full of runs, the worst case for both steps
+        auto start = Clock::now();
+        auto matches = engine.FindMatches(board);
+        timings.FindMatchesMs += ElapsedMs(start) / repetitions;
+
+        start = Clock::now();
+        engine.DestroyMatches(board, matches);
+        engine.ApplyGravity(board, matches);
+        timings.GravityMs += ElapsedMs(start) / repetitions;
+
+        start = Clock::now();
+        int steps = engine.ResolveCascade(board, CascadeStepLimit);
+        timings.CascadeStepMs += ElapsedMs(start) / std::max(steps, 1) / repetitions;
+    }
+
+    return timings;
+}
+}
+
+int main(int argc, char* argv[])
+{
+    int maxThreadCount = argc > 1 ? std::stoi(argv[1]) : std::max(1, int(std::thread::hardware_concurrency()));
+    int repetitions = argc > 2 ? std::stoi(argv[2]) : 3;
+
+    struct BoardSize {
+        int ColCount;
+        int RowCount;
+    };
+    const BoardSize boardSizes[] = { { 1024, 1024 }, { 4096, 512 }, { 512, 4096 }, { 2048, 2048 } };
+
+    std::cout << "board, threads, find matches ms, destroy and gravity ms, cascade ms per step, find matches speedup" << std::endl;
+
+    for (auto [colCount, rowCount] : boardSizes) {
+        double singleThreadFindMs = 0;
+
+        for (int threadCount = 1; threadCount <= maxThreadCount; threadCount *= 2) {
+            auto timings = Measure(colCount, rowCount, threadCount, repetitions);
+            if (threadCount == 1) {
+                singleThreadFindMs = timings.FindMatchesMs;
+            }
+
+            std::cout << colCount << "x" << rowCount << ", "
+                      << threadCount << ", "
+                      << timings.FindMatchesMs << ", "
+                      << timings.GravityMs << ", "
+                      << timings.CascadeStepMs << ", "
+                      << singleThreadFindMs / timings.FindMatchesMs << std::endl;
+
+            if (threadCount < maxThreadCount && threadCount * 2 > maxThreadCount) {
+                threadCount = maxThreadCount / 2; // Always finish with the maximum
+            }
+        }
+    }
+
+    return 0;
+}
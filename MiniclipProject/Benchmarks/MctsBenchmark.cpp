@@ -0,0 +1,56 @@
+// Measures the playout throughput of the MCTS player for every thread count, in total and per core.
+// Usage: MctsBenchmark [boards per thread count] [budget ms] [playout depth]
+
+#include "../Board.h"
+#include "../BoardGenerator.h"
+#include "../MctsPlayer.h"
+
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+constexpr int ColCount = 8;
+constexpr int RowCount = 8;
+constexpr int TileKindCount = 5;
+
+// Printed at the end, so the optimizer can't throw away the results
+double Checksum = 0.0;
+
+void RunBenchmark(const std::vector<Board>& boards, int threadCount, double budgetMs, int playoutDepth)
+{
+    MctsPlayer player(ColCount, RowCount, TileKindCount, GameMode::Classic, GameRules {}, MctsOptions { threadCount, playoutDepth }, 1);
+
+    uint64_t playoutCount = 0;
+    double elapsedMs = 0.0;
+    for (const auto& board : boards) {
+        Checksum += player.ChooseMove(board, budgetMs)->ExpectedValue;
+        playoutCount += player.GetLastStats().PlayoutCount;
+        elapsedMs += player.GetLastStats().ElapsedMs;
+    }
+
+    double playoutsPerSecond = playoutCount / elapsedMs * 1000.0;
+    std::cout << threadCount << ", " << playoutCount / boards.size() << ", " << playoutsPerSecond << ", " << playoutsPerSecond / threadCount << std::endl;
+}
+}
+
+int main(int argc, char* argv[])
+{
+    int boardCount = argc > 1 ? std::stoi(argv[1]) : 50;
+    double budgetMs = argc > 2 ? std::stod(argv[2]) : 16.0;
+    int playoutDepth = argc > 3 ? std::stoi(argv[3]) : MctsOptions {}.PlayoutDepth;
+
+    BoardGenerator boardGenerator(TileKindCount, 1);
+    std::vector<Board> boards(size_t(boardCount), Board(ColCount, RowCount));
+    boardGenerator.FillBoards(boards, 1);
+
+    std::cout << "threads, playouts per move, playouts/s, playouts/s per thread" << std::endl;
+
+    int maxThreadCount = int(std::max(1u, std::thread::hardware_concurrency()));
+    for (int threadCount = 1; threadCount <= maxThreadCount; threadCount *= 2) {
+        RunBenchmark(boards, threadCount, budgetMs, playoutDepth);
+    }
+
+    std::cout << "checksum: " << Checksum << std::endl;
+}
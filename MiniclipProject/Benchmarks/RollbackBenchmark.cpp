@@ -0,0 +1,146 @@
+// Plays a game with a snapshot taken every frame, the way VersusSession keeps the opponent's world, and rolls back
+// a few frames every now and then to play them again with the same moves. Checks that the replayed frames end on the
+// same board and values, and counts what saving and restoring cost. Fails if they allocate once the snapshots are in use.
+// Usage: RollbackBenchmark [frame count] [classic|quickdeath]
+
+#include "../AllocationCounter.h"
+#include "../GameState.h"
+#include "../GameWorld.h"
+#include "../HeadlessSinks.h"
+#include "../RandomGenerator.h"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <iostream>
+#include <optional>
+#include <string>
+
+namespace {
+constexpr int BoardSize = 8;
+constexpr int TileKindCount = 5;
+constexpr uint64_t FrameTimeMs = 16;
+constexpr int HistorySize = 64;
+constexpr int MaxRollbackFrames = 16;
+constexpr int RollbackInterval = 5;
+// The snapshots start out empty, so the first lap around the history is allowed to grow their buffers
+constexpr int WarmUpFrames = HistorySize;
+
+using Clock = std::chrono::steady_clock;
+
+struct FrameInput {
+    Vec2 Source;
+    Vec2 Destination;
+};
+
+bool IsSameValues(const GameStateValues& lhs, const GameStateValues& rhs)
+{
+    return lhs.TimePassedMs == rhs.TimePassedMs && lhs.Score == rhs.Score && lhs.TimeLeftMs == rhs.TimeLeftMs;
+}
+}
+
+int main(int argc, char* argv[])
+{
+    int frameCount = argc > 1 ? std::stoi(argv[1]) : 100000;
+    auto mode = (argc > 2 && std::string(argv[2]) == "quickdeath") ? GameMode::QuickDeath : GameMode::Classic;
+
+    NullRenderer renderer;
+    NullAudioSink audioSink;
+    GameWorld gameWorld(BoardSize, BoardSize, TileKindCount, renderer, audioSink, 1);
+    auto gameState = MakeGameState(mode);
+    gameWorld.Activate(*gameState, 1);
+
+    std::array<GameWorld::Snapshot, HistorySize> snapshots;
+    std::array<std::optional<FrameInput>, HistorySize> inputs;
+    RandomGenerator random(2);
+
+    int gameStartFrame = 0;
+    int framesUntilMove = 0;
+    int gameCount = 1;
+    int rollbackCount = 0;
+    int mismatchCount = 0;
+    uint64_t saveCount = 0;
+    uint64_t measuredSaveCount = 0;
+    uint64_t measuredRestoreCount = 0;
+    uint64_t saveAllocationCount = 0;
+    uint64_t restoreAllocationCount = 0;
+    Clock::duration saveTime {};
+    Clock::duration restoreTime {};
+
+    auto save = [&](int frame) {
+        auto allocationCount = AllocationCounter::GetAllocationCount();
+        auto start = Clock::now();
+        gameWorld.SaveSnapshot(snapshots[size_t(frame % HistorySize)]);
+        saveTime += Clock::now() - start;
+        ++saveCount;
+        if (frame >= WarmUpFrames) {
+            saveAllocationCount += AllocationCounter::GetAllocationCount() - allocationCount;
+            ++measuredSaveCount;
+        }
+    };
+
+    auto simulateFrame = [&](int frame) {
+        save(frame);
+        if (const auto& input = inputs[size_t(frame % HistorySize)]) {
+            gameWorld.TrySwitchCells(input->Source, input->Destination);
+        }
+        gameWorld.Update(FrameTimeMs);
+    };
+
+    for (int frame = 0; frame < frameCount; ++frame) {
+        // Moves are made while cascades play as well, with a long pause now and then so the hint shows up
+        auto& input = inputs[size_t(frame % HistorySize)];
+        input.reset();
+        if (--framesUntilMove <= 0) {
+            auto moves = gameWorld.GetAvailableMoves();
+            if (!moves.empty()) {
+                const auto& move = moves[size_t(random.NextInt(int(moves.size())))];
+                input = FrameInput { move.Source, move.Destination };
+                framesUntilMove = random.NextInt(100) < 3 ? 400 : random.NextInt(40);
+            }
+        }
+
+        simulateFrame(frame);
+
+        int rollbackFrames = std::min(1 + random.NextInt(MaxRollbackFrames), frame + 1 - gameStartFrame);
+        if (frame % RollbackInterval == 0 && rollbackFrames > 0) {
+            auto boardHash = gameWorld.GetBoardHash();
+            auto values = gameState->GetValues();
+            int firstFrame = frame + 1 - rollbackFrames;
+
+            auto allocationCount = AllocationCounter::GetAllocationCount();
+            auto start = Clock::now();
+            gameWorld.RestoreSnapshot(snapshots[size_t(firstFrame % HistorySize)]);
+            restoreTime += Clock::now() - start;
+            if (frame >= WarmUpFrames) {
+                restoreAllocationCount += AllocationCounter::GetAllocationCount() - allocationCount;
+                ++measuredRestoreCount;
+            }
+
+            for (int replayedFrame = firstFrame; replayedFrame <= frame; ++replayedFrame) {
+                simulateFrame(replayedFrame);
+            }
+
+            mismatchCount += gameWorld.GetBoardHash() != boardHash || !IsSameValues(gameState->GetValues(), values);
+            ++rollbackCount;
+        }
+
+        if (gameState->IsGameOver()) {
+            // Snapshots are only for the game they were taken in
+            gameState = MakeGameState(mode);
+            gameWorld.Activate(*gameState, uint64_t(1 + gameCount++));
+            gameStartFrame = frame + 1;
+        }
+    }
+
+    auto toUs = [](Clock::duration duration, uint64_t count) { return std::chrono::duration<double, std::micro>(duration).count() / double(std::max<uint64_t>(count, 1)); };
+
+    std::cout << "Frames: " << frameCount << ", games: " << gameCount << ", rollbacks: " << rollbackCount << std::endl;
+    std::cout << "Save: " << toUs(saveTime, saveCount) << " us, restore: " << toUs(restoreTime, uint64_t(rollbackCount)) << " us" << std::endl;
+    std::cout << "Allocations after " << WarmUpFrames << " frames: " << saveAllocationCount << " in " << measuredSaveCount << " saves, "
+              << restoreAllocationCount << " in " << measuredRestoreCount << " restores" << std::endl;
+    std::cout << "Mismatches: " << mismatchCount << std::endl;
+
+    // Only a game with more animations at once than the world has reserved room for may grow them again
+    return mismatchCount == 0 && saveAllocationCount == 0 && restoreAllocationCount == 0 ? 0 : 1;
+}
@@ -0,0 +1,118 @@
+// Saves the game at random points of its cascades and checks that a restored world settles on the same board and score.
+// Also measures what saving and restoring cost on the main thread, and the size of the save.
+// Usage: SaveStateBenchmark [move count] [board size]
+
+#include "../GameState.h"
+#include "../GameWorld.h"
+#include "../HeadlessSinks.h"
+#include "../RandomGenerator.h"
+#include "../SaveFileWriter.h"
+#include "../SaveState.h"
+
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <iostream>
+#include <string>
+
+namespace {
+constexpr int TileKindCount = 5;
+constexpr uint64_t FrameTimeMs = 16;
+// A cascade step is at most 800 ms long, so this reaches into every kind of step
+constexpr int MaxFramesBeforeSave = 120;
+
+using Clock = std::chrono::steady_clock;
+
+double ElapsedUs(Clock::time_point start)
+{
+    return std::chrono::duration<double, std::micro>(Clock::now() - start).count();
+}
+
+void WaitForInput(GameWorld& gameWorld)
+{
+    while (!gameWorld.IsSettled()) {
+        gameWorld.Update(FrameTimeMs);
+    }
+}
+}
+
+int main(int argc, char* argv[])
+{
+    int moveCount = argc > 1 ? std::stoi(argv[1]) : 500;
+    int boardSize = argc > 2 ? std::stoi(argv[2]) : 8;
+
+    NullRenderer renderer;
+    NullAudioSink audioSink;
+    GameWorld gameWorld(boardSize, boardSize, TileKindCount, renderer, audioSink, 1);
+    GameWorld restoredWorld(boardSize, boardSize, TileKindCount, renderer, audioSink, 2);
+    ClassicGameState gameState;
+    gameWorld.Activate(gameState, 1);
+
+    RandomGenerator random(3);
+    int mismatchCount = 0;
+    double saveUs = 0.0;
+    double restoreUs = 0.0;
+    size_t saveSize = 0;
+
+    for (int i = 0; i < moveCount; ++i) {
+        auto legalMoves = gameWorld.GetLegalMoves();
+        const auto& move = legalMoves[size_t(random.NextInt(int(legalMoves.size())))];
+        gameWorld.TrySwitchCells(move.Source, move.Destination);
+
+        for (int frames = random.NextInt(MaxFramesBeforeSave); frames > 0 && !gameWorld.IsSettled(); --frames) {
+            gameWorld.Update(FrameTimeMs);
+        }
+
+        auto start = Clock::now();
+        auto data = gameWorld.CreateSaveState().Serialize();
+        saveUs += ElapsedUs(start);
+        saveSize = data.size();
+
+        ClassicGameState restoredState;
+        start = Clock::now();
+        auto saveState = SaveState::Deserialize(data);
+        bool isRestored = saveState && restoredWorld.RestoreSaveState(*saveState, restoredState);
+        restoreUs += ElapsedUs(start);
+
+        if (!isRestored) {
+            ++mismatchCount;
+            continue;
+        }
+
+        restoredWorld.Activate(restoredState);
+        WaitForInput(gameWorld);
+        WaitForInput(restoredWorld);
+        mismatchCount += gameWorld.GetBoardHash() != restoredWorld.GetBoardHash() || gameState.GetValues().Score != restoredState.GetValues().Score;
+        restoredWorld.Deactivate();
+
+        if (gameState.IsGameOver()) {
+            gameState = ClassicGameState {};
+            gameWorld.Activate(gameState, 1 + i);
+        }
+    }
+
+    // The main thread only hands the data over, the file is written in the background
+    auto filePath = (std::filesystem::temp_directory_path() / "SaveStateBenchmark.save").string();
+    double submitUs = 0.0;
+    double writeUs = 0.0;
+    {
+        SaveFileWriter writer(filePath);
+        auto start = Clock::now();
+        writer.Write(gameWorld.CreateSaveState().Serialize());
+        submitUs = ElapsedUs(start);
+        writer.Wait();
+        writeUs = ElapsedUs(start);
+
+        auto readBack = SaveState::ReadFile(filePath);
+        mismatchCount += !readBack || readBack->Serialize() != gameWorld.CreateSaveState().Serialize();
+
+        writer.Remove();
+    }
+
+    std::cout << "Board: " << boardSize << "x" << boardSize << ", saves: " << moveCount << ", save size: " << saveSize << " bytes" << std::endl;
+    std::cout << "Save: " << saveUs / moveCount << " us, restore: " << restoreUs / moveCount << " us" << std::endl;
+    std::cout << "Background write: " << submitUs << " us on the main thread, " << writeUs << " us until on disk" << std::endl;
+    std::cout << "Mismatches: " << mismatchCount << std::endl;
+
+    return mismatchCount == 0 ? 0 : 1;
+}
@@ -0,0 +1,145 @@
+// Compares hashing a board from scratch with updating the Zobrist hash after a cascade step,
+// and measures how many transposition table probes and stores per millisecond several threads get through together.
+// Usage: TranspositionTableBenchmark [cascade steps] [table operations per thread]
+
+#include "../Board.h"
+#include "../BoardGenerator.h"
+#include "../CascadeResolver.h"
+#include "../MatchDetector.h"
+#include "../RandomGenerator.h"
+#include "../TranspositionTable.h"
+#include "../ZobristKeys.h"
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+constexpr int ColCount = 8;
+constexpr int RowCount = 8;
+constexpr int TileKindCount = 6;
+constexpr size_t TableSizeInBytes = size_t(64) << 20;
+
+using Clock = std::chrono::steady_clock;
+
+// Printed at the end, so the optimizer can't throw away the results
+uint64_t Checksum = 0;
+
+double ElapsedMs(Clock::time_point start)
+{
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+enum class HashMode {
+    None,
+    Full,
+    Incremental,
+};
+
+// Destroys a random cross of cells and lets the rest fall, the same kind of change a cascade step makes.
+// Every mode plays the same steps, so the difference to HashMode::None is the cost of the hashing.
+double RunCascadeSteps(int stepCount, HashMode hashMode)
+{
+    ZobristKeys zobristKeys(ColCount, RowCount, TileKindCount);
+    BoardGenerator boardGenerator(TileKindCount, 1);
+    RandomGenerator random(2);
+    Board board(ColCount, RowCount);
+    GravityResult gravityResult;
+    boardGenerator.FillBoard(board);
+
+    uint64_t hash = zobristKeys.Hash(board);
+    std::vector<Vec2> destroyedCells;
+
+    auto start = Clock::now();
+    for (int i = 0; i < stepCount; ++i) {
+        Vec2 center { random.NextInt(ColCount), random.NextInt(RowCount) };
+        destroyedCells.clear();
+        for (Vec2 cell : { center, center + Vec2 { 1, 0 }, center + Vec2 { -1, 0 }, center + Vec2 { 0, 1 }, center + Vec2 { 0, -1 } }) {
+            if (cell.x >= 0 && cell.x < ColCount && cell.y >= 0 && cell.y < RowCount) {
+                destroyedCells.push_back(cell);
+            }
+        }
+
+        if (hashMode == HashMode::Incremental) {
+            hash = zobristKeys.HashAfterDestruction(hash, board, destroyedCells);
+        }
+        for (auto cell : destroyedCells) {
+            board.State(cell) = CellState::Destroyed;
+        }
+
+        CascadeResolver::ApplyGravity(board, boardGenerator, gravityResult);
+
+        if (hashMode == HashMode::Incremental) {
+            hash = zobristKeys.HashAfterGravity(hash, board, gravityResult);
+        } else if (hashMode == HashMode::Full) {
+            hash = zobristKeys.Hash(board);
+        }
+    }
+    double elapsedMs = ElapsedMs(start);
+
+    Checksum += hash;
+    return elapsedMs;
+}
+
+void RunHashBenchmark(int stepCount)
+{
+    double baseMs = RunCascadeSteps(stepCount, HashMode::None);
+    double fullMs = RunCascadeSteps(stepCount, HashMode::Full);
+    double incrementalMs = RunCascadeSteps(stepCount, HashMode::Incremental);
+
+    std::cout << "hash after a cascade step (ns), full: " << (fullMs - baseMs) * 1e6 / stepCount
+              << ", incremental: " << (incrementalMs - baseMs) * 1e6 / stepCount << std::endl;
+}
+
+void RunTableBenchmark(int threadCount, int operationCount)
+{
+    TranspositionTable table(TableSizeInBytes);
+    std::vector<uint64_t> hits(size_t(threadCount), 0);
+
+    auto start = Clock::now();
+    std::vector<std::thread> threads;
+    for (int t = 0; t < threadCount; ++t) {
+        threads.emplace_back([&table, &hits, t, operationCount]() {
+            // Every thread walks the same keys, so the threads keep hitting each other's entries
+            RandomGenerator random(3);
+            for (int i = 0; i < operationCount; ++i) {
+                auto hash = random.Next();
+                if (auto entry = table.Probe(hash)) {
+                    hits[size_t(t)] += entry->Depth;
+                } else {
+                    table.Store(hash, TranspositionEntry { float(i), uint16_t(i), uint8_t(t + 1), 0 });
+                }
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    double elapsedMs = ElapsedMs(start);
+
+    for (auto hit : hits) {
+        Checksum += hit;
+    }
+
+    std::cout << threadCount << ", " << double(threadCount) * operationCount / elapsedMs << std::endl;
+}
+}
+
+int main(int argc, char* argv[])
+{
+    int stepCount = argc > 1 ? std::stoi(argv[1]) : 200000;
+    int operationCount = argc > 2 ? std::stoi(argv[2]) : 2000000;
+
+    RunHashBenchmark(stepCount);
+
+    std::cout << "threads, table operations/ms" << std::endl;
+    int maxThreadCount = int(std::max(1u, std::thread::hardware_concurrency()));
+    for (int threadCount = 1; threadCount <= maxThreadCount; threadCount *= 2) {
+        RunTableBenchmark(threadCount, operationCount);
+    }
+
+    std::cout << "checksum: " << Checksum << std::endl;
+}
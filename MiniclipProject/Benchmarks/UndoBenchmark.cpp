@@ -0,0 +1,106 @@
+// Plays a number of moves, then measures how long it takes to undo all of them and to redo them again.
+// Checks that every undo and redo gives back the same board hash and score, and that a move made again after
+// an undo plays out exactly as before.
+// Usage: UndoBenchmark [move count] [board size]
+
+#include "../GameState.h"
+#include "../GameWorld.h"
+#include "../HeadlessSinks.h"
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace {
+constexpr int TileKindCount = 5;
+constexpr uint64_t FrameTimeMs = 16;
+
+using Clock = std::chrono::steady_clock;
+
+struct PlayedMove {
+    Vec2 Source;
+    Vec2 Destination;
+    uint64_t HashAfter;
+    GameStateValues ValuesAfter;
+};
+
+void WaitForInput(GameWorld& gameWorld)
+{
+    while (!gameWorld.IsSettled()) {
+        gameWorld.Update(FrameTimeMs);
+    }
+}
+
+bool IsSame(const GameStateValues& lhs, const GameStateValues& rhs)
+{
+    return lhs.TimePassedMs == rhs.TimePassedMs && lhs.Score == rhs.Score && lhs.TimeLeftMs == rhs.TimeLeftMs;
+}
+}
+
+int main(int argc, char* argv[])
+{
+    int moveCount = argc > 1 ? std::stoi(argv[1]) : 200;
+    int boardSize = argc > 2 ? std::stoi(argv[2]) : 8;
+    moveCount = std::min(moveCount, int(UndoHistory::MaxMoveCount));
+
+    NullRenderer renderer;
+    NullAudioSink audioSink;
+    GameWorld gameWorld(boardSize, boardSize, TileKindCount, renderer, audioSink, 1);
+    ClassicGameState gameState;
+    gameWorld.Activate(gameState, 1);
+
+    uint64_t startHash = gameWorld.GetBoardHash();
+    auto startValues = gameState.GetValues();
+
+    std::vector<PlayedMove> moves;
+    for (int i = 0; i < moveCount; ++i) {
+        auto legalMoves = gameWorld.GetLegalMoves();
+        const auto& move = legalMoves[size_t(i) % legalMoves.size()];
+        gameWorld.TrySwitchCells(move.Source, move.Destination);
+        WaitForInput(gameWorld);
+        moves.push_back(PlayedMove { move.Source, move.Destination, gameWorld.GetBoardHash(), gameState.GetValues() });
+    }
+
+    int mismatchCount = 0;
+    double maxUndoMs = 0.0;
+    double maxRedoMs = 0.0;
+
+    auto start = Clock::now();
+    for (int i = moveCount - 1; i >= 0; --i) {
+        auto undoStart = Clock::now();
+        gameWorld.Undo();
+        maxUndoMs = std::max(maxUndoMs, std::chrono::duration<double, std::milli>(Clock::now() - undoStart).count());
+
+        uint64_t expectedHash = i > 0 ? moves[size_t(i) - 1].HashAfter : startHash;
+        auto expectedValues = i > 0 ? moves[size_t(i) - 1].ValuesAfter : startValues;
+        mismatchCount += gameWorld.GetBoardHash() != expectedHash || !IsSame(gameState.GetValues(), expectedValues);
+    }
+    double undoMs = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+
+    start = Clock::now();
+    for (const auto& move : moves) {
+        auto redoStart = Clock::now();
+        gameWorld.Redo();
+        maxRedoMs = std::max(maxRedoMs, std::chrono::duration<double, std::milli>(Clock::now() - redoStart).count());
+
+        mismatchCount += gameWorld.GetBoardHash() != move.HashAfter || !IsSame(gameState.GetValues(), move.ValuesAfter);
+    }
+    double redoMs = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+
+    // Undo everything and play the same moves again, the same tiles have to fall in
+    while (gameWorld.Undo()) { }
+    for (const auto& move : moves) {
+        gameWorld.TrySwitchCells(move.Source, move.Destination);
+        WaitForInput(gameWorld);
+        mismatchCount += gameWorld.GetBoardHash() != move.HashAfter || gameState.GetValues().Score != move.ValuesAfter.Score;
+    }
+
+    std::cout << "Board: " << boardSize << "x" << boardSize << ", moves: " << moveCount << std::endl;
+    std::cout << "Undo: " << undoMs / moveCount * 1000.0 << " us average, " << maxUndoMs * 1000.0 << " us max" << std::endl;
+    std::cout << "Redo: " << redoMs / moveCount * 1000.0 << " us average, " << maxRedoMs * 1000.0 << " us max" << std::endl;
+    std::cout << "Mismatches: " << mismatchCount << std::endl;
+
+    return mismatchCount == 0 ? 0 : 1;
+}
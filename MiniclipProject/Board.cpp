@@ -0,0 +1,37 @@
+#include "Board.h"
+
+#include <algorithm>
+#include <utility>
+
+Board::Board(int colCount, int rowCount)
+    : _colCount(colCount)
+    , _rowCount(rowCount)
+    , _types(size_t(colCount) * rowCount, 0)
+    , _states(size_t(colCount) * rowCount, CellState::Normal)
+{
+}
+
+bool Board::IsIndexOnTheBoard(Vec2 index) const
+{
+    return !(index.x < 0 || index.x > _colCount - 1 || index.y < 0 || index.y > _rowCount - 1);
+}
+
+void Board::SwapCells(Vec2 lhs, Vec2 rhs)
+{
+    auto lhsIndex = IndexOf(lhs);
+    auto rhsIndex = IndexOf(rhs);
+
+    std::swap(_types[lhsIndex], _types[rhsIndex]);
+    std::swap(_states[lhsIndex], _states[rhsIndex]);
+}
+
+void Board::ReplaceStates(CellState from, CellState to)
+{
+    std::replace(_states.begin(), _states.end(), from, to);
+}
+
+void Board::Reset()
+{
+    std::fill(_types.begin(), _types.end(), uint8_t(0));
+    std::fill(_states.begin(), _states.end(), CellState::Normal);
+}
@@ -0,0 +1,91 @@
+#pragma once
+
+#include "Vec2.h"
+
+#include <cassert>
+#include <cstdint>
+#include <vector>
+
+enum class CellState : uint8_t {
+    Destroyed,
+    Normal,
+    Active,
+    WaitingForAnimationToComplete,
+};
+
+// A non-owning view of one row or column of the board. Columns are contiguous, rows are strided.
+template <class T>
+class BoardLine {
+public:
+    BoardLine(T* first, int size, int stride)
+        : _first(first)
+        , _size(size)
+        , _stride(stride)
+    {
+    }
+
+    T& operator[](int index) const
+    {
+        assert(index >= 0 && index < _size);
+        return _first[index * _stride];
+    }
+
+    int Size() const { return _size; }
+    int Stride() const { return _stride; }
+
+private:
+    T* _first;
+    int _size;
+    int _stride;
+};
+
+// Contiguous storage for the tiles of the board. Types and states are kept in separate byte arrays,
+// so scans that only care about the types (eg. match detection) touch as little memory as possible.
+class Board {
+public:
+    Board(int colCount, int rowCount);
+
+    int GetColCount() const { return _colCount; }
+    int GetRowCount() const { return _rowCount; }
+    int GetCellCount() const { return _colCount * _rowCount; }
+
+    uint8_t& Type(Vec2 index) { return _types[IndexOf(index)]; }
+    uint8_t Type(Vec2 index) const { return _types[IndexOf(index)]; }
+    CellState& State(Vec2 index) { return _states[IndexOf(index)]; }
+    CellState State(Vec2 index) const { return _states[IndexOf(index)]; }
+
+    // The raw column major arrays, for code that processes the whole board at once
+    uint8_t* TypeData() { return _types.data(); }
+    const uint8_t* TypeData() const { return _types.data(); }
+    CellState* StateData() { return _states.data(); }
+    const CellState* StateData() const { return _states.data(); }
+
+    BoardLine<uint8_t> ColumnTypes(int col) { return { &_types[IndexOf({ col, 0 })], _rowCount, 1 }; }
+    BoardLine<const uint8_t> ColumnTypes(int col) const { return { &_types[IndexOf({ col, 0 })], _rowCount, 1 }; }
+    BoardLine<uint8_t> RowTypes(int row) { return { &_types[IndexOf({ 0, row })], _colCount, _rowCount }; }
+    BoardLine<const uint8_t> RowTypes(int row) const { return { &_types[IndexOf({ 0, row })], _colCount, _rowCount }; }
+
+    BoardLine<CellState> ColumnStates(int col) { return { &_states[IndexOf({ col, 0 })], _rowCount, 1 }; }
+    BoardLine<const CellState> ColumnStates(int col) const { return { &_states[IndexOf({ col, 0 })], _rowCount, 1 }; }
+    BoardLine<CellState> RowStates(int row) { return { &_states[IndexOf({ 0, row })], _colCount, _rowCount }; }
+    BoardLine<const CellState> RowStates(int row) const { return { &_states[IndexOf({ 0, row })], _colCount, _rowCount }; }
+
+    bool IsIndexOnTheBoard(Vec2 index) const;
+    void SwapCells(Vec2 lhs, Vec2 rhs);
+    void ReplaceStates(CellState from, CellState to);
+    void Reset();
+
+private:
+    int IndexOf(Vec2 index) const
+    {
+        assert(IsIndexOnTheBoard(index));
+        return index.x * _rowCount + index.y;
+    }
+
+    int _colCount;
+    int _rowCount;
+
+    // Both arrays are stored in column major order, so a column is a contiguous block of RowCount cells
+    std::vector<uint8_t> _types;
+    std::vector<CellState> _states;
+};
@@ -0,0 +1,262 @@
+#include "BoardGenerator.h"
+
+#include "MoveFinder.h"
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+namespace {
+bool Contains(const std::array<int, 2>& arr, int value)
+{
+    return std::find(arr.begin(), arr.end(), value) != arr.end();
+}
+
+// Three tiles of the same kind, one swap away from a run: 2 in a line and a third past the gap after them, or next to it
+constexpr std::array<std::array<Vec2, 3>, 4> PlantedMoves = { {
+    { Vec2 { 0, 0 }, Vec2 { 1, 0 }, Vec2 { 3, 0 } },
+    { Vec2 { 0, 0 }, Vec2 { 1, 0 }, Vec2 { 2, 1 } },
+    { Vec2 { 0, 0 }, Vec2 { 0, 1 }, Vec2 { 0, 3 } },
+    { Vec2 { 0, 0 }, Vec2 { 0, 1 }, Vec2 { 1, 2 } },
+} };
+
+int CountSameTypes(const Board& board, Vec2 index, Vec2 step)
+{
+    int count = 0;
+    for (auto next = index + step; board.IsIndexOnTheBoard(next) && board.Type(next) == board.Type(index); next = next + step) {
+        ++count;
+    }
+    return count;
+}
+
+bool IsInRun(const Board& board, Vec2 index)
+{
+    return 1 + CountSameTypes(board, index, Vec2 { 1, 0 }) + CountSameTypes(board, index, Vec2 { -1, 0 }) >= MatchDetector::MinimumRunLength
+        || 1 + CountSameTypes(board, index, Vec2 { 0, 1 }) + CountSameTypes(board, index, Vec2 { 0, -1 }) >= MatchDetector::MinimumRunLength;
+}
+}
+
+BoardGenerator::BoardGenerator(int tileKindCount, uint64_t seed)
+    : TileKindCount(tileKindCount)
+    , _random(seed)
+    , _allowedKinds(size_t(tileKindCount + 1) * (tileKindCount + 1) * tileKindCount)
+    , _allowedKindCounts(size_t(tileKindCount + 1) * (tileKindCount + 1), 0)
+{
+    for (int first = 0; first <= TileKindCount; ++first) {
+        for (int second = 0; second <= TileKindCount; ++second) {
+            int entry = first * (TileKindCount + 1) + second;
+            for (int type = 0; type < TileKindCount; ++type) {
+                if (type != first && type != second) {
+                    _allowedKinds[size_t(entry) * TileKindCount + _allowedKindCounts[entry]++] = uint8_t(type);
+                }
+            }
+        }
+    }
+}
+
+void BoardGenerator::Seed(uint64_t seed)
+{
+    _random.Seed(seed);
+}
+
+const RandomGenerator& BoardGenerator::GetRandomGenerator() const
+{
+    return _random;
+}
+
+void BoardGenerator::SetRandomGenerator(const RandomGenerator& randomGenerator)
+{
+    _random = randomGenerator;
+}
+
+int BoardGenerator::GetTileKindCount() const
+{
+    return TileKindCount;
+}
+
+int BoardGenerator::GetRandomNumber(const std::array<int, 2>& excluding)
+{
+    return _random.NextIntExcluding(TileKindCount, excluding);
+}
+
+void BoardGenerator::GenerateTiles(uint8_t* types, int count)
+{
+    _random.NextInts(TileKindCount, types, count);
+}
+
+std::array<int, 2> BoardGenerator::GetExcludedTypes(const Board& board, int i, int j) const
+{
+    std::array<int, 2> excludedNumbers = { -1, -1 };
+    auto row = board.RowTypes(j);
+    auto column = board.ColumnTypes(i);
+
+    // If the current row's or column's previous 2 cells have the same type, then generate another kind
+    if (i > 1 && row[i - 1] == row[i - 2]) {
+        excludedNumbers[0] = row[i - 1];
+    }
+    if (j > 1 && column[j - 1] == column[j - 2]) {
+        excludedNumbers[1] = column[j - 1];
+    }
+
+    return excludedNumbers;
+}
+
+void BoardGenerator::GenerateBoard(Board& board)
+{
+    const int rowCount = board.GetRowCount();
+    const int noneExcluded = TileKindCount;
+    uint8_t* types = board.TypeData();
+
+    // If the previous 2 cells are equal their kind is excluded, otherwise nothing is. Without a branch, as it's random which one it is.
+    auto excludedKind = [noneExcluded](int previous1, int previous2) {
+        return noneExcluded + ((previous1 - noneExcluded) & -int(previous1 == previous2));
+    };
+
+    // The same tiles as GetRandomNumber(GetExcludedTypes(...)) cell by cell, but the excluded kinds are looked up
+    // straight from the columns that were already generated and the allowed ones come from the table
+    for (int i = 0; i < board.GetColCount(); ++i) {
+        uint8_t* column = types + size_t(i) * rowCount;
+
+        // Every cell depends on the 2 above it, they are kept at hand instead of being read back from the board
+        int above1 = -1;
+        int above2 = -2;
+
+        for (int j = 0; j < rowCount; ++j) {
+            int rowExcluded = i > 1 ? excludedKind(column[j - rowCount], column[j - 2 * rowCount]) : noneExcluded;
+            int columnExcluded = excludedKind(above1, above2);
+            int entry = rowExcluded * (TileKindCount + 1) + columnExcluded;
+
+            int type = _allowedKinds[size_t(entry) * TileKindCount + _random.NextInt(_allowedKindCounts[entry])];
+            column[j] = uint8_t(type);
+            above2 = above1;
+            above1 = type;
+        }
+    }
+}
+
+bool BoardGenerator::FillBoard(Board& board, int minLegalMoves)
+{
+    for (int attempt = 0; attempt < MaxAttempts; ++attempt) {
+        board.Reset();
+        GenerateBoard(board);
+
+        if (minLegalMoves <= 0 || MoveFinder::CountLegalMoves(board, minLegalMoves) >= minLegalMoves) {
+            return true;
+        }
+    }
+
+    return PlantLegalMoves(board, minLegalMoves);
+}
+
+bool BoardGenerator::FillBoards(std::span<Board> boards, int minLegalMoves)
+{
+    bool hasEnoughMoves = true;
+    for (auto& board : boards) {
+        hasEnoughMoves &= FillBoard(board, minLegalMoves);
+    }
+    return hasEnoughMoves;
+}
+
+bool BoardGenerator::PlantLegalMoves(Board& board, int minLegalMoves) const
+{
+    // Doesn't draw any numbers, so the tiles generated after it are the same whether it was needed or not
+    int legalMoveCount = MoveFinder::CountLegalMoves(board, minLegalMoves);
+    if (legalMoveCount >= minLegalMoves) {
+        return true;
+    }
+
+    for (int i = 0; i < board.GetColCount(); ++i) {
+        for (int j = 0; j < board.GetRowCount(); ++j) {
+            auto origin = Vec2 { i, j };
+            for (const auto& cells : PlantedMoves) {
+                if (!std::all_of(cells.begin(), cells.end(), [&](Vec2 cell) { return board.IsIndexOnTheBoard(origin + cell); })) {
+                    continue;
+                }
+
+                for (int type = 0; type < TileKindCount; ++type) {
+
+                    std::array<uint8_t, 3> previousTypes;
+                    for (size_t k = 0; k < cells.size(); ++k) {
+                        previousTypes[k] = std::exchange(board.Type(origin + cells[k]), uint8_t(type));
+                    }
+
+                    // Only kept if it doesn't complete a run already and doesn't take away more moves than it adds
+                    bool hasRun = std::any_of(cells.begin(), cells.end(), [&](Vec2 cell) { return IsInRun(board, origin + cell); });
+                    int newLegalMoveCount = hasRun ? 0 : MoveFinder::CountLegalMoves(board, minLegalMoves);
+                    if (newLegalMoveCount >= minLegalMoves) {
+                        return true;
+                    }
+                    if (newLegalMoveCount > legalMoveCount) {
+                        legalMoveCount = newLegalMoveCount;
+                    } else {
+                        for (size_t k = 0; k < cells.size(); ++k) {
+                            board.Type(origin + cells[k]) = previousTypes[k];
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    return false;
+}
+
+bool BoardGenerator::Shuffle(Board& board, int minLegalMoves)
+{
+    std::vector<int> tileCounts(TileKindCount, 0);
+    for (int i = 0; i < board.GetColCount(); ++i) {
+        auto column = board.ColumnTypes(i);
+        for (int j = 0; j < board.GetRowCount(); ++j) {
+            ++tileCounts[column[j]];
+        }
+    }
+
+    Board shuffledBoard(board.GetColCount(), board.GetRowCount());
+
+    for (int attempt = 0; attempt < MaxAttempts; ++attempt) {
+        auto remainingTiles = tileCounts;
+        bool isComplete = true;
+
+        // Place the tiles one by one, drawing each from the remaining ones that don't complete a run
+        for (int i = 0; i < board.GetColCount() && isComplete; ++i) {
+            auto column = shuffledBoard.ColumnTypes(i);
+            for (int j = 0; j < board.GetRowCount(); ++j) {
+                auto excludedTypes = GetExcludedTypes(shuffledBoard, i, j);
+
+                int allowedTileCount = 0;
+                for (int type = 0; type < TileKindCount; ++type) {
+                    if (!Contains(excludedTypes, type)) {
+                        allowedTileCount += remainingTiles[type];
+                    }
+                }
+
+                if (allowedTileCount == 0) {
+                    isComplete = false;
+                    break;
+                }
+
+                int pick = _random.NextInt(allowedTileCount);
+                int type = 0;
+                for (;; ++type) {
+                    if (Contains(excludedTypes, type)) {
+                        continue;
+                    }
+                    if (pick < remainingTiles[type]) {
+                        break;
+                    }
+                    pick -= remainingTiles[type];
+                }
+
+                --remainingTiles[type];
+                column[j] = uint8_t(type);
+            }
+        }
+
+        if (isComplete && MoveFinder::CountLegalMoves(shuffledBoard, minLegalMoves) >= minLegalMoves) {
+            board = shuffledBoard;
+            return true;
+        }
+    }
+
+    return false;
+}
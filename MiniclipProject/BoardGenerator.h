@@ -0,0 +1,53 @@
+#pragma once
+
+#include "Board.h"
+#include "RandomGenerator.h"
+
+#include <array>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+// Generates the tiles of the board. Boards created by it never contain runs of 3 or more.
+class BoardGenerator {
+public:
+    BoardGenerator(int tileKindCount, uint64_t seed);
+
+    // Restarts the sequence of generated tiles, the same seed always generates the same boards
+    void Seed(uint64_t seed);
+    const RandomGenerator& GetRandomGenerator() const;
+    void SetRandomGenerator(const RandomGenerator& randomGenerator);
+
+    int GetTileKindCount() const;
+    int GetRandomNumber(const std::array<int, 2>& excluding = { -1, -1 });
+    // The same tiles as count calls to GetRandomNumber without exclusions, used to refill the columns
+    void GenerateTiles(uint8_t* types, int count);
+
+    // Fills the whole board, regenerating it until it has at least minLegalMoves legal moves. If none of the attempts
+    // has enough, legal moves are planted into the last one. Returns false if the board still has fewer than minLegalMoves,
+    // which only happens on boards too small to fit them.
+    bool FillBoard(Board& board, int minLegalMoves = 0);
+    // The same boards as calling FillBoard for each of them in order, returns false if any of them has too few legal moves
+    bool FillBoards(std::span<Board> boards, int minLegalMoves = 0);
+
+    // Rearranges the tiles already on the board, keeping the same number of tiles of every kind.
+    // Returns false if no arrangement without runs and with at least minLegalMoves legal moves was found, the board is
+    // left as it was then and FillBoard can replace it.
+    bool Shuffle(Board& board, int minLegalMoves);
+
+private:
+    static constexpr int MaxAttempts = 100;
+
+    const int TileKindCount;
+
+    RandomGenerator _random;
+
+    // For every pair of kinds that would complete a run (TileKindCount standing for none), the kinds that are allowed, in increasing order.
+    // Picking one of them with a single NextInt gives the same tile as GetRandomNumber with the same kinds excluded.
+    std::vector<uint8_t> _allowedKinds;
+    std::vector<int> _allowedKindCounts;
+
+    std::array<int, 2> GetExcludedTypes(const Board& board, int i, int j) const;
+    void GenerateBoard(Board& board);
+    bool PlantLegalMoves(Board& board, int minLegalMoves) const;
+};
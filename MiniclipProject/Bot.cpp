@@ -0,0 +1,122 @@
+#include "Bot.h"
+
+#include "GameWorld.h"
+
+#include <algorithm>
+
+namespace {
+constexpr double MctsBudgetMs = 16.0;
+}
+
+std::optional<BotStrategy> ParseBotStrategy(const std::string& name)
+{
+    if (name == "random") {
+        return BotStrategy::Random;
+    } else if (name == "greedy") {
+        return BotStrategy::Greedy;
+    } else if (name == "first") {
+        return BotStrategy::First;
+    } else if (name == "expectimax") {
+        return BotStrategy::Expectimax;
+    } else if (name == "mcts") {
+        return BotStrategy::Mcts;
+    }
+
+    return std::nullopt;
+}
+
+bool IsSearchStrategy(BotStrategy strategy)
+{
+    return strategy == BotStrategy::Expectimax || strategy == BotStrategy::Mcts;
+}
+
+Bot::Bot(BotStrategy strategy, uint64_t seed, uint64_t thinkTimeMs, const GameRules& rules)
+    : _strategy(strategy)
+    , _random(seed, 2) // The board uses streams 0 and 1 of the same seed
+    , _thinkTimeMs(thinkTimeMs)
+    , _rules(rules)
+{
+}
+
+bool Bot::Update(GameWorld& gameWorld, uint64_t deltaTimeMs)
+{
+    // The searches look at the whole board, so they wait for it to settle. The others can play around the cascades.
+    if (!gameWorld.IsInteractionEnabled() || (IsSearchStrategy(_strategy) && !gameWorld.IsSettled())) {
+        _waitedMs = 0;
+        return false;
+    }
+
+    if (_waitedMs < _thinkTimeMs) {
+        _waitedMs += deltaTimeMs;
+        return false;
+    }
+
+    auto legalMoves = gameWorld.GetAvailableMoves();
+    if (legalMoves.empty()) {
+        return false;
+    }
+
+    size_t moveIndex = 0;
+    switch (_strategy) {
+    case BotStrategy::Random: {
+        moveIndex = size_t(_random.NextInt(int(legalMoves.size())));
+    } break;
+    case BotStrategy::Greedy: {
+        auto bestMove = std::max_element(legalMoves.begin(), legalMoves.end(), [](const LegalMove& lhs, const LegalMove& rhs) {
+            return lhs.Destruction.DestroyedCells.size() < rhs.Destruction.DestroyedCells.size();
+        });
+        moveIndex = size_t(bestMove - legalMoves.begin());
+    } break;
+    case BotStrategy::First:
+        break;
+    case BotStrategy::Expectimax:
+    case BotStrategy::Mcts: {
+        auto searchedMove = SearchMove(gameWorld);
+        moveIndex = size_t(std::find_if(legalMoves.begin(), legalMoves.end(), [&searchedMove](const LegalMove& move) {
+            return move.Source == searchedMove.Source && move.Destination == searchedMove.Destination;
+        }) - legalMoves.begin());
+    } break;
+    }
+
+    const auto& move = legalMoves[moveIndex];
+    if (!gameWorld.TrySwitchCells(move.Source, move.Destination)) {
+        return false;
+    }
+
+    _waitedMs = 0;
+    ++_moveCount;
+    return true;
+}
+
+ScoredMove Bot::SearchMove(const GameWorld& gameWorld)
+{
+    // The searches are set up for the rules of one mode, a new one is made when the mode changes
+    auto mode = gameWorld.GetGameMode();
+    if (_searchMode != mode) {
+        _solver.reset();
+        _mctsPlayer.reset();
+        _searchMode = mode;
+    }
+
+    if (_strategy == BotStrategy::Expectimax) {
+        if (!_solver) {
+            _solver = std::make_unique<ExpectimaxSolver>(gameWorld.ColCount, gameWorld.RowCount, gameWorld.TileKindCount, mode, _rules, ExpectimaxOptions {}, _random.Next());
+        }
+        return _solver->ScoreMoves(gameWorld.GetBoard()).front();
+    }
+
+    if (!_mctsPlayer) {
+        _mctsPlayer = std::make_unique<MctsPlayer>(gameWorld.ColCount, gameWorld.RowCount, gameWorld.TileKindCount, mode, _rules, MctsOptions {}, _random.Next());
+    }
+    return *_mctsPlayer->ChooseMove(gameWorld.GetBoard(), MctsBudgetMs);
+}
+
+int Bot::GetMoveCount() const
+{
+    return _moveCount;
+}
+
+void Bot::ResetMoveCount()
+{
+    _moveCount = 0;
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include "ExpectimaxSolver.h"
+#include "GameState.h"
+#include "MctsPlayer.h"
+#include "RandomGenerator.h"
+
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+
+class GameWorld;
+
+enum class BotStrategy {
+    Random, // Any legal move
+    Greedy, // The move that destroys the most cells right away
+    First, // The first legal move in board order, the fastest to pick
+    Expectimax, // The move with the most points expected over the next few moves, within a frame of thinking
+    Mcts, // The move a Monte Carlo tree search on every core played the most, within a frame of thinking
+};
+
+std::optional<BotStrategy> ParseBotStrategy(const std::string& name);
+// The strategies that look ahead with the rules of the game
+bool IsSearchStrategy(BotStrategy strategy);
+
+// Plays the game through the same calls as the player does, without any input devices
+class Bot {
+public:
+    // thinkTimeMs is how long the bot waits after the board accepts input before making its move.
+    // The searches value the moves by the rules, they should be the ones the game is played with.
+    Bot(BotStrategy strategy, uint64_t seed, uint64_t thinkTimeMs = 0, const GameRules& rules = {});
+
+    // Call before every GameWorld::Update. Returns true if a move was made
+    bool Update(GameWorld& gameWorld, uint64_t deltaTimeMs);
+
+    int GetMoveCount() const;
+    void ResetMoveCount();
+
+private:
+    BotStrategy _strategy;
+    RandomGenerator _random;
+    uint64_t _thinkTimeMs;
+    GameRules _rules;
+    uint64_t _waitedMs = 0;
+    int _moveCount = 0;
+    std::unique_ptr<ExpectimaxSolver> _solver;
+    std::unique_ptr<MctsPlayer> _mctsPlayer;
+    GameMode _searchMode = GameMode::Classic;
+
+    // Only called with legal moves on the board
+    ScoredMove SearchMove(const GameWorld& gameWorld);
+};
@@ -0,0 +1,76 @@
+#include "CascadeResolver.h"
+
+#include "BasicBoard.h"
+
+CascadeResolver::CascadeResolver(int colCount, int rowCount, int tileKindCount)
+    : _matchDetector(colCount, rowCount, tileKindCount)
+{
+}
+
+std::vector<CascadeStep> CascadeResolver::ResolveSwap(Board& board, BoardGenerator& boardGenerator, Vec2 lhs, Vec2 rhs, IGameState* gameState)
+{
+    auto cellsToDestroy = _matchDetector.FindMatchesAfterSwap(board, lhs, rhs);
+    if (cellsToDestroy.DestroyedCells.empty()) {
+        return {};
+    }
+
+    board.SwapCells(lhs, rhs);
+
+    return Resolve(board, boardGenerator, std::move(cellsToDestroy), gameState);
+}
+
+std::vector<CascadeStep> CascadeResolver::Resolve(Board& board, BoardGenerator& boardGenerator, CellDestructionData&& cellsToDestroy, IGameState* gameState)
+{
+    std::vector<CascadeStep> steps;
+
+    while (!cellsToDestroy.DestroyedCells.empty()) {
+        for (auto cell : cellsToDestroy.DestroyedCells) {
+            board.State(cell) = CellState::Destroyed;
+        }
+
+        int scoreDelta = gameState ? gameState->UpdateScore(cellsToDestroy) : 0;
+
+        ApplyGravity(board, boardGenerator, _gravityResult);
+        auto nextCellsToDestroy = _matchDetector.FindMatchesAfterFall(board, _gravityResult.LowestChangedRows);
+
+        auto moves = _gravityResult.GetMoves();
+        auto spawnedTiles = _gravityResult.GetSpawnedTiles();
+        steps.push_back(CascadeStep { std::move(cellsToDestroy), { moves.begin(), moves.end() }, { spawnedTiles.begin(), spawnedTiles.end() }, scoreDelta });
+        cellsToDestroy = std::move(nextCellsToDestroy);
+    }
+
+    return steps;
+}
+
+int CascadeResolver::ResolveScore(Board& board, BoardGenerator& boardGenerator, CellDestructionData&& cellsToDestroy, IGameState& gameState)
+{
+    int totalScoreDelta = 0;
+
+    while (!cellsToDestroy.DestroyedCells.empty()) {
+        for (auto cell : cellsToDestroy.DestroyedCells) {
+            board.State(cell) = CellState::Destroyed;
+        }
+
+        totalScoreDelta += gameState.UpdateScore(cellsToDestroy);
+
+        ApplyGravity(board, boardGenerator, _gravityResult);
+        cellsToDestroy = _matchDetector.FindMatchesAfterFall(board, _gravityResult.LowestChangedRows);
+    }
+
+    return totalScoreDelta;
+}
+
+void CascadeResolver::ApplyGravity(Board& board, BoardGenerator& boardGenerator, GravityResult& result, bool useFixedBoard)
+{
+    if (auto fixedBoard = useFixedBoard ? FindFixedBoardFunctions(board.GetColCount(), board.GetRowCount(), boardGenerator.GetTileKindCount()) : nullptr) {
+        fixedBoard->ApplyGravity(board, boardGenerator, result);
+        return;
+    }
+
+    result.Reset(board.GetColCount(), size_t(board.GetColCount()) * board.GetRowCount());
+
+    for (int i = 0; i < board.GetColCount(); ++i) {
+        auto columnOffset = size_t(i) * board.GetRowCount();
+        ApplyGravityToColumn(i, board.TypeData() + columnOffset, board.StateData() + columnOffset, board.GetRowCount(), boardGenerator, result);
+    }
+}
@@ -0,0 +1,164 @@
+#pragma once
+
+#include "Board.h"
+#include "BoardGenerator.h"
+#include "GameState.h"
+#include "MatchDetector.h"
+#include "Vec2.h"
+
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <cstring>
+#include <span>
+#include <vector>
+
+struct CellMove {
+    Vec2 From;
+    Vec2 To;
+};
+
+// New tiles come in from above the board, so From is outside of it
+struct SpawnedTile {
+    Vec2 From;
+    Vec2 To;
+    uint8_t Type;
+};
+
+// The record buffers are sized for a whole board by the first ApplyGravity and reused after that, so gravity never allocates.
+// Only the first MoveCount and SpawnedTileCount records belong to the last call.
+struct GravityResult {
+    std::vector<CellMove> MoveBuffer;
+    std::vector<SpawnedTile> SpawnedTileBuffer;
+    int MoveCount = 0;
+    int SpawnedTileCount = 0;
+    // The lowest row that changed in every column, or -1 if the column didn't change
+    std::vector<int> LowestChangedRows;
+
+    std::span<const CellMove> GetMoves() const { return { MoveBuffer.data(), size_t(MoveCount) }; }
+    std::span<const SpawnedTile> GetSpawnedTiles() const { return { SpawnedTileBuffer.data(), size_t(SpawnedTileCount) }; }
+
+    // Empties the result of a board with colCount columns and cellCount cells
+    void Reset(int colCount, size_t cellCount)
+    {
+        if (MoveBuffer.size() < cellCount) {
+            MoveBuffer.resize(cellCount);
+            SpawnedTileBuffer.resize(cellCount);
+        }
+
+        MoveCount = 0;
+        SpawnedTileCount = 0;
+        LowestChangedRows.assign(size_t(colCount), -1);
+    }
+};
+
+struct CascadeStep {
+    CellDestructionData Destruction;
+    std::vector<CellMove> Moves;
+    std::vector<SpawnedTile> SpawnedTiles;
+    // What IGameState::UpdateScore returned for this step, 0 if there was no game state to update
+    int ScoreDelta = 0;
+};
+
+// Resolves a whole cascade in one call, without any animation: destroy, fall, refill, until nothing can be destroyed
+class CascadeResolver {
+public:
+    CascadeResolver(int colCount, int rowCount, int tileKindCount);
+
+    // Switches the 2 cells and resolves the cascade. Returns no steps (and leaves the board untouched) if the swap destroys nothing.
+    std::vector<CascadeStep> ResolveSwap(Board& board, BoardGenerator& boardGenerator, Vec2 lhs, Vec2 rhs, IGameState* gameState = nullptr);
+    std::vector<CascadeStep> Resolve(Board& board, BoardGenerator& boardGenerator, CellDestructionData&& cellsToDestroy, IGameState* gameState = nullptr);
+    // The same cascade as Resolve without recording the steps, for searches that only need the sum of the score deltas
+    int ResolveScore(Board& board, BoardGenerator& boardGenerator, CellDestructionData&& cellsToDestroy, IGameState& gameState);
+
+    // Moves every cell above a destroyed cell down and fills the top of the columns with new tiles
+    static void ApplyGravity(Board& board, BoardGenerator& boardGenerator, GravityResult& result, bool useFixedBoard = true);
+
+    // The gravity of column x, given as rowCount cells from the top down. Appends to the records of result and sets its lowest changed row.
+    // BasicBoard calls it with a constant row count, so the loops below unroll there.
+    static void ApplyGravityToColumn(int x, uint8_t* types, CellState* states, int rowCount, BoardGenerator& boardGenerator, GravityResult& result)
+    {
+        constexpr int BlockSize = 64;
+
+        // Most columns have nothing destroyed, a bit per row finds those without going through the cells
+        int lowestDestroyed = -1;
+        for (int base = (rowCount - 1) / BlockSize * BlockSize; base >= 0 && lowestDestroyed < 0; base -= BlockSize) {
+            auto destroyed = DestroyedRowMask(states + base, std::min(BlockSize, rowCount - base));
+            if (destroyed != 0) {
+                lowestDestroyed = base + BlockSize - 1 - std::countl_zero(destroyed);
+            }
+        }
+
+        if (lowestDestroyed < 0) {
+            return;
+        }
+
+        result.LowestChangedRows[x] = lowestDestroyed;
+
+        // Everything above the lowest destroyed cell is compacted down to it. Every cell is copied and recorded as a move,
+        // but only the ones that are kept advance the write position, so there is no branch on the randomly destroyed cells.
+        // The buffer always has room for the extra record, as this column has at least one cell that doesn't move.
+        // Unlike MatchDetector this has no SSE path: a pshufb compaction of the types and states still needs this loop for the
+        // move records, and it measured slower than the loop alone on 8 row columns.
+        CellMove* moves = result.MoveBuffer.data() + result.MoveCount;
+        int moveCount = 0;
+        int writeRow = lowestDestroyed;
+
+        for (int readRow = lowestDestroyed - 1; readRow >= 0; --readRow) {
+            int isKept = states[readRow] != CellState::Destroyed;
+
+            types[writeRow] = types[readRow];
+            states[writeRow] = states[readRow];
+            moves[moveCount] = CellMove { Vec2 { x, readRow }, Vec2 { x, writeRow } };
+
+            moveCount += isKept;
+            writeRow -= isKept;
+        }
+
+        result.MoveCount += moveCount;
+
+        // The new tiles come in from the top, generated in one batch
+        int spawnedCount = writeRow + 1;
+        boardGenerator.GenerateTiles(types, spawnedCount);
+
+        SpawnedTile* spawnedTiles = result.SpawnedTileBuffer.data() + result.SpawnedTileCount;
+        for (int y = 0; y < spawnedCount; ++y) {
+            states[y] = CellState::Normal;
+            spawnedTiles[y] = SpawnedTile { Vec2 { x, y - spawnedCount }, Vec2 { x, y }, types[y] };
+        }
+
+        result.SpawnedTileCount += spawnedCount;
+    }
+
+private:
+    // Bit i is set if states[i] is Destroyed, for the first count (at most 64) cells
+    static uint64_t DestroyedRowMask(const CellState* states, int count)
+    {
+        static_assert(int(CellState::Destroyed) == 0 && sizeof(CellState) == 1, "Destroyed cells are found by looking for zero bytes");
+        static_assert(std::endian::native == std::endian::little, "The bytes are expected in memory order in the words");
+
+        uint64_t destroyed = 0;
+        int i = 0;
+
+        for (; i + 8 <= count; i += 8) {
+            uint64_t bytes;
+            std::memcpy(&bytes, states + i, 8);
+
+            // The high bit of a byte ends up set if and only if the byte is 0
+            constexpr uint64_t Low7Bits = 0x7F7F7F7F7F7F7F7Full;
+            auto zeroBytes = ~(((bytes & Low7Bits) + Low7Bits) | bytes | Low7Bits);
+
+            // Gathers the high bit of every byte into the top byte of the product
+            destroyed |= (((zeroBytes >> 7) * 0x0102040810204080ull) >> 56) << i;
+        }
+
+        for (; i < count; ++i) {
+            destroyed |= uint64_t(states[i] == CellState::Destroyed) << i;
+        }
+
+        return destroyed;
+    }
+
+    MatchDetector _matchDetector;
+    GravityResult _gravityResult;
+};
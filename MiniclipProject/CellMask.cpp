@@ -0,0 +1,65 @@
+#include "CellMask.h"
+
+#include <algorithm>
+
+CellMask::CellMask(int colCount, int rowCount)
+    : _colCount(colCount)
+    , _rowCount(rowCount)
+    , _wordsPerRow((colCount + BitsPerWord - 1) / BitsPerWord)
+    , _words(size_t(_wordsPerRow) * rowCount, 0)
+{
+}
+
+void CellMask::Clear()
+{
+    std::fill(_words.begin(), _words.end(), uint64_t(0));
+}
+
+bool CellMask::Any() const
+{
+    return std::any_of(_words.begin(), _words.end(), [](uint64_t word) { return word != 0; });
+}
+
+int CellMask::Count() const
+{
+    int count = 0;
+    for (auto word : _words) {
+        count += std::popcount(word);
+    }
+
+    return count;
+}
+
+bool CellMask::Intersects(const CellMask& other) const
+{
+    assert(_words.size() == other._words.size());
+
+    for (size_t i = 0; i < _words.size(); ++i) {
+        if ((_words[i] & other._words[i]) != 0) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+CellMask& CellMask::operator|=(const CellMask& other)
+{
+    assert(_words.size() == other._words.size());
+
+    for (size_t i = 0; i < _words.size(); ++i) {
+        _words[i] |= other._words[i];
+    }
+
+    return *this;
+}
+
+std::vector<Vec2> CellMask::ToIndices() const
+{
+    std::vector<Vec2> indices;
+    indices.reserve(Count());
+
+    ForEach([&indices](Vec2 index) { indices.push_back(index); });
+
+    return indices;
+}
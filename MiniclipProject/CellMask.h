@@ -0,0 +1,73 @@
+#pragma once
+
+#include "Vec2.h"
+
+#include <bit>
+#include <cassert>
+#include <cstdint>
+#include <vector>
+
+// A set of board cells stored as a bitboard. Every row is padded to a whole number of 64 bit words,
+// bit (x % 64) of word (y * WordsPerRow + x / 64) belongs to the cell at column x and row y.
+class CellMask {
+public:
+    static constexpr int BitsPerWord = 64;
+
+    CellMask(int colCount, int rowCount);
+
+    int GetColCount() const { return _colCount; }
+    int GetRowCount() const { return _rowCount; }
+    int GetWordsPerRow() const { return _wordsPerRow; }
+    int GetWordCount() const { return int(_words.size()); }
+
+    uint64_t* Words() { return _words.data(); }
+    const uint64_t* Words() const { return _words.data(); }
+
+    void Set(Vec2 index) { Word(index) |= Bit(index); }
+    void Reset(Vec2 index) { Word(index) &= ~Bit(index); }
+    bool Test(Vec2 index) const { return (Word(index) & Bit(index)) != 0; }
+
+    void Clear();
+    bool Any() const;
+    int Count() const;
+    bool Intersects(const CellMask& other) const;
+
+    CellMask& operator|=(const CellMask& other);
+
+    // Calls action for every cell in the set, in row major order
+    template <class Action>
+    void ForEach(Action&& action) const
+    {
+        for (int y = 0; y < _rowCount; ++y) {
+            for (int w = 0; w < _wordsPerRow; ++w) {
+                auto word = _words[size_t(y) * _wordsPerRow + w];
+                while (word != 0) {
+                    action(Vec2 { w * BitsPerWord + std::countr_zero(word), y });
+                    word &= word - 1;
+                }
+            }
+        }
+    }
+
+    std::vector<Vec2> ToIndices() const;
+
+private:
+    uint64_t& Word(Vec2 index)
+    {
+        assert(index.x >= 0 && index.x < _colCount && index.y >= 0 && index.y < _rowCount);
+        return _words[size_t(index.y) * _wordsPerRow + index.x / BitsPerWord];
+    }
+
+    uint64_t Word(Vec2 index) const
+    {
+        assert(index.x >= 0 && index.x < _colCount && index.y >= 0 && index.y < _rowCount);
+        return _words[size_t(index.y) * _wordsPerRow + index.x / BitsPerWord];
+    }
+
+    static uint64_t Bit(Vec2 index) { return uint64_t(1) << (index.x % BitsPerWord); }
+
+    int _colCount;
+    int _rowCount;
+    int _wordsPerRow;
+    std::vector<uint64_t> _words;
+};
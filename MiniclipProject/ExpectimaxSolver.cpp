@@ -0,0 +1,173 @@
+#include "ExpectimaxSolver.h"
+
+#include <algorithm>
+#include <cassert>
+
+ExpectimaxSolver::ExpectimaxSolver(int colCount, int rowCount, int tileKindCount, GameMode mode, const GameRules& rules, const ExpectimaxOptions& options, uint64_t seed)
+    : _options(options)
+    , _mode(mode)
+    , _rules(rules)
+    , _seed(seed)
+    , _matchDetector(colCount, rowCount, tileKindCount)
+    , _cascadeResolver(colCount, rowCount, tileKindCount)
+    , _zobristKeys(colCount, rowCount, tileKindCount)
+    , _sampleGenerator(tileKindCount, seed)
+    , _levelBoards(size_t(std::max(options.MaxDepth, 1)), Board(colCount, rowCount))
+{
+    assert(options.MaxDepth >= 1 && options.SampleCount >= 1 && options.MaxDepth <= UINT8_MAX);
+
+    if (options.TranspositionTableBytes > 0) {
+        _table.emplace(options.TranspositionTableBytes);
+    }
+}
+
+std::vector<ScoredMove> ExpectimaxSolver::ScoreMoves(const Board& board)
+{
+    _deadline = Clock::now() + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double, std::milli>(_options.TimeBudgetMs));
+    _hasDeadline = _options.TimeBudgetMs > 0;
+    _isOutOfTime = false;
+    _completedDepth = 0;
+    _searchedBoardCount = 0;
+    _tableHitCount = 0;
+
+    auto legalMoves = MoveFinder::FindLegalMoves(board, _matchDetector);
+    if (legalMoves.empty()) {
+        return {};
+    }
+
+    auto boardHash = _zobristKeys.Hash(board);
+    // Only the differences matter, a new game state keeps the running totals it counts the points with from overflowing
+    _gameState = MakeGameState(_mode, _rules);
+
+    // What the moves are ranked by if not even depth 1 can be finished in time
+    std::vector<ScoredMove> scoredMoves;
+    scoredMoves.reserve(legalMoves.size());
+    for (const auto& move : legalMoves) {
+        scoredMoves.push_back(ScoredMove { move.Source, move.Destination, double(_gameState->UpdateScore(move.Destruction)) });
+    }
+
+    std::vector<double> values(legalMoves.size());
+
+    for (int depth = 1; depth <= _options.MaxDepth && !IsOutOfTime(); ++depth) {
+        for (size_t i = 0; i < legalMoves.size() && !_isOutOfTime; ++i) {
+            values[i] = GetMoveValue(board, boardHash, legalMoves[i], depth, 0);
+        }
+
+        // An unfinished depth would compare moves that were searched to different depths, so it's thrown away
+        if (IsOutOfTime()) {
+            break;
+        }
+
+        for (size_t i = 0; i < legalMoves.size(); ++i) {
+            scoredMoves[i].ExpectedValue = values[i];
+        }
+        _completedDepth = depth;
+    }
+
+    std::stable_sort(scoredMoves.begin(), scoredMoves.end(), [](const ScoredMove& lhs, const ScoredMove& rhs) {
+        return lhs.ExpectedValue > rhs.ExpectedValue;
+    });
+
+    return scoredMoves;
+}
+
+double ExpectimaxSolver::GetBoardValue(const Board& board, int depth, int level)
+{
+    if (IsOutOfTime()) {
+        return 0.0;
+    }
+
+    // The depth is part of the key, a value searched to another depth counts the points of a different number of moves
+    ++_searchedBoardCount;
+    auto boardHash = _zobristKeys.Hash(board);
+    auto key = boardHash ^ (uint64_t(depth) * 0x9E3779B97F4A7C15);
+    if (_table) {
+        if (auto entry = _table->Probe(key); entry && entry->Depth == depth) {
+            ++_tableHitCount;
+            return entry->Value;
+        }
+    }
+
+    auto legalMoves = MoveFinder::FindLegalMoves(board, _matchDetector);
+
+    if (_options.MovesPerBoard > 0 && int(legalMoves.size()) > _options.MovesPerBoard) {
+        // The points of the first destruction are known without resolving anything, the moves are ranked by those
+        std::vector<std::pair<int, size_t>> rankedMoves;
+        rankedMoves.reserve(legalMoves.size());
+        for (size_t i = 0; i < legalMoves.size(); ++i) {
+            rankedMoves.emplace_back(_gameState->UpdateScore(legalMoves[i].Destruction), i);
+        }
+
+        auto kept = rankedMoves.begin() + _options.MovesPerBoard;
+        std::partial_sort(rankedMoves.begin(), kept, rankedMoves.end(), [](const auto& lhs, const auto& rhs) {
+            return lhs.first > rhs.first || (lhs.first == rhs.first && lhs.second < rhs.second);
+        });
+
+        std::vector<LegalMove> bestMoves;
+        bestMoves.reserve(size_t(_options.MovesPerBoard));
+        for (auto it = rankedMoves.begin(); it != kept; ++it) {
+            bestMoves.push_back(std::move(legalMoves[it->second]));
+        }
+        legalMoves = std::move(bestMoves);
+    }
+
+    // Without a legal move the board is shuffled, which doesn't earn anything
+    double bestValue = 0.0;
+
+    for (const auto& move : legalMoves) {
+        bestValue = std::max(bestValue, GetMoveValue(board, boardHash, move, depth, level));
+        if (_isOutOfTime) {
+            return 0.0;
+        }
+    }
+
+    // Rounded the way the table keeps it, so a board is worth the same whether it was found there or searched again
+    auto value = float(bestValue);
+    if (_table) {
+        _table->Store(key, TranspositionEntry { value, 0, uint8_t(depth), 0 });
+    }
+
+    return value;
+}
+
+double ExpectimaxSolver::GetMoveValue(const Board& board, uint64_t boardHash, const LegalMove& move, int depth, int level)
+{
+    // The moves of the board being solved get all the samples. Further ahead, the fewer moves are searched after a move
+    // the fewer samples it gets, so the value of a board only depends on how deep it's searched and not on where it's met.
+    int sampleCount = level == 0 ? _options.SampleCount : std::max(1, _options.SampleCount >> (_options.MaxDepth - depth));
+    auto& nextBoard = _levelBoards[size_t(level)];
+    double totalValue = 0.0;
+
+    for (int sample = 0; sample < sampleCount; ++sample) {
+        if (IsOutOfTime()) {
+            return 0.0;
+        }
+
+        // Every move of a board gets the same refills for the same sample, wherever and whenever the board is searched.
+        // The moves are compared on the same luck, so a few samples are enough to tell them apart.
+        _sampleGenerator.SetRandomGenerator(RandomGenerator(_seed ^ boardHash, uint64_t(sample)));
+
+        nextBoard = board;
+        nextBoard.SwapCells(move.Source, move.Destination);
+        totalValue += _cascadeResolver.ResolveScore(nextBoard, _sampleGenerator, CellDestructionData(move.Destruction), *_gameState);
+
+        if (depth > 1) {
+            totalValue += GetBoardValue(nextBoard, depth - 1, level + 1);
+        }
+    }
+
+    if (IsOutOfTime()) {
+        return 0.0;
+    }
+
+    return totalValue / sampleCount;
+}
+
+bool ExpectimaxSolver::IsOutOfTime()
+{
+    if (_hasDeadline && !_isOutOfTime && Clock::now() >= _deadline) {
+        _isOutOfTime = true;
+    }
+
+    return _isOutOfTime;
+}
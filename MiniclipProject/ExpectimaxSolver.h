@@ -0,0 +1,86 @@
+#pragma once
+
+#include "Board.h"
+#include "BoardGenerator.h"
+#include "CascadeResolver.h"
+#include "GameMode.h"
+#include "GameState.h"
+#include "MatchDetector.h"
+#include "MoveFinder.h"
+#include "TranspositionTable.h"
+#include "Vec2.h"
+#include "ZobristKeys.h"
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <vector>
+
+struct ExpectimaxOptions {
+    // How many moves ahead to look. Depths are searched one after the other, until the time runs out.
+    int MaxDepth = 3;
+    // How many refills are sampled after a move of the board being solved. Further ahead it's halved for every move that
+    // is searched after it less than at the deepest level, down to 1.
+    int SampleCount = 4;
+    // Every move of the board being solved is scored, but after that only the moves that earn the most right away are searched.
+    // 0 searches all of them.
+    int MovesPerBoard = 4;
+    // Counted from the start of ScoreMoves, finding the moves included. If not even depth 1 fits, the moves are ranked by
+    // the points of their first destruction. 0 or less searches every depth up to MaxDepth, so the result only depends on the board.
+    double TimeBudgetMs = 16.0;
+    // The values of the boards searched are kept in a transposition table of this size, 0 turns it off. A game played
+    // at depth 3 finds as many of them in this much as in 1 MiB.
+    size_t TranspositionTableBytes = size_t(64) << 10;
+};
+
+// Scores every legal move by what it's expected to earn over the next few moves. The tiles that fall in after
+// a move aren't known in advance, so every move is a chance node: its cascade is resolved with a few sampled refills
+// and the values of the boards they lead to are averaged. The points are counted by a game state of the mode with
+// the game's rules, so the solver always agrees with the game on what a cascade is worth.
+// The refills of a board are sampled from its Zobrist hash, so what a board is worth only depends on the board and
+// how deep it's searched. That's kept in a transposition table, which is never cleared: a board that comes up again,
+// in the same search or in the searches of the next moves, isn't searched again, and the result stays the same.
+class ExpectimaxSolver {
+public:
+    ExpectimaxSolver(int colCount, int rowCount, int tileKindCount, GameMode mode, const GameRules& rules = {}, const ExpectimaxOptions& options = {}, uint64_t seed = 0);
+
+    // Every legal move of the board with its value, the best first. Empty if the board has no legal moves.
+    std::vector<ScoredMove> ScoreMoves(const Board& board);
+
+    // The depth the moves were scored at by the last ScoreMoves, 0 if they only have the points of their first destruction
+    int GetCompletedDepth() const { return _completedDepth; }
+    // How many boards the last ScoreMoves searched, and how many of them were found in the transposition table instead
+    uint64_t GetSearchedBoardCount() const { return _searchedBoardCount; }
+    uint64_t GetTableHitCount() const { return _tableHitCount; }
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    ExpectimaxOptions _options;
+    GameMode _mode;
+    GameRules _rules;
+    uint64_t _seed;
+
+    MatchDetector _matchDetector;
+    CascadeResolver _cascadeResolver;
+    ZobristKeys _zobristKeys;
+    // Generates the sampled refills, the game's own generator is never touched
+    BoardGenerator _sampleGenerator;
+    std::unique_ptr<IGameState> _gameState;
+    std::optional<TranspositionTable> _table;
+
+    // The board after the move of every level of the search, reused so the search doesn't allocate them
+    std::vector<Board> _levelBoards;
+
+    Clock::time_point _deadline;
+    bool _hasDeadline = false;
+    bool _isOutOfTime = false;
+    int _completedDepth = 0;
+    uint64_t _searchedBoardCount = 0;
+    uint64_t _tableHitCount = 0;
+
+    double GetBoardValue(const Board& board, int depth, int level);
+    double GetMoveValue(const Board& board, uint64_t boardHash, const LegalMove& move, int depth, int level);
+    bool IsOutOfTime();
+};
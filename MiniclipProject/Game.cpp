@@ -7,20 +7,42 @@
 #include <fstream>
 #include <iostream>
 
-Game::Game()
+namespace {
+static const char* const LastReplayFilePath = "./last.replay";
+static const char* const SaveFilePath = "./game.save";
+}
+
+Game::Game(const std::optional<std::string>& replayFilePath, const std::optional<AutoplayOptions>& autoplayOptions)
     : _screen(Screen::GetScreen())
     , _inputProcessor(std::make_unique<InputProcessor>())
     , _highScore(std::make_unique<HighScore>())
+    , _replayRecorder(std::make_unique<ReplayRecorder>())
 {
     if (!_screen) {
         std::cerr << "Failed to initialize screen. Terminating..." << std::endl;
         std::terminate();
     }
 
+    if (replayFilePath) {
+        _replayPlayer = std::make_unique<ReplayPlayer>();
+        if (!_replayPlayer->Open(*replayFilePath)) {
+            std::cerr << "Failed to read replay " << *replayFilePath << std::endl;
+            _replayPlayer.reset();
+        } else if (_replayPlayer->GetHeader().TileKindCount > Screen::TileKindCount) {
+            std::cerr << "Replay " << *replayFilePath << " has more kinds of tiles than the game can draw" << std::endl;
+            _replayPlayer.reset();
+        }
+    }
+
     _audioPlayer = std::make_unique<AudioPlayer>();
-    _gameWorld = std::make_unique<GameWorld>(8, 8, 5, *_screen, *_audioPlayer);
+    if (_replayPlayer) {
+        const auto& header = _replayPlayer->GetHeader();
+        _gameWorld = std::make_unique<GameWorld>(header.RowCount, header.ColCount, header.TileKindCount, *_screen, *_audioPlayer, header.Seed);
+    } else {
+        _gameWorld = std::make_unique<GameWorld>(8, 8, 5, *_screen, *_audioPlayer, RandomGenerator::MakeSeed());
+        _player = std::make_unique<Player>(*_inputProcessor, *_gameWorld);
+    }
     _menu = std::make_unique<MainMenu>(*_screen, *_inputProcessor);
-    _player = std::make_unique<Player>(*_inputProcessor, *_gameWorld);
 
     // This is not strictly necessary, the game can be played without sound as well, so we don't terminate here
     if (!_audioPlayer->Initialize()) {
@@ -29,10 +51,29 @@ Game::Game()
 
     _keyPressedToken = _inputProcessor->KeyPressed.Subscribe([this](Key key) { HandleKeyPress(key); });
     _mouseClickedToken = _menu->ButtonClicked.Subscribe([this](ButtonType button) { HandleButtonClicked(button); });
+    _cellsSwitchedToken = _gameWorld->CellsSwitched.Subscribe([this](Vec2 source, Vec2 destination) { _replayRecorder->RecordSwitch(source, destination); });
+    _animationsSkippedToken = _gameWorld->AnimationsSkipped.Subscribe([this]() { _replayRecorder->RecordSkipAnimations(); });
 
     _highScore->ReadHighScore();
 
-    _menu->Activate(false, {});
+    if (autoplayOptions && !_replayPlayer) {
+        _soakMonitor = std::make_unique<SoakMonitor>(autoplayOptions->LogFilePath);
+        if (!_soakMonitor->IsOpen()) {
+            std::cerr << "Failed to open " << autoplayOptions->LogFilePath << " for the autoplay log" << std::endl;
+        }
+        _autoplayDriver = std::make_unique<AutoplayDriver>(*_gameWorld, *_menu, *_soakMonitor, RandomGenerator::MakeSeed(), autoplayOptions->DurationMs);
+    }
+
+    // Replays and autoplay runs aren't the player's games, so they don't touch the save
+    if (!_replayPlayer && !_autoplayDriver) {
+        _saveFileWriter = std::make_unique<SaveFileWriter>(SaveFilePath);
+    }
+
+    if (_replayPlayer) {
+        StartReplay();
+    } else {
+        _menu->Activate(_saveFileWriter && RestoreSavedGame(), {});
+    }
 }
 
 void Game::RunMainLoop()
@@ -42,6 +83,11 @@ void Game::RunMainLoop()
     while (!_shouldQuit) {
         auto now = SDL_GetTicks64();
         auto delta = now - previous;
+        auto frameStart = SDL_GetPerformanceCounter();
+
+        if (_autoplayDriver) {
+            _autoplayDriver->Update(_gameState == GameState::Playing, delta);
+        }
 
         ProcessEvents();
 
@@ -55,11 +101,26 @@ void Game::RunMainLoop()
             _menu->Draw();
         } break;
         case Game::GameState::Playing: {
-            _gameWorld->Update(delta);
+            UpdateGameWorld(delta);
 
             if (_gameStateObject->IsGameOver()) {
-                _highScore->AddScore(_gameStateObject->GetGameMode(), _gameStateObject->GetScore());
-                _highScore->WriteHighScore();
+                if (_replayPlayer) {
+                    // Once the replay is over, the game can be played normally
+                    _replayPlayer.reset();
+                    _player = std::make_unique<Player>(*_inputProcessor, *_gameWorld);
+                } else {
+                    _highScore->AddScore(_gameStateObject->GetGameMode(), _gameStateObject->GetScore());
+                    _highScore->WriteHighScore();
+                    _replayRecorder->End(_gameStateObject->GetScore());
+
+                    if (_saveFileWriter) {
+                        _saveFileWriter->Remove();
+                    }
+
+                    if (_soakMonitor) {
+                        _soakMonitor->RecordGameEnd();
+                    }
+                }
 
                 auto result = _gameStateObject->GetResult();
                 _gameStateObject.reset();
@@ -72,6 +133,10 @@ void Game::RunMainLoop()
 
         _screen->Present();
 
+        if (_soakMonitor) {
+            _soakMonitor->RecordFrame(double(SDL_GetPerformanceCounter() - frameStart) * 1000.0 / double(SDL_GetPerformanceFrequency()), delta);
+        }
+
         if (delta <= FrameTime) {
             SDL_Delay(uint32_t(FrameTime - delta));
         }
@@ -79,6 +144,11 @@ void Game::RunMainLoop()
         previous = now;
     }
 
+    // The game is saved whenever it's paused, so this is only needed if the window is closed during a game
+    if (_gameState == GameState::Playing) {
+        SaveGame();
+    }
+
     _highScore->WriteHighScore();
 }
 
@@ -111,6 +181,12 @@ void Game::HandleKeyPress(Key key)
     case Key::Escape: {
         ToggleIsPlaying();
     } break;
+    case Key::Space: {
+        // A replay plays back the skips that were recorded, the viewer can't add new ones
+        if (_gameState == GameState::Playing && !_replayPlayer) {
+            _gameWorld->SkipAnimations();
+        }
+    } break;
     }
 }
 
@@ -151,6 +227,11 @@ void Game::ToggleIsPlaying()
 
 void Game::EndGame(bool menuNeedsResumeButton, const std::vector<std::string>& additionalMenuText)
 {
+    if (menuNeedsResumeButton) {
+        _replayRecorder->RecordPause();
+        SaveGame();
+    }
+
     _gameWorld->Deactivate();
     _menu->Activate(menuNeedsResumeButton, additionalMenuText);
     _gameState = GameState::Paused;
@@ -158,6 +239,8 @@ void Game::EndGame(bool menuNeedsResumeButton, const std::vector<std::string>& a
 
 void Game::ResumeOrStartGame(std::optional<GameMode> gameMode)
 {
+    auto previousStateObject = _gameStateObject.get();
+
     if (gameMode) {
         switch (*gameMode) {
         case GameMode::Classic: {
@@ -176,4 +259,66 @@ void Game::ResumeOrStartGame(std::optional<GameMode> gameMode)
     _menu->Deactivate();
     _gameWorld->Activate(*_gameStateObject);
     _gameState = GameState::Playing;
+
+    if (_replayPlayer) {
+        return;
+    }
+
+    if (_gameStateObject.get() != previousStateObject) {
+        ReplayHeader header { _gameStateObject->GetGameMode(), _gameWorld->ColCount, _gameWorld->RowCount, _gameWorld->TileKindCount, _gameWorld->GetGameSeed() };
+        if (!_replayRecorder->Begin(LastReplayFilePath, header)) {
+            std::cerr << "Failed to open " << LastReplayFilePath << " for recording" << std::endl;
+        }
+    } else {
+        _replayRecorder->RecordResume();
+    }
+}
+
+void Game::StartReplay()
+{
+    const auto& header = _replayPlayer->GetHeader();
+
+    _gameStateObject = MakeGameState(header.Mode);
+    _gameWorld->Activate(*_gameStateObject, header.Seed);
+    _gameState = GameState::Playing;
+}
+
+bool Game::RestoreSavedGame()
+{
+    auto saveState = SaveState::ReadFile(SaveFilePath);
+    if (!saveState) {
+        return false;
+    }
+
+    auto gameStateObject = MakeGameState(saveState->Mode);
+    if (!_gameWorld->RestoreSaveState(*saveState, *gameStateObject)) {
+        std::cerr << "The saved game in " << SaveFilePath << " doesn't fit the board, starting without it" << std::endl;
+        return false;
+    }
+
+    // Resuming activates the world with the same state object, so the restored board is kept
+    _gameStateObject = std::move(gameStateObject);
+    return true;
+}
+
+void Game::SaveGame()
+{
+    if (_saveFileWriter && _gameStateObject) {
+        _saveFileWriter->Write(_gameWorld->CreateSaveState().Serialize());
+    }
+}
+
+void Game::UpdateGameWorld(uint64_t deltaTimeMs)
+{
+    if (_replayPlayer) {
+        // The recorded frame times are used instead of the real ones, so the animations end on the same frames
+        if (!_replayPlayer->PlayFrame(*_gameWorld) && !_gameStateObject->IsGameOver()) {
+            std::cerr << "The replay ended before the game was over" << std::endl;
+            _replayPlayer.reset();
+            _player = std::make_unique<Player>(*_inputProcessor, *_gameWorld);
+        }
+    } else {
+        _gameWorld->Update(deltaTimeMs);
+        _replayRecorder->RecordFrame(deltaTimeMs);
+    }
 }
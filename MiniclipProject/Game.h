@@ -1,16 +1,32 @@
 #pragma once
 
 #include "AudioPlayer.h"
+#include "AutoplayDriver.h"
 #include "GameMode.h"
 #include "GameWorld.h"
 #include "HighScore.h"
 #include "MainMenu.h"
 #include "Player.h"
+#include "ReplayPlayer.h"
+#include "ReplayRecorder.h"
+#include "SaveFileWriter.h"
 #include "Screen.h"
+#include "SoakMonitor.h"
+
+#include <optional>
+#include <string>
+
+struct AutoplayOptions {
+    // 0 plays until the window is closed
+    uint64_t DurationMs = 0;
+    std::string LogFilePath = "./autoplay.log";
+};
 
 class Game {
 public:
-    Game();
+    // With a replay file, the recorded game is played back instead of taking the player's input.
+    // With autoplay, a bot plays through synthesized input events and the run is logged for soak testing.
+    explicit Game(const std::optional<std::string>& replayFilePath = std::nullopt, const std::optional<AutoplayOptions>& autoplayOptions = std::nullopt);
 
     void RunMainLoop();
 
@@ -30,12 +46,19 @@ private:
     std::unique_ptr<Player> _player;
     std::unique_ptr<HighScore> _highScore;
     std::unique_ptr<AudioPlayer> _audioPlayer;
+    std::unique_ptr<ReplayRecorder> _replayRecorder;
+    std::unique_ptr<ReplayPlayer> _replayPlayer;
+    std::unique_ptr<SoakMonitor> _soakMonitor;
+    std::unique_ptr<AutoplayDriver> _autoplayDriver;
+    std::unique_ptr<SaveFileWriter> _saveFileWriter;
 
     bool _shouldQuit = false;
     GameState _gameState = GameState::Paused;
 
     std::unique_ptr<EventToken> _keyPressedToken;
     std::unique_ptr<EventToken> _mouseClickedToken;
+    std::unique_ptr<EventToken> _cellsSwitchedToken;
+    std::unique_ptr<EventToken> _animationsSkippedToken;
     std::unique_ptr<IGameState> _gameStateObject;
 
     void ProcessEvents();
@@ -44,4 +67,8 @@ private:
     void ToggleIsPlaying();
     void EndGame(bool menuNeedsResumeButton, const std::vector<std::string>& additionalMenuText);
     void ResumeOrStartGame(std::optional<GameMode> gameMode = std::nullopt);
+    void StartReplay();
+    bool RestoreSavedGame();
+    void SaveGame();
+    void UpdateGameWorld(uint64_t deltaTimeMs);
 };
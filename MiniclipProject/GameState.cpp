@@ -1,6 +1,8 @@
 #include "GameState.h"
 
-#include "GameWorld.h"
+#include "MatchDetector.h"
+
+#include <algorithm>
 
 namespace {
 std::string ToStringWith2FractionalDigits(uint64_t timeMs)
@@ -19,16 +21,36 @@ std::string ToStringWith2FractionalDigits(uint64_t timeMs)
 }
 }
 
-void ClassicGameState::UpdateScore(const CellDestructionData& data)
+int GameRules::GetPoints(int destroyedCellCount, int highestCombo) const
 {
-    // The player gets 20 points for each cell
+    // With the default rules the player gets 20 points for each cell
     // 5 extra points are given for each cell after each destroyed tile in the longest streak
     // So if there is a row of 5 and a total of 8 cells are destroyed, that's 8 x 30 = 240 points
+    auto pointsForEachCell = PointsPerCell + (highestCombo - 3) * ComboPointsPerCell;
+
+    return pointsForEachCell * destroyedCellCount;
+}
+
+int GameRules::GetTimeGainedMs(int destroyedCellCount, int highestCombo, bool isOverlappingMove) const
+{
+    auto timeForEachCellMs = TimePerCellMs + (highestCombo - 3) * ComboTimePerCellMs;
+    auto timeGainedMs = timeForEachCellMs * destroyedCellCount;
+
+    return isOverlappingMove ? timeGainedMs * OverlappingMoveTimePercent / 100 : timeGainedMs;
+}
+
+ClassicGameState::ClassicGameState(const GameRules& rules)
+    : _rules(rules)
+{
+}
 
+int ClassicGameState::UpdateScore(const CellDestructionData& data)
+{
     auto highestCombo = std::max(data.HighestColumnCombo, data.HighestRowCombo);
-    auto pointsForEachCell = 20 + (highestCombo - 3) * 5;
+    auto points = _rules.GetPoints(int(data.DestroyedCells.size()), highestCombo);
+    _score += points;
 
-    _score += pointsForEachCell * int(data.DestroyedCells.size());
+    return points;
 }
 
 std::vector<std::string> ClassicGameState::GetUIText()
@@ -37,7 +59,7 @@ std::vector<std::string> ClassicGameState::GetUIText()
         "Current score:",
         std::to_string(_score),
         "Goal: ",
-        std::to_string(ScoreToReach),
+        std::to_string(_rules.ScoreToReach),
         "Time passed: ",
         ToStringWith2FractionalDigits(_timePassedMs),
     };
@@ -45,7 +67,7 @@ std::vector<std::string> ClassicGameState::GetUIText()
 
 std::vector<std::string> ClassicGameState::GetResult()
 {
-    return { std::string("You reached: ") + std::to_string(ScoreToReach) + " points in " + ToStringWith2FractionalDigits(_timePassedMs) + " seconds!" };
+    return { std::string("You reached: ") + std::to_string(_rules.ScoreToReach) + " points in " + ToStringWith2FractionalDigits(_timePassedMs) + " seconds!" };
 }
 
 int ClassicGameState::GetScore() const
@@ -60,7 +82,26 @@ GameMode ClassicGameState::GetGameMode() const
 
 bool ClassicGameState::IsGameOver() const
 {
-    return _score >= ScoreToReach;
+    return _score >= _rules.ScoreToReach;
+}
+
+GameStateValues ClassicGameState::GetValues() const
+{
+    auto values = IGameState::GetValues();
+    values.Score = _score;
+    return values;
+}
+
+void ClassicGameState::SetValues(const GameStateValues& values)
+{
+    IGameState::SetValues(values);
+    _score = values.Score;
+}
+
+QuickDeathGameState::QuickDeathGameState(const GameRules& rules)
+    : _rules(rules)
+    , _timeLeft(rules.InitialTimeLeftMs)
+{
 }
 
 bool QuickDeathGameState::IsGameOver() const
@@ -75,12 +116,13 @@ void QuickDeathGameState::Update(int deltaTime)
     _timeLeft -= deltaTime;
 }
 
-void QuickDeathGameState::UpdateScore(const CellDestructionData& data)
+int QuickDeathGameState::UpdateScore(const CellDestructionData& data)
 {
     auto highestCombo = std::max(data.HighestColumnCombo, data.HighestRowCombo);
-    auto timeForEachCellMs = 300 + (highestCombo - 3) * 300; // extra 200 ms for each cell above 3 in the highest streak
+    auto timeGained = _rules.GetTimeGainedMs(int(data.DestroyedCells.size()), highestCombo, _isOverlappingMove);
+    _timeLeft += timeGained;
 
-    _timeLeft += int(timeForEachCellMs * data.DestroyedCells.size());
+    return timeGained;
 }
 
 std::vector<std::string> QuickDeathGameState::GetUIText()
@@ -107,7 +149,47 @@ GameMode QuickDeathGameState::GetGameMode() const
     return GameMode::QuickDeath;
 }
 
+GameStateValues QuickDeathGameState::GetValues() const
+{
+    auto values = IGameState::GetValues();
+    values.TimeLeftMs = _timeLeft;
+    return values;
+}
+
+void QuickDeathGameState::SetValues(const GameStateValues& values)
+{
+    IGameState::SetValues(values);
+    _timeLeft = values.TimeLeftMs;
+}
+
 void IGameState::Update(int deltaTime)
 {
     _timePassedMs += deltaTime;
 }
+
+void IGameState::SetIsOverlappingMove(bool isOverlappingMove)
+{
+    _isOverlappingMove = isOverlappingMove;
+}
+
+GameStateValues IGameState::GetValues() const
+{
+    return GameStateValues { _timePassedMs };
+}
+
+void IGameState::SetValues(const GameStateValues& values)
+{
+    _timePassedMs = values.TimePassedMs;
+}
+
+std::unique_ptr<IGameState> MakeGameState(GameMode mode, const GameRules& rules)
+{
+    switch (mode) {
+    case GameMode::Classic:
+        return std::make_unique<ClassicGameState>(rules);
+    case GameMode::QuickDeath:
+        return std::make_unique<QuickDeathGameState>(rules);
+    }
+
+    return nullptr;
+}
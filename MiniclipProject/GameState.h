@@ -1,5 +1,7 @@
 #pragma once
 
+#include <cstdint>
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -7,51 +9,93 @@
 
 struct CellDestructionData;
 
+// The numbers that decide how hard a game is. The defaults are the ones the game is played with.
+struct GameRules {
+    // Classic
+    int ScoreToReach = 3000;
+    int PointsPerCell = 20;
+    int ComboPointsPerCell = 5; // For each cell above 3 in the longest streak
+
+    // QuickDeath
+    int InitialTimeLeftMs = 15000;
+    int TimePerCellMs = 300;
+    int ComboTimePerCellMs = 300; // For each cell above 3 in the longest streak
+    // A move made while the cascade of an earlier move is still playing only gains this much of its time,
+    // otherwise switching as fast as possible would gain time faster than it runs out
+    int OverlappingMoveTimePercent = 50;
+
+    int GetPoints(int destroyedCellCount, int highestCombo) const;
+    int GetTimeGainedMs(int destroyedCellCount, int highestCombo, bool isOverlappingMove) const;
+};
+
+// Everything about a game that changes while it's played, so it can be put back (eg. after an undo)
+struct GameStateValues {
+    uint64_t TimePassedMs = 0;
+    int Score = 0; // Only used in Classic
+    int TimeLeftMs = 0; // Only used in QuickDeath
+};
+
 class IGameState {
 public:
-    virtual void UpdateScore(const CellDestructionData& datas) = 0;
+    // Returns how much the score (or the time left) changed
+    virtual int UpdateScore(const CellDestructionData& datas) = 0;
     virtual std::vector<std::string> GetUIText() = 0;
     virtual std::vector<std::string> GetResult() = 0;
 
     virtual void Update(int deltaTime);
+    // Set by the board before the cells of a move are destroyed
+    virtual void SetIsOverlappingMove(bool isOverlappingMove);
     virtual bool IsGameOver() const = 0;
     virtual GameMode GetGameMode() const = 0;
 
     virtual int GetScore() const = 0;
 
+    virtual GameStateValues GetValues() const;
+    virtual void SetValues(const GameStateValues& values);
+
     virtual ~IGameState() = default;
 
 protected:
     uint64_t _timePassedMs = 0;
+    bool _isOverlappingMove = false;
 };
 
 class ClassicGameState : public IGameState {
 public:
-    void UpdateScore(const CellDestructionData& datas) override;
+    explicit ClassicGameState(const GameRules& rules = {});
+
+    int UpdateScore(const CellDestructionData& datas) override;
     std::vector<std::string> GetUIText() override;
     std::vector<std::string> GetResult() override;
     virtual int GetScore() const override;
     virtual GameMode GetGameMode() const override;
     virtual bool IsGameOver() const override;
+    GameStateValues GetValues() const override;
+    void SetValues(const GameStateValues& values) override;
 
 private:
-    static constexpr int ScoreToReach = 3000;
-    int _score;
+    GameRules _rules;
+    int _score = 0;
 };
 
 class QuickDeathGameState : public IGameState {
 public:
+    explicit QuickDeathGameState(const GameRules& rules = {});
+
     bool IsGameOver() const override;
     void Update(int deltaTime) override;
 
-    void UpdateScore(const CellDestructionData& datas) override;
+    int UpdateScore(const CellDestructionData& datas) override;
     std::vector<std::string> GetUIText() override;
     std::vector<std::string> GetResult() override;
     virtual int GetScore() const override;
     virtual GameMode GetGameMode() const override;
+    GameStateValues GetValues() const override;
+    void SetValues(const GameStateValues& values) override;
 
 private:
-    static constexpr int InitialTimeLeft = 15000; // Start with 10 seconds
-
-    int _timeLeft = InitialTimeLeft;
+    GameRules _rules;
+    int _timeLeft;
 };
+
+std::unique_ptr<IGameState> MakeGameState(GameMode mode, const GameRules& rules = {});
@@ -1,81 +1,69 @@
 #include "GameWorld.h"
 
-namespace {
-bool Contains(const std::array<int, 2>& arr, int value)
-{
-    return std::find(arr.begin(), arr.end(), value) != arr.end();
-}
-}
-
-Cell::Cell(int type)
-    : Type(type)
-{
-}
-
-void Cell::Destroy()
-{
-    State = CellState::Destroyed;
-}
+#include <algorithm>
+#include <cmath>
+#include <numbers>
 
-int GameWorld::GetRandomNumber(const std::array<int, 2>& excluding)
+namespace {
+// Grows the copy to the capacity of the original, so it only allocates again when the original has grown
+template <class T>
+void AssignKeepingCapacity(std::vector<T>& to, const std::vector<T>& from)
 {
-    int randomNumber = _randomDistribution(_randomEngine);
-    while (Contains(excluding, randomNumber)) {
-        randomNumber = (randomNumber + 1) % TileKindCount;
-    }
-
-    return randomNumber;
+    to.reserve(from.capacity());
+    to.assign(from.begin(), from.end());
 }
-
-Cell GameWorld::GenerateCellForIndex(int i, int j)
-{
-    std::array<int, 2> excludedNumbers = { -1, -1 };
-
-    // If the current row's or column's previous 2 cells have the same type, then generate another kind
-    if (i > 1 && _gameBoard[i - 1][j].Type == _gameBoard[i - 2][j].Type) {
-        excludedNumbers[0] = _gameBoard[i - 1][j].Type;
-    }
-    if (j > 1 && _gameBoard[i][j - 1].Type == _gameBoard[i][j - 2].Type) {
-        excludedNumbers[1] = _gameBoard[i][j - 1].Type;
-    }
-
-    return Cell(GetRandomNumber(excludedNumbers));
 }
 
 void GameWorld::FillBoard()
 {
-    _gameBoard.reserve(ColCount);
-    _gameBoard.clear();
-
-    for (int i = 0; i < RowCount; ++i) {
-        auto& column = _gameBoard.emplace_back();
-        column.reserve(RowCount);
-        for (int j = 0; j < RowCount; ++j) {
-            column.push_back(GenerateCellForIndex(i, j));
-        }
+    if (!_boardGenerator.FillBoard(_gameBoard, MinLegalMovesAfterShuffle)) {
+        // Only a board too small for that many moves gets fewer, but one without any can't be played at all
+        assert(MoveFinder::CountLegalMoves(_gameBoard, 1) > 0);
     }
+    _boardHash = _zobristKeys.Hash(_gameBoard);
 }
 
-GameWorld::GameWorld(int rowCount, int colCount, int tileKindCount, Screen& screen, AudioPlayer& audioPlayer)
+GameWorld::GameWorld(int rowCount, int colCount, int tileKindCount, IRenderer& renderer, IAudioSink& audioSink, uint64_t seed)
     : RowCount(rowCount)
     , ColCount(colCount)
     , TileKindCount(tileKindCount)
-    , _screen(&screen)
-    , _randomEngine(_randomDevice())
-    , _randomDistribution(0, tileKindCount - 1) // Random distribution is inclusive on both ends, so the range [0, n - 1] will contain n possible values
-    , _audioPlayer(&audioPlayer)
+    , _gameBoard(colCount, rowCount)
+    , _matchDetector(colCount, rowCount, tileKindCount)
+    , _zobristKeys(colCount, rowCount, tileKindCount)
+    , _undoHistory(colCount, rowCount)
+    , _renderer(&renderer)
+    , _boardGenerator(tileKindCount, seed)
+    , _seedGenerator(seed, 1) // A different stream than the board generator, so the game seeds don't repeat the tiles
+    , _gameSeed(seed)
+    , _wordsPerTrack((colCount * rowCount + CellMask::BitsPerWord - 1) / CellMask::BitsPerWord)
+    , _audioSink(&audioSink)
 {
     FillBoard();
+
+    // Snapshots grow to the capacity of the timeline they copy, so this also keeps them from allocating in most games
+    auto cellCount = size_t(_gameBoard.GetCellCount());
+    _timeline.Tracks.reserve(ReservedTimelineTracks);
+    _timeline.Steps.reserve(ReservedTimelineSteps);
+    _timeline.CellAnimations.reserve(ReservedTimelineCellsPerStep * cellCount);
+    _timeline.BoardTypes.reserve((ReservedTimelineTracks + ReservedTimelineSteps) * cellCount);
+    _timeline.BoardStates.reserve((ReservedTimelineTracks + ReservedTimelineSteps) * cellCount);
+    _timeline.CellWords.reserve(ReservedTimelineTracks * size_t(_wordsPerTrack));
 }
 
-void GameWorld::Activate(IGameState& gameState)
+void GameWorld::Activate(IGameState& gameState, std::optional<uint64_t> gameSeed)
 {
     _isActive = true;
 
     if (_gameState != &gameState) {
         _gameState = &gameState;
-        _animationState.reset();
+        _gameSeed = gameSeed.value_or(_seedGenerator.Next());
+        _boardGenerator.Seed(_gameSeed);
+        ClearTracks();
         _activeCellState.reset();
+        _cascadeDepth = 0;
+        _switchCountThisFrame = 0;
+        _undoHistory.Clear();
+        ResetHint();
         FillBoard();
     }
 }
@@ -87,44 +75,66 @@ void GameWorld::Deactivate()
 
 void GameWorld::Draw()
 {
-    for (int i = 0; i < _gameBoard.size(); ++i) {
-        auto& currentRow = _gameBoard[i];
-        for (int j = 0; j < currentRow.size(); ++j) {
-            if (_gameBoard[i][j].State == Cell::CellState::Normal) {
-                _screen->DrawCell(Vec2 { i * TileSize, j * TileSize }, _gameBoard[i][j].Type, TileSize, TileSize);
+    if (_timeline.Tracks.empty()) {
+        for (int i = 0; i < ColCount; ++i) {
+            auto types = _gameBoard.ColumnTypes(i);
+            auto states = _gameBoard.ColumnStates(i);
+            for (int j = 0; j < RowCount; ++j) {
+                if (states[j] == CellState::Normal) {
+                    _renderer->DrawCell(Vec2 { i * TileSize, j * TileSize }, types[j], TileSize, TileSize);
+                }
             }
         }
+    } else {
+        // The board is already at the end of every move, the cells that are still moving show the step that is playing instead
+        for (int i = 0; i < ColCount; ++i) {
+            for (int j = 0; j < RowCount; ++j) {
+                Vec2 index { i, j };
+                auto [types, states] = GetShownBoard(index);
+                if (states[i * RowCount + j] == CellState::Normal) {
+                    _renderer->DrawCell(index * TileSize, types[i * RowCount + j], TileSize, TileSize);
+                }
+            }
+        }
+    }
+
+    if (_hint) {
+        // Pulse the highlight of the hinted cells with a period of 1 second
+        auto alpha = uint8_t(60 + sin(_idleTimeMs / 1000.f * 2 * std::numbers::pi) * 60);
+        for (auto index : { _hint->Source, _hint->Destination }) {
+            _renderer->DrawBackgroundRectangle(Rect { index.x * TileSize, index.y * TileSize, TileSize, TileSize }, Color { 255, 255, 255, alpha });
+        }
     }
 
     if (_activeCellState) {
         // Make a periodic function with a period of 1 second and in the range [0, 0.2]
-        auto scaleDiff = (sin(_activeCellState->AnimationTimePassed / 1000.f * 2 * M_PI)) * 0.1;
+        auto scaleDiff = (sin(_activeCellState->AnimationTimePassed / 1000.f * 2 * std::numbers::pi)) * 0.1;
         auto newSize = TileSize * (1 + scaleDiff);
         auto halfDiff = int((newSize - TileSize) / 2.0);
 
-        _screen->DrawCell(
+        _renderer->DrawCell(
             _activeCellState->Index * TileSize - Vec2 { halfDiff, halfDiff } + _activeCellState->Offset,
-            At(_activeCellState->Index).Type,
+            _gameBoard.Type(_activeCellState->Index),
             TileSize,
             int(newSize));
     }
 
-    if (_animationState) {
-        if (std::holds_alternative<std::vector<CellAnimationMoveData>>(_animationState->AnimationData)) {
-            auto& animationData = std::get<std::vector<CellAnimationMoveData>>(_animationState->AnimationData);
-            for (const auto& [startPosition, endPosition, cellType, startPositionOverride] : animationData) {
-                auto realStartPosition = startPositionOverride.value_or(startPosition);
-                _screen->DrawCell(realStartPosition.Lerp(endPosition, _animationState->AnimationProgress), cellType, TileSize, TileSize);
-            }
-        } else if (std::holds_alternative<std::vector<CellAnimationDestructionData>>(_animationState->AnimationData)) {
-            auto& animationData = std::get<std::vector<CellAnimationDestructionData>>(_animationState->AnimationData);
-            for (const auto& [cellIndex, cellType] : animationData) {
-                double newSize = (1 - _animationState->AnimationProgress) * TileSize;
+    for (const auto& track : _timeline.Tracks) {
+        if (!track.IsPlaying) {
+            continue;
+        }
+
+        const auto& animationState = _timeline.Steps[size_t(track.FirstStep)];
+        for (int i = animationState.FirstCell; i < animationState.EndCell; ++i) {
+            const auto& [startPosition, endPosition, cellType] = _timeline.CellAnimations[size_t(i)];
+            if (animationState.Kind == AnimationKind::Move) {
+                _renderer->DrawCell(startPosition.Lerp(endPosition, animationState.AnimationProgress), cellType, TileSize, TileSize);
+            } else {
+                double newSize = (1 - animationState.AnimationProgress) * TileSize;
                 auto halfDiff = int((TileSize - newSize) / 2);
-                auto offset = Vec2 { halfDiff, halfDiff };
 
-                _screen->DrawCell(cellIndex * TileSize + Vec2 { halfDiff, halfDiff }, cellType, TileSize, int(newSize));
-                _screen->DrawDestroyAnimation(cellIndex * TileSize, TileSize, _animationState->AnimationProgress);
+                _renderer->DrawCell(endPosition + Vec2 { halfDiff, halfDiff }, cellType, TileSize, int(newSize));
+                _renderer->DrawDestroyAnimation(endPosition, TileSize, animationState.AnimationProgress);
             }
         }
     }
@@ -134,14 +144,14 @@ void GameWorld::Draw()
     static constexpr int textHeight = 40;
 
     auto textLines = _gameState->GetUIText();
-    auto textPosition = 560 + (_screen->ScreenWidth - 560 - textWidth) / 2;
-    SDL_Rect textRect { textPosition, 50, textWidth, textHeight };
-    SDL_Rect uIBackgroundRect { textRect.x - spacing, textRect.y - spacing, textRect.w + 2 * spacing, int(textLines.size() + 2) * spacing };
+    auto textPosition = 560 + (_renderer->GetScreenWidth() - 560 - textWidth) / 2;
+    Rect textRect { textPosition, 50, textWidth, textHeight };
+    Rect uIBackgroundRect { textRect.x - spacing, textRect.y - spacing, textRect.w + 2 * spacing, int(textLines.size() + 2) * spacing };
 
-    _screen->DrawBackgroundRectangle(uIBackgroundRect);
+    _renderer->DrawBackgroundRectangle(uIBackgroundRect);
 
     for (const auto& line : textLines) {
-        _screen->DrawText(line, textRect, true);
+        _renderer->DrawText(line, textRect, true);
         textRect.y += spacing;
     }
 }
@@ -149,57 +159,26 @@ void GameWorld::Draw()
 void GameWorld::Update(uint64_t deltaTimeMs)
 {
     _gameState->Update(int(deltaTimeMs));
+    _switchCountThisFrame = 0;
 
-    if (_animationState) {
-        _animationState->AnimationTimePassed += deltaTimeMs;
-
-        double rawProgress = _animationState->AnimationTimePassed / _animationState->AnimationDuration;
-
-        if (_animationState->EffectToPlay) {
-            _audioPlayer->PlaySoundEffect(*_animationState->EffectToPlay);
-            _animationState->EffectToPlay.reset();
-        } else if (rawProgress > 1.0) {
-            auto completion = std::move(_animationState->Completion);
+    if (auto& tracks = _timeline.Tracks; !tracks.empty()) {
+        // Decided before any track moves on, so a track that waited starts on the frame after the one it waited for ends
+        for (size_t i = 0; i < tracks.size(); ++i) {
+            tracks[i].IsPlaying = !IsSharingCellsWithEarlierTrack(i);
+        }
 
-            for (auto& column : _gameBoard) {
-                for (auto& cell : column) {
-                    if (cell.State == Cell::CellState::WaitingForAnimationToComplete) {
-                        cell.State = _animationState->FinalCellState;
-                    }
-                }
+        bool hasFinishedTracks = false;
+        for (auto& track : tracks) {
+            if (track.IsPlaying) {
+                UpdateTrack(track, deltaTimeMs);
+                hasFinishedTracks |= track.FirstStep == track.EndStep;
             }
+        }
 
-            _animationState.reset();
-
-            if (completion) {
-                completion();
-            }
-        } else {
-            switch (_animationState->EasingFun) {
-            case EasingFunction::EaseInCubic: {
-                _animationState->AnimationProgress = pow(rawProgress, 3);
-            } break;
-            case EasingFunction::EaseOutBounce: {
-                // Taken from https://easings.net/#easeOutBounce
-                static const double n1 = 7.5625;
-                static const double d1 = 2.75;
-                double x = rawProgress;
-                double animationProgress;
-
-                if (x < 1 / d1) {
-                    animationProgress = n1 * x * x;
-                } else if (x < 2 / d1) {
-                    x -= 1.5 / d1;
-                    animationProgress = n1 * x * x + 0.75;
-                } else if (x < 2.5 / d1) {
-                    x -= 2.25 / d1;
-                    animationProgress = n1 * x * x + 0.9375;
-                } else {
-                    x -= 2.625 / d1;
-                    animationProgress = n1 * x * x + 0.984375;
-                }
-                _animationState->AnimationProgress = animationProgress;
-            } break;
+        if (hasFinishedTracks) {
+            RemoveFinishedTracks();
+            if (tracks.empty()) {
+                EndMove();
             }
         }
     }
@@ -207,15 +186,80 @@ void GameWorld::Update(uint64_t deltaTimeMs)
     if (_activeCellState) {
         _activeCellState->AnimationTimePassed += deltaTimeMs;
     }
+
+    UpdateHint(deltaTimeMs);
+}
+
+void GameWorld::UpdateTrack(AnimationTrack& track, uint64_t deltaTimeMs)
+{
+    auto& animationState = _timeline.Steps[size_t(track.FirstStep)];
+    animationState.AnimationTimePassed += deltaTimeMs;
+
+    double rawProgress = animationState.AnimationTimePassed / animationState.AnimationDuration;
+
+    if (animationState.EffectToPlay) {
+        _audioSink->PlaySoundEffect(*animationState.EffectToPlay);
+        animationState.EffectToPlay.reset();
+    } else if (rawProgress > 1.0) {
+        // Nothing to do but show the next step, it was all decided when the switch was made
+        ++track.FirstStep;
+    } else {
+        switch (animationState.EasingFun) {
+        case EasingFunction::EaseInCubic: {
+            animationState.AnimationProgress = pow(rawProgress, 3);
+        } break;
+        case EasingFunction::EaseOutBounce: {
+            // Taken from https://easings.net/#easeOutBounce
+            static const double n1 = 7.5625;
+            static const double d1 = 2.75;
+            double x = rawProgress;
+            double animationProgress;
+
+            if (x < 1 / d1) {
+                animationProgress = n1 * x * x;
+            } else if (x < 2 / d1) {
+                x -= 1.5 / d1;
+                animationProgress = n1 * x * x + 0.75;
+            } else if (x < 2.5 / d1) {
+                x -= 2.25 / d1;
+                animationProgress = n1 * x * x + 0.9375;
+            } else {
+                x -= 2.625 / d1;
+                animationProgress = n1 * x * x + 0.984375;
+            }
+            animationState.AnimationProgress = animationProgress;
+        } break;
+        }
+    }
 }
 
 bool GameWorld::IsInteractionEnabled() const
 {
-    return _isActive && !_animationState.has_value();
+    return _isActive;
+}
+
+bool GameWorld::IsSettled() const
+{
+    return _timeline.Tracks.empty();
+}
+
+bool GameWorld::IsCellInMotion(Vec2 index) const
+{
+    for (size_t i = 0; i < _timeline.Tracks.size(); ++i) {
+        if (IsTrackCell(i, index)) {
+            return true;
+        }
+    }
+
+    return false;
 }
 
 void GameWorld::SetActiveCell(std::optional<Vec2> index, Vec2 offset)
 {
+    if (index && IsCellInMotion(*index)) {
+        return;
+    }
+
     if (index) {
         if (abs(offset.x) > DragOffsetSuccessThreshold) { // Successful drag in the x direction
             if (auto newCell = *index + Vec2 { offset.x > 0 ? 1 : -1, 0 }; IsIndexOnTheBoard(newCell)) {
@@ -235,21 +279,20 @@ void GameWorld::SetActiveCell(std::optional<Vec2> index, Vec2 offset)
             } else {
                 _activeCellState.emplace(
                     *index, offset, 0);
-                At(*index).State = Cell::CellState::Active;
+                _gameBoard.State(*index) = CellState::Active;
             }
         }
     } else {
         if (_activeCellState) {
             auto activeIndex = _activeCellState->Index;
-            if (At(activeIndex).State == Cell::CellState::Active) {
-                At(activeIndex).State = Cell::CellState::Normal;
+            if (_gameBoard.State(activeIndex) == CellState::Active) {
+                _gameBoard.State(activeIndex) = CellState::Normal;
 
                 if (offset != Vec2 { 0, 0 }) {
-                    MoveCellsAnimated({ CellAnimationMoveData { Vec2 {},
-                                          activeIndex,
-                                          At(activeIndex).Type,
-                                          activeIndex * TileSize + _activeCellState->Offset } },
-                        CellSwitchAnimationDurationMs, nullptr);
+                    auto track = MakeTrack();
+                    CellAnimationMoveData moveData { Vec2 {}, activeIndex, _gameBoard.Type(activeIndex), activeIndex * TileSize + _activeCellState->Offset };
+                    QueueMoveAnimation(track, { &moveData, 1 }, CellSwitchAnimationDurationMs);
+                    AddTrack(track);
                 }
             }
             _activeCellState.reset();
@@ -259,42 +302,62 @@ void GameWorld::SetActiveCell(std::optional<Vec2> index, Vec2 offset)
 
 bool GameWorld::TrySwitchCells(Vec2 lhs, Vec2 rhs, bool isDraggedCellTheSource)
 {
-    assert(lhs.x >= 0 && lhs.x < RowCount);
-    assert(lhs.y >= 0 && lhs.y < ColCount);
-    assert(rhs.x >= 0 && rhs.x < RowCount);
-    assert(rhs.y >= 0 && rhs.y < ColCount);
+    assert(IsIndexOnTheBoard(lhs));
+    assert(IsIndexOnTheBoard(rhs));
     assert(!isDraggedCellTheSource || _activeCellState);
 
     if (lhs.DistanceSquared(rhs) == 1) {
-        auto tmp = At(lhs);
-        At(lhs) = At(rhs);
-        At(rhs) = tmp;
-
-        // Check if we can destroy something in the new state
-        auto cellsToDestroy = GetCellsToDestroyFromCurrentState();
-
-        // Restore the original state
-        tmp = At(lhs);
-        At(lhs) = At(rhs);
-        At(rhs) = tmp;
-
-        if (!cellsToDestroy.DestroyedCells.empty()) {
-            MoveCellsAnimated(
-                {
-                    CellAnimationMoveData { lhs, rhs, At(lhs).Type, isDraggedCellTheSource ? _activeCellState->Index * TileSize + _activeCellState->Offset : std::optional<Vec2>() },
-                    CellAnimationMoveData { rhs, lhs, At(rhs).Type, std::nullopt },
-                },
-                CellSwitchAnimationDurationMs, [this]() { UpdateBoardState(); });
+        // Check if we can destroy something in the new state. Only the rows and columns of the 2 cells can change
+        auto cellsToDestroy = _matchDetector.FindMatchesAfterSwap(_gameBoard, lhs, rhs);
+
+        // The player can't see the final state of the cells that are still moving, so they can't be part of the switch
+        bool isAvailable = !IsCellInMotion(lhs) && !IsCellInMotion(rhs)
+            && std::none_of(cellsToDestroy.DestroyedCells.begin(), cellsToDestroy.DestroyedCells.end(), [this](Vec2 cell) { return IsCellInMotion(cell); })
+            && (_maxSwitchesPerFrame == 0 || _switchCountThisFrame < _maxSwitchesPerFrame);
+
+        if (isAvailable && !cellsToDestroy.DestroyedCells.empty()) {
+            // A move that is still playing ends here, the undo history can only hold one at a time
+            EndMove();
+
+            ++_switchCountThisFrame;
+            CellsSwitched.Invoke(lhs, rhs);
+            _undoHistory.BeginMove(_boardGenerator.GetRandomGenerator(), *_gameState);
+            _undoHistory.RecordCell(_gameBoard, lhs);
+            _undoHistory.RecordCell(_gameBoard, rhs);
+            _boardHash = _zobristKeys.HashAfterSwap(_boardHash, _gameBoard, lhs, rhs);
+
+            // The dragged cell stops being active once it's switched
+            _gameBoard.State(lhs) = CellState::Normal;
+            _gameBoard.State(rhs) = CellState::Normal;
+            auto track = MakeTrack();
+
+            _gameBoard.SwapCells(lhs, rhs);
+            assert(_boardHash == _zobristKeys.Hash(_gameBoard));
+
+            // Moves made on top of a cascade that is still playing are worth less time in QuickDeath
+            const auto& tracks = _timeline.Tracks;
+            _gameState->SetIsOverlappingMove(std::any_of(tracks.begin(), tracks.end(), [](const AnimationTrack& other) { return other.IsMove; }));
+            track.IsMove = true;
+
+            std::array moveData {
+                CellAnimationMoveData { lhs, rhs, _gameBoard.Type(rhs), isDraggedCellTheSource ? _activeCellState->Index * TileSize + _activeCellState->Offset : std::optional<Vec2>() },
+                CellAnimationMoveData { rhs, lhs, _gameBoard.Type(lhs), std::nullopt },
+            };
+            QueueMoveAnimation(track, moveData, CellSwitchAnimationDurationMs);
+            ResolveCascade(track, std::move(cellsToDestroy));
+            AddTrack(track);
 
             return true;
         } else if (_activeCellState) { // Just move back the moved cell to its original position
             // This will only be invoked if we are dragging a cell, otherwise activeCellState is already reset
             auto activeIndex = _activeCellState->Index;
-            MoveCellsAnimated({ CellAnimationMoveData { Vec2 {},
-                                  activeIndex,
-                                  At(activeIndex).Type,
-                                  activeIndex * TileSize + _activeCellState->Offset } },
-                CellSwitchAnimationDurationMs, nullptr);
+            _gameBoard.State(activeIndex) = CellState::Normal;
+
+            auto track = MakeTrack();
+            CellAnimationMoveData moveData { Vec2 {}, activeIndex, _gameBoard.Type(activeIndex), activeIndex * TileSize + _activeCellState->Offset };
+            QueueMoveAnimation(track, { &moveData, 1 }, CellSwitchAnimationDurationMs);
+            AddTrack(track);
+
             TileDragCompleted.Invoke(activeIndex);
         }
     }
@@ -302,205 +365,533 @@ bool GameWorld::TrySwitchCells(Vec2 lhs, Vec2 rhs, bool isDraggedCellTheSource)
     return false;
 }
 
+void GameWorld::SetMaxSwitchesPerFrame(int maxSwitchesPerFrame)
+{
+    _maxSwitchesPerFrame = maxSwitchesPerFrame;
+}
+
+bool GameWorld::SkipAnimations()
+{
+    if (!_isActive || _timeline.Tracks.empty()) {
+        return false;
+    }
+
+    ClearTracks();
+    EndMove();
+    AnimationsSkipped.Invoke();
+
+    return true;
+}
+
 std::optional<Vec2> GameWorld::GetTileIndicesAtPoint(Vec2 position)
 {
     Vec2 possibleResult = position / TileSize;
-    if (possibleResult.x >= 0 && possibleResult.x < RowCount && possibleResult.y >= 0 && possibleResult.y < ColCount) {
+    if (IsIndexOnTheBoard(possibleResult)) {
         return possibleResult;
     }
 
     return std::nullopt;
 }
 
-Cell& GameWorld::At(Vec2 indices)
+Vec2 GameWorld::GetCellCenter(Vec2 index) const
 {
-    assert(indices.x >= 0 && indices.x < ColCount);
-    assert(indices.y >= 0 && indices.y < RowCount);
+    return index * TileSize + Vec2 { TileSize / 2, TileSize / 2 };
+}
 
-    return _gameBoard[indices.x][indices.y];
+uint64_t GameWorld::GetGameSeed() const
+{
+    return _gameSeed;
 }
 
-const Cell& GameWorld::At(Vec2 indices) const
+GameMode GameWorld::GetGameMode() const
 {
-    assert(indices.x >= 0 && indices.x < ColCount);
-    assert(indices.y >= 0 && indices.y < RowCount);
+    assert(_gameState);
+    return _gameState->GetGameMode();
+}
 
-    return _gameBoard[indices.x][indices.y];
+const Board& GameWorld::GetBoard() const
+{
+    return _gameBoard;
 }
 
-CellDestructionData GameWorld::GetCellsToDestroyFromCurrentState() const
+std::vector<LegalMove> GameWorld::GetLegalMoves() const
 {
-    std::vector<Vec2> cellsToRemove;
+    return MoveFinder::FindLegalMoves(_gameBoard, _matchDetector);
+}
 
-    int maxColStreak = 0;
-    // Check the columns for at least 3 of the same cells next to each other
-    for (int i = 0; i < ColCount; ++i) {
-        int j = 0;
-        while (j < RowCount - 2) {
-            int k = j + 1;
+std::vector<LegalMove> GameWorld::GetAvailableMoves() const
+{
+    if (_maxSwitchesPerFrame > 0 && _switchCountThisFrame >= _maxSwitchesPerFrame) {
+        return {};
+    }
 
-            // Keep going until we find a cell that is different from the current one
-            while (k < RowCount && _gameBoard[i][j].Type == _gameBoard[i][k].Type) {
-                ++k;
-            }
+    auto legalMoves = GetLegalMoves();
+    if (_timeline.Tracks.empty()) {
+        return legalMoves;
+    }
 
-            // Check if we have at least 3 of the same cell types next to each other
-            if (k - j > 2) {
-                maxColStreak = std::max(maxColStreak, k - j);
+    std::erase_if(legalMoves, [this](const LegalMove& move) {
+        const auto& destroyedCells = move.Destruction.DestroyedCells;
+        return IsCellInMotion(move.Source) || IsCellInMotion(move.Destination)
+            || std::any_of(destroyedCells.begin(), destroyedCells.end(), [this](Vec2 cell) { return IsCellInMotion(cell); });
+    });
 
-                for (int copyInd = j; copyInd < k; ++copyInd) {
-                    cellsToRemove.push_back(Vec2 { i, copyInd });
-                }
-            }
+    return legalMoves;
+}
 
-            j = k;
-        }
+uint64_t GameWorld::GetBoardHash() const
+{
+    return _boardHash;
+}
+
+bool GameWorld::Undo()
+{
+    if (!IsInteractionEnabled() || !IsSettled() || _activeCellState || !_undoHistory.CanUndo()) {
+        return false;
     }
 
-    int maxRowStreak = 0;
-    // Exact same logic for the rows as well
-    for (int j = 0; j < RowCount; ++j) {
-        int i = 0;
-        while (i < ColCount - 2) {
-            int k = i + 1;
+    ApplyUndoChanges(_undoHistory.Undo(_gameBoard, _boardGenerator, *_gameState));
+    return true;
+}
 
-            while (k < ColCount && _gameBoard[i][j].Type == _gameBoard[k][j].Type) {
-                ++k;
-            }
+bool GameWorld::Redo()
+{
+    if (!IsInteractionEnabled() || !IsSettled() || _activeCellState || !_undoHistory.CanRedo()) {
+        return false;
+    }
 
-            if (k - i > 2) {
-                maxRowStreak = std::max(maxRowStreak, k - i);
+    ApplyUndoChanges(_undoHistory.Redo(_gameBoard, _boardGenerator, *_gameState));
+    return true;
+}
 
-                for (int copyInd = i; copyInd < k; ++copyInd) {
-                    cellsToRemove.push_back(Vec2 { copyInd, j });
-                }
-            }
+SaveState GameWorld::CreateSaveState() const
+{
+    assert(_gameState);
+
+    SaveState saveState;
+    saveState.Mode = _gameState->GetGameMode();
+    saveState.ColCount = ColCount;
+    saveState.RowCount = RowCount;
+    saveState.TileKindCount = TileKindCount;
+    saveState.CascadeDepth = _cascadeDepth;
+    saveState.GameSeed = _gameSeed;
+    saveState.RandomState = _boardGenerator.GetRandomGenerator().GetState();
+    saveState.Values = _gameState->GetValues();
+    // The board is already at the end of the cascade that is playing, only its animations are lost
+    saveState.PackBoard(_gameBoard);
+
+    return saveState;
+}
 
-            i = k;
-        }
+bool GameWorld::RestoreSaveState(const SaveState& saveState, IGameState& gameState)
+{
+    if (saveState.ColCount != ColCount || saveState.RowCount != RowCount || saveState.TileKindCount != TileKindCount
+        || saveState.TileKindCount > SaveState::MaxTileKindCount || saveState.Mode != gameState.GetGameMode()) {
+        return false;
+    }
+    if (!saveState.UnpackBoard(_gameBoard)) {
+        return false;
     }
 
-    if (!cellsToRemove.empty()) {
-        std::sort(cellsToRemove.begin(), cellsToRemove.end(), std::greater<Vec2>());
-        cellsToRemove.erase(std::unique(cellsToRemove.begin(), cellsToRemove.end()), cellsToRemove.end());
+    _isActive = false;
+    _gameState = &gameState;
+    _gameState->SetValues(saveState.Values);
+    _gameSeed = saveState.GameSeed;
+
+    RandomGenerator randomGenerator;
+    randomGenerator.SetState(saveState.RandomState);
+    _boardGenerator.SetRandomGenerator(randomGenerator);
+
+    ClearTracks();
+    _activeCellState.reset();
+    _cascadeDepth = saveState.CascadeDepth;
+    _switchCountThisFrame = 0;
+    _undoHistory.Clear();
+    ResetHint();
+    _boardHash = _zobristKeys.Hash(_gameBoard);
+
+    // Saves of older versions can stop in the middle of a cascade, so continue it from the step that was playing.
+    // The rest of the board had no matches, so looking at the whole board finds the same cells as the incremental checks did.
+    bool hasDestroyedCells = std::find(_gameBoard.StateData(), _gameBoard.StateData() + _gameBoard.GetCellCount(), CellState::Destroyed)
+        != _gameBoard.StateData() + _gameBoard.GetCellCount();
+    auto track = MakeTrack();
+    track.IsMove = true;
+    _gameState->SetIsOverlappingMove(false);
+    if (hasDestroyedCells) {
+        MoveDownCells(track);
+        ResolveCascade(track, _matchDetector.FindMatchesAfterFall(_gameBoard, _gravityResult.LowestChangedRows));
+    } else if (auto cellsToDestroy = _matchDetector.FindMatches(_gameBoard); !cellsToDestroy.DestroyedCells.empty()) {
+        ResolveCascade(track, std::move(cellsToDestroy));
     }
+    AddTrack(track);
 
-    return CellDestructionData(std::move(cellsToRemove), maxRowStreak, maxColStreak);
+    return true;
 }
 
-void GameWorld::UpdateBoardState(CellDestructionData&& cellDestructionData)
+void GameWorld::SaveSnapshot(Snapshot& snapshot) const
 {
-    const auto& cellsToRemove = cellDestructionData.DestroyedCells;
-    if (!cellsToRemove.empty()) {
-        for (auto& cell : cellsToRemove) {
-            At(cell).Destroy();
-        }
+    assert(_gameState);
+
+    snapshot.Types.assign(_gameBoard.TypeData(), _gameBoard.TypeData() + _gameBoard.GetCellCount());
+    snapshot.States.assign(_gameBoard.StateData(), _gameBoard.StateData() + _gameBoard.GetCellCount());
+    snapshot.BoardHash = _boardHash;
+    snapshot.RandomState = _boardGenerator.GetRandomGenerator().GetState();
+    snapshot.IsActive = _isActive;
+    CopyTimeline(snapshot.Timeline, _timeline);
+    snapshot.ActiveCell = _activeCellState;
+    snapshot.Hint = _hint;
+    snapshot.IdleTimeMs = _idleTimeMs;
+    snapshot.CascadeDepth = _cascadeDepth;
+    snapshot.SwitchCountThisFrame = _switchCountThisFrame;
+    snapshot.Values = _gameState->GetValues();
+}
+
+void GameWorld::CopyTimeline(AnimationTimeline& to, const AnimationTimeline& from)
+{
+    AssignKeepingCapacity(to.Tracks, from.Tracks);
+    AssignKeepingCapacity(to.Steps, from.Steps);
+    AssignKeepingCapacity(to.CellAnimations, from.CellAnimations);
+    AssignKeepingCapacity(to.BoardTypes, from.BoardTypes);
+    AssignKeepingCapacity(to.BoardStates, from.BoardStates);
+    AssignKeepingCapacity(to.CellWords, from.CellWords);
+}
 
-        _gameState->UpdateScore(cellDestructionData);
+void GameWorld::RestoreSnapshot(const Snapshot& snapshot)
+{
+    assert(_gameState);
+    assert(snapshot.Types.size() == size_t(_gameBoard.GetCellCount()));
+
+    std::copy(snapshot.Types.begin(), snapshot.Types.end(), _gameBoard.TypeData());
+    std::copy(snapshot.States.begin(), snapshot.States.end(), _gameBoard.StateData());
+    _boardHash = snapshot.BoardHash;
+
+    RandomGenerator randomGenerator;
+    randomGenerator.SetState(snapshot.RandomState);
+    _boardGenerator.SetRandomGenerator(randomGenerator);
+
+    _isActive = snapshot.IsActive;
+    CopyTimeline(_timeline, snapshot.Timeline);
+    _activeCellState = snapshot.ActiveCell;
+    _hint = snapshot.Hint;
+    _idleTimeMs = snapshot.IdleTimeMs;
+    _cascadeDepth = snapshot.CascadeDepth;
+    _switchCountThisFrame = snapshot.SwitchCountThisFrame;
+    _gameState->SetValues(snapshot.Values);
+    _undoHistory.Clear();
+}
 
-        DestroyCellsAnimated(std::move(cellDestructionData.DestroyedCells), CellDestroyAnimationDurationMs, [this]() { MoveDownCells(); });
+void GameWorld::ApplyUndoChanges(std::span<const CellChange> changes)
+{
+    for (const auto& [index, oldType, newType] : changes) {
+        _boardHash ^= _zobristKeys.GetKey(index, oldType) ^ _zobristKeys.GetKey(index, newType);
     }
+    assert(_boardHash == _zobristKeys.Hash(_gameBoard));
+
+    // The hint was for the board before
+    ResetHint();
 }
 
-void GameWorld::UpdateBoardState()
+void GameWorld::UpdateHint(uint64_t deltaTimeMs)
 {
-    auto cellsToRemove = GetCellsToDestroyFromCurrentState();
+    // Any interaction or animation means the player is not stuck, so start counting again
+    if (!IsInteractionEnabled() || !IsSettled() || _activeCellState) {
+        ResetHint();
+        return;
+    }
+
+    _idleTimeMs += deltaTimeMs;
+
+    if (_idleTimeMs >= HintDelayMs && !_hint) {
+        auto legalMoves = GetLegalMoves();
+        auto bestMove = std::max_element(legalMoves.begin(), legalMoves.end(), [](const LegalMove& lhs, const LegalMove& rhs) {
+            return lhs.Destruction.DestroyedCells.size() < rhs.Destruction.DestroyedCells.size();
+        });
+
+        if (bestMove != legalMoves.end()) {
+            _hint = HintState { bestMove->Source, bestMove->Destination };
+        }
+    }
+}
 
-    UpdateBoardState(std::move(cellsToRemove));
+void GameWorld::ResetHint()
+{
+    _hint.reset();
+    _idleTimeMs = 0;
 }
 
-void GameWorld::MoveCellsAnimated(
-    std::vector<CellAnimationMoveData>&& moveData,
-    double animationDuration,
-    std::function<void()> completion,
-    EasingFunction easingFun)
+void GameWorld::ResolveCascade(AnimationTrack& track, CellDestructionData&& cellsToDestroy)
 {
-    assert(!_animationState);
-    _animationState.emplace();
+    while (!cellsToDestroy.DestroyedCells.empty()) {
+        const auto& cellsToRemove = cellsToDestroy.DestroyedCells;
+        _boardHash = _zobristKeys.HashAfterDestruction(_boardHash, _gameBoard, cellsToRemove);
+        for (auto& cell : cellsToRemove) {
+            _gameBoard.State(cell) = CellState::Destroyed;
+            // Everything above a destroyed cell falls down
+            _undoHistory.RecordColumnTop(_gameBoard, cell.x, cell.y);
+        }
+        assert(_boardHash == _zobristKeys.Hash(_gameBoard));
+
+        _gameState->UpdateScore(cellsToDestroy);
+        ++_cascadeDepth;
 
-    for (auto& animationData : moveData) {
-        auto& finalCell = At(animationData.FinalPosition);
-        finalCell.State = Cell::CellState::WaitingForAnimationToComplete;
-        finalCell.Type = animationData.CellType;
+        QueueDestroyAnimation(track, cellsToRemove);
+        MoveDownCells(track);
 
-        animationData.FinalPosition = animationData.FinalPosition * TileSize;
-        animationData.StartingPosition = animationData.StartPositionOverride.value_or(animationData.StartingPosition) * TileSize;
+        // Only the columns that had destroyed cells have changed, no need to check the whole board again
+        cellsToDestroy = _matchDetector.FindMatchesAfterFall(_gameBoard, _gravityResult.LowestChangedRows);
     }
 
-    _animationState->AnimationData = std::move(moveData);
+    // The cascade has settled, make sure that the player can still make a move
+    CascadeCompleted.Invoke(_cascadeDepth);
+    _cascadeDepth = 0;
 
-    _animationState->AnimationDuration = animationDuration;
-    _animationState->Completion = std::move(completion);
-    _animationState->EasingFun = easingFun;
+    ShuffleIfNoLegalMoves(track);
 }
 
-void GameWorld::DestroyCellsAnimated(std::vector<Vec2>&& cellsToDestroy, double animationTime, std::function<void()> completion)
+void GameWorld::EndMove()
 {
-    _animationState.emplace();
+    // The move only ends once its animations have played, so undoing the next one gives back the time they took
+    _undoHistory.EndMove(_gameBoard, _boardGenerator.GetRandomGenerator(), *_gameState);
+}
 
-    std::vector<CellAnimationDestructionData> animationData;
-    animationData.reserve(cellsToDestroy.size());
+void GameWorld::ShuffleIfNoLegalMoves(AnimationTrack& track)
+{
+    if (MoveFinder::CountLegalMoves(_gameBoard, 1) > 0) {
+        return;
+    }
 
-    for (Vec2 cell : cellsToDestroy) {
-        animationData.push_back(CellAnimationDestructionData { cell, At(cell).Type });
+    _undoHistory.RecordBoard(_gameBoard);
+    if (_boardGenerator.Shuffle(_gameBoard, MinLegalMovesAfterShuffle)) {
+        _boardHash = _zobristKeys.Hash(_gameBoard);
+    } else {
+        // The tiles on the board can't be rearranged into a playable state, so just get new ones
+        FillBoard();
     }
 
-    _animationState->AnimationData = std::move(animationData);
+    // Let the new board fall in from the top, so the player can see that the tiles have changed
+    _cellMoveData.clear();
+    for (int i = 0; i < ColCount; ++i) {
+        auto types = _gameBoard.ColumnTypes(i);
+        for (int j = 0; j < RowCount; ++j) {
+            _cellMoveData.push_back(CellAnimationMoveData { Vec2 { i, j - RowCount }, Vec2 { i, j }, types[j], std::nullopt });
+        }
+    }
 
-    _animationState->AnimationDuration = CellDestroyAnimationDurationMs;
-    _animationState->Completion = std::move(completion);
-    _animationState->FinalCellState = Cell::CellState::Destroyed;
-    _animationState->EffectToPlay = AudioPlayer::SoundEffect::TileDisappear;
+    QueueMoveAnimation(track, _cellMoveData, BaseCellFallAnimationDurationMs, EasingFunction::EaseOutBounce);
 }
 
-void GameWorld::MoveDownCells()
+GameWorld::AnimationTrack GameWorld::MakeTrack()
 {
-    std::vector<CellAnimationMoveData> cellMoveData;
+    assert(_timeline.CellWords.size() == _timeline.Tracks.size() * size_t(_wordsPerTrack));
 
-    // Update the position of every cell that is above a destroyed cell and add them to be animated
-    for (int i = 0; i < ColCount; ++i) {
-        int destroyedCellCount = 0;
+    AnimationTrack track;
+    track.FirstStep = int(_timeline.Steps.size());
+    track.EndStep = track.FirstStep;
+    track.BoardBefore = AddTimelineBoard();
+    _timeline.CellWords.resize(_timeline.CellWords.size() + size_t(_wordsPerTrack), 0);
 
-        for (int j = RowCount - 1; j >= 0; --j) {
-            if (_gameBoard[i][j].State == Cell::CellState::Destroyed) {
-                ++destroyedCellCount;
-            } else if (destroyedCellCount > 0) {
-                int newRow = j + destroyedCellCount;
+    return track;
+}
 
-                auto startPosition = Vec2 { i, j };
-                auto finalPosition = Vec2 { i, newRow };
+void GameWorld::AddTrack(const AnimationTrack& track)
+{
+    if (track.FirstStep == track.EndStep) {
+        // Nothing to play, so the data that was put aside for it goes as well
+        _timeline.BoardTypes.resize(size_t(track.BoardBefore) * size_t(_gameBoard.GetCellCount()));
+        _timeline.BoardStates.resize(_timeline.BoardTypes.size());
+        _timeline.CellWords.resize(_timeline.Tracks.size() * size_t(_wordsPerTrack));
+        return;
+    }
 
-                cellMoveData.push_back(CellAnimationMoveData { startPosition, finalPosition, At(startPosition).Type });
+    _timeline.Tracks.push_back(track);
+    _timeline.Tracks.back().IsPlaying = !IsSharingCellsWithEarlierTrack(_timeline.Tracks.size() - 1);
+}
+
+void GameWorld::ClearTracks()
+{
+    _timeline.Tracks.clear();
+    _timeline.Steps.clear();
+    _timeline.CellAnimations.clear();
+    _timeline.BoardTypes.clear();
+    _timeline.BoardStates.clear();
+    _timeline.CellWords.clear();
+}
+
+void GameWorld::RemoveFinishedTracks()
+{
+    // Everything only moves towards the front, the data of every track comes after the data of the ones before it
+    auto cellCount = size_t(_gameBoard.GetCellCount());
+    auto wordsPerTrack = size_t(_wordsPerTrack);
+    auto moveBoard = [this, cellCount](int from, int to) {
+        std::copy_n(_timeline.BoardTypes.begin() + std::ptrdiff_t(from * cellCount), cellCount, _timeline.BoardTypes.begin() + std::ptrdiff_t(to * cellCount));
+        std::copy_n(_timeline.BoardStates.begin() + std::ptrdiff_t(from * cellCount), cellCount, _timeline.BoardStates.begin() + std::ptrdiff_t(to * cellCount));
+    };
+
+    size_t trackCount = 0;
+    int stepCount = 0;
+    int cellAnimationCount = 0;
+    int boardCount = 0;
+
+    for (size_t i = 0; i < _timeline.Tracks.size(); ++i) {
+        auto track = _timeline.Tracks[i];
+        if (track.FirstStep == track.EndStep) {
+            continue;
+        }
+
+        std::copy_n(_timeline.CellWords.begin() + std::ptrdiff_t(i * wordsPerTrack), wordsPerTrack, _timeline.CellWords.begin() + std::ptrdiff_t(trackCount * wordsPerTrack));
+        moveBoard(track.BoardBefore, boardCount);
+        track.BoardBefore = boardCount++;
+
+        int firstStep = stepCount;
+        for (int j = track.FirstStep; j < track.EndStep; ++j) {
+            auto step = _timeline.Steps[size_t(j)];
+            std::copy(_timeline.CellAnimations.begin() + step.FirstCell, _timeline.CellAnimations.begin() + step.EndCell, _timeline.CellAnimations.begin() + cellAnimationCount);
+            step.EndCell = cellAnimationCount + (step.EndCell - step.FirstCell);
+            step.FirstCell = cellAnimationCount;
+            cellAnimationCount = step.EndCell;
+            moveBoard(step.ShownBoard, boardCount);
+            step.ShownBoard = boardCount++;
+            _timeline.Steps[size_t(stepCount++)] = step;
+        }
+        track.FirstStep = firstStep;
+        track.EndStep = stepCount;
+
+        _timeline.Tracks[trackCount++] = track;
+    }
+
+    _timeline.Tracks.resize(trackCount);
+    _timeline.Steps.resize(size_t(stepCount));
+    _timeline.CellAnimations.resize(size_t(cellAnimationCount));
+    _timeline.BoardTypes.resize(size_t(boardCount) * cellCount);
+    _timeline.BoardStates.resize(size_t(boardCount) * cellCount);
+    _timeline.CellWords.resize(trackCount * wordsPerTrack);
+}
 
-                At(startPosition).State = Cell::CellState::Destroyed;
+bool GameWorld::IsSharingCellsWithEarlierTrack(size_t trackIndex) const
+{
+    auto wordsPerTrack = size_t(_wordsPerTrack);
+    const auto* cells = &_timeline.CellWords[trackIndex * wordsPerTrack];
+    for (size_t i = 0; i < trackIndex; ++i) {
+        const auto* otherCells = &_timeline.CellWords[i * wordsPerTrack];
+        for (size_t j = 0; j < wordsPerTrack; ++j) {
+            if ((cells[j] & otherCells[j]) != 0) {
+                return true;
             }
         }
+    }
+
+    return false;
+}
 
-        // Fill the board again by generating destroyedCellCount number of new cells and animate them in from the top
-        for (int cellInd = 0; cellInd < destroyedCellCount; ++cellInd) {
-            auto finalPosition = Vec2 { i, cellInd };
-            auto startPosition = Vec2 { i, cellInd - destroyedCellCount };
-            auto newCellType = GetRandomNumber();
+bool GameWorld::IsTrackCell(size_t trackIndex, Vec2 index) const
+{
+    auto bit = size_t(index.x * RowCount + index.y);
+    return (_timeline.CellWords[trackIndex * size_t(_wordsPerTrack) + bit / CellMask::BitsPerWord] >> (bit % CellMask::BitsPerWord) & 1) != 0;
+}
+
+void GameWorld::SetTrackCell(size_t trackIndex, Vec2 index)
+{
+    auto bit = size_t(index.x * RowCount + index.y);
+    _timeline.CellWords[trackIndex * size_t(_wordsPerTrack) + bit / CellMask::BitsPerWord] |= uint64_t(1) << (bit % CellMask::BitsPerWord);
+}
 
-            cellMoveData.push_back(CellAnimationMoveData { startPosition, finalPosition, newCellType });
+int GameWorld::AddTimelineBoard()
+{
+    auto cellCount = size_t(_gameBoard.GetCellCount());
+    int board = int(_timeline.BoardTypes.size() / cellCount);
+    _timeline.BoardTypes.insert(_timeline.BoardTypes.end(), _gameBoard.TypeData(), _gameBoard.TypeData() + cellCount);
+    _timeline.BoardStates.insert(_timeline.BoardStates.end(), _gameBoard.StateData(), _gameBoard.StateData() + cellCount);
+
+    return board;
+}
+
+std::pair<const uint8_t*, const CellState*> GameWorld::GetShownBoard(Vec2 index) const
+{
+    // The earliest track with the cell decides how it looks, the later ones haven't got to it yet
+    for (size_t i = 0; i < _timeline.Tracks.size(); ++i) {
+        if (IsTrackCell(i, index)) {
+            const auto& track = _timeline.Tracks[i];
+            auto offset = size_t(track.IsPlaying ? _timeline.Steps[size_t(track.FirstStep)].ShownBoard : track.BoardBefore) * size_t(_gameBoard.GetCellCount());
+            return { &_timeline.BoardTypes[offset], &_timeline.BoardStates[offset] };
         }
     }
 
-    MoveCellsAnimated(
-        std::move(cellMoveData),
-        BaseCellFallAnimationDurationMs,
-        [this]() { UpdateBoardState(); },
-        EasingFunction::EaseOutBounce);
+    return { _gameBoard.TypeData(), _gameBoard.StateData() };
 }
 
-bool GameWorld::IsIndexOnTheBoard(Vec2 index) const
+void GameWorld::QueueMoveAnimation(AnimationTrack& track, std::span<const CellAnimationMoveData> moveData, double animationDuration, EasingFunction easingFun)
 {
-    return !(index.x < 0 || index.x > ColCount - 1 || index.y < 0 || index.y > RowCount - 1);
+    // The track that is being made comes after the last one
+    auto trackIndex = _timeline.Tracks.size();
+    AnimationState animationState;
+    animationState.Kind = AnimationKind::Move;
+    animationState.FirstCell = int(_timeline.CellAnimations.size());
+    animationState.ShownBoard = AddTimelineBoard();
+    auto* boardStates = &_timeline.BoardStates[size_t(animationState.ShownBoard) * size_t(_gameBoard.GetCellCount())];
+
+    for (const auto& animationData : moveData) {
+        boardStates[animationData.FinalPosition.x * RowCount + animationData.FinalPosition.y] = CellState::WaitingForAnimationToComplete;
+        SetTrackCell(trackIndex, animationData.FinalPosition);
+        if (!animationData.StartPositionOverride && IsIndexOnTheBoard(animationData.StartingPosition)) {
+            SetTrackCell(trackIndex, animationData.StartingPosition);
+        }
+
+        // The override already is where the dragged cell is drawn
+        _timeline.CellAnimations.push_back(CellAnimation {
+            animationData.StartPositionOverride.value_or(animationData.StartingPosition * TileSize),
+            animationData.FinalPosition * TileSize,
+            animationData.CellType });
+    }
+
+    animationState.EndCell = int(_timeline.CellAnimations.size());
+    animationState.AnimationDuration = animationDuration;
+    animationState.EasingFun = easingFun;
+
+    _timeline.Steps.push_back(animationState);
+    track.EndStep = int(_timeline.Steps.size());
 }
 
-CellDestructionData::CellDestructionData(std::vector<Vec2>&& destroyedCells, int highestRowCombo, int highestColCombo)
-    : DestroyedCells(std::move(destroyedCells))
-    , HighestRowCombo(highestRowCombo)
-    , HighestColumnCombo(highestColCombo)
+void GameWorld::QueueDestroyAnimation(AnimationTrack& track, const std::vector<Vec2>& destroyedCells)
+{
+    // The destroyed cells are already marked on the board, so they aren't drawn under the animation
+    auto trackIndex = _timeline.Tracks.size();
+    AnimationState animationState;
+    animationState.Kind = AnimationKind::Destruction;
+    animationState.FirstCell = int(_timeline.CellAnimations.size());
+    animationState.ShownBoard = AddTimelineBoard();
+
+    for (Vec2 cell : destroyedCells) {
+        _timeline.CellAnimations.push_back(CellAnimation { cell * TileSize, cell * TileSize, _gameBoard.Type(cell) });
+        SetTrackCell(trackIndex, cell);
+    }
+
+    animationState.EndCell = int(_timeline.CellAnimations.size());
+    animationState.AnimationDuration = CellDestroyAnimationDurationMs;
+    animationState.EffectToPlay = IAudioSink::SoundEffect::TileDisappear;
+
+    _timeline.Steps.push_back(animationState);
+    track.EndStep = int(_timeline.Steps.size());
+}
+
+void GameWorld::MoveDownCells(AnimationTrack& track)
+{
+    // Update the position of every cell that is above a destroyed cell and fill the board again from the top
+    CascadeResolver::ApplyGravity(_gameBoard, _boardGenerator, _gravityResult);
+    _boardHash = _zobristKeys.HashAfterGravity(_boardHash, _gameBoard, _gravityResult);
+    assert(_boardHash == _zobristKeys.Hash(_gameBoard));
+
+    _cellMoveData.clear();
+    for (const auto& [from, to] : _gravityResult.GetMoves()) {
+        _cellMoveData.push_back(CellAnimationMoveData { from, to, _gameBoard.Type(to), std::nullopt });
+    }
+    for (const auto& [from, to, type] : _gravityResult.GetSpawnedTiles()) {
+        _cellMoveData.push_back(CellAnimationMoveData { from, to, type, std::nullopt });
+    }
+
+    QueueMoveAnimation(track, _cellMoveData, BaseCellFallAnimationDurationMs, EasingFunction::EaseOutBounce);
+}
+
+bool GameWorld::IsIndexOnTheBoard(Vec2 index) const
 {
+    return _gameBoard.IsIndexOnTheBoard(index);
 }
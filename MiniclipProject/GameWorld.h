@@ -1,63 +1,99 @@
 #pragma once
 
-#include "AudioPlayer.h"
+#include "Board.h"
+#include "BoardGenerator.h"
+#include "CascadeResolver.h"
+#include "CellMask.h"
 #include "Event.h"
 #include "GameState.h"
-#include "Screen.h"
+#include "IAudioSink.h"
+#include "IRenderer.h"
+#include "MatchDetector.h"
+#include "MoveFinder.h"
+#include "RandomGenerator.h"
+#include "SaveState.h"
+#include "UndoHistory.h"
 #include "Vec2.h"
+#include "ZobristKeys.h"
 
 #include <array>
 #include <optional>
-#include <random>
-#include <variant>
+#include <span>
+#include <utility>
 #include <vector>
 
-struct Cell {
-    enum class CellState {
-        Destroyed,
-        Normal,
-        Active,
-        WaitingForAnimationToComplete,
-    };
-
-    Cell(int cellTypeId);
-
-    void Destroy();
-
-    int Type = -1;
-    CellState State = CellState::Normal;
-};
-
-struct CellDestructionData {
-    CellDestructionData(std::vector<Vec2>&& destroyedCells, int highestRowCombo, int highestColCombo);
-
-    std::vector<Vec2> DestroyedCells;
-    int HighestRowCombo;
-    int HighestColumnCombo;
-};
-
 class GameWorld {
 public:
-    using GameBoard = std::vector<std::vector<Cell>>;
-
     const int RowCount, ColCount, TileKindCount;
 
     Event<std::function<void(Vec2 source)>> TileDragCompleted;
+    // Invoked for every switch that was accepted, before its animation starts
+    Event<std::function<void(Vec2 source, Vec2 destination)>> CellsSwitched;
+    // Invoked when the cascade of a switch has been resolved, with the number of times cells were destroyed.
+    // The whole cascade is resolved when the switch is accepted, its animations play after that.
+    Event<std::function<void(int cascadeDepth)>> CascadeCompleted;
+    // Invoked when the animations that were playing have been skipped
+    Event<std::function<void()>> AnimationsSkipped;
 
-    GameWorld(int rowCount, int colCount, int tileKindCount, Screen& screen, AudioPlayer& audioPlayer);
+    GameWorld(int rowCount, int colCount, int tileKindCount, IRenderer& renderer, IAudioSink& audioSink, uint64_t seed);
 
-    void Activate(IGameState& gameState);
+    // Starts a new board if the game state has changed. Without a seed, the next one is taken from the seed the world was created with
+    void Activate(IGameState& gameState, std::optional<uint64_t> gameSeed = std::nullopt);
     void Deactivate();
 
     void Draw();
     void Update(uint64_t deltaTimeMs);
+    // The board takes input whenever it's active. Only the cells that are still moving are locked, see IsCellInMotion.
     bool IsInteractionEnabled() const;
+    // Nothing is moving on the board
+    bool IsSettled() const;
+    // The cell is animated, or waiting for an animation to get to it, so it can't be selected, switched or destroyed
+    bool IsCellInMotion(Vec2 index) const;
 
     void SetActiveCell(std::optional<Vec2> index, Vec2 offset = Vec2 { 0, 0 });
 
     bool TrySwitchCells(Vec2 source, Vec2 destination, bool isDraggedCellTheSource = false);
+    // Switches after this many are turned away until the next Update, 0 is no limit. Versus only sends one switch a frame.
+    void SetMaxSwitchesPerFrame(int maxSwitchesPerFrame);
+    // Drops the animations that are still to play. The board already is the one they end with, so this is all it takes.
+    // Returns false if nothing was playing.
+    bool SkipAnimations();
 
     std::optional<Vec2> GetTileIndicesAtPoint(Vec2 position);
+    // The point on the screen in the middle of the cell
+    Vec2 GetCellCenter(Vec2 index) const;
+    bool IsIndexOnTheBoard(Vec2 index) const;
+    uint64_t GetGameSeed() const;
+    // The mode of the game state the world was last activated with
+    GameMode GetGameMode() const;
+    const Board& GetBoard() const;
+
+    // Lists every swap that would destroy cells on the current board, without changing anything
+    std::vector<LegalMove> GetLegalMoves() const;
+    // The legal moves that can be made right now, the ones that don't touch any cell in motion
+    std::vector<LegalMove> GetAvailableMoves() const;
+    // The Zobrist hash of the tiles on the board, kept up to date after every switch, destruction and refill
+    uint64_t GetBoardHash() const;
+
+    // Takes back (or plays again) the last move, including the score, the time and the tiles that fell in.
+    // Only possible while the board is settled and waiting for input, returns false otherwise or if there is nothing to undo.
+    bool Undo();
+    bool Redo();
+
+    // Everything needed to continue the game after a restart, including a cascade that is still playing
+    SaveState CreateSaveState() const;
+    // Puts back a saved game instead of starting a new one, the world can then be activated with the same game state.
+    // Returns false if the save doesn't fit this world or the game state is of a different mode.
+    bool RestoreSaveState(const SaveState& saveState, IGameState& gameState);
+
+    // Everything about the world that changes while it's played, so it can be put back exactly (eg. to roll back a
+    // prediction and play the frames again). Everything is copied into buffers the snapshot keeps, and they grow to the
+    // room the world has reserved for its animations, so taking snapshots into the same ones only allocates the first time.
+    struct Snapshot;
+
+    void SaveSnapshot(Snapshot& snapshot) const;
+    // Only for snapshots taken with the current game state. The undo history doesn't survive it.
+    void RestoreSnapshot(const Snapshot& snapshot);
 
 private:
     enum class EasingFunction {
@@ -72,20 +108,55 @@ private:
         std::optional<Vec2> StartPositionOverride;
     };
 
-    struct CellAnimationDestructionData {
-        Vec2 CellIndex;
+    enum class AnimationKind : uint8_t {
+        Move,
+        Destruction,
+    };
+
+    // One cell of a step, in screen coordinates. A destroyed cell starts and ends at the same place.
+    struct CellAnimation {
+        Vec2 StartingPosition;
+        Vec2 FinalPosition;
         int CellType;
     };
 
+    // One step of the timeline. The cells of its track are drawn from the board the step was queued with,
+    // which has the animated cells hidden.
     struct AnimationState {
-        std::variant<std::vector<CellAnimationMoveData>, std::vector<CellAnimationDestructionData>> AnimationData;
-        std::function<void()> Completion;
+        AnimationKind Kind = AnimationKind::Move;
+        int FirstCell = 0; // The cells are [FirstCell, EndCell) of the timeline's CellAnimations
+        int EndCell = 0;
+        int ShownBoard = 0; // In the timeline's boards
         uint64_t AnimationTimePassed = 0;
         double AnimationDuration = 0;
         double AnimationProgress = 0.0;
-        Cell::CellState FinalCellState = Cell::CellState::Normal;
         EasingFunction EasingFun = EasingFunction::EaseInCubic;
-        std::optional<AudioPlayer::SoundEffect> EffectToPlay;
+        std::optional<IAudioSink::SoundEffect> EffectToPlay;
+    };
+
+    // The steps of one move, played one after the other. The track's cells are every cell that the steps show differently from the board.
+    // Tracks that share no cells play at the same time. Otherwise the later one waits and shows BoardBefore until it can start.
+    struct AnimationTrack {
+        int FirstStep = 0; // The step that is playing, the steps are [FirstStep, EndStep) of the timeline's Steps
+        int EndStep = 0;
+        int BoardBefore = 0;
+        bool IsPlaying = false;
+        bool IsMove = false; // Not just a cell going back after a failed drag
+    };
+
+    // Every animation that is still to play. It's kept in flat arrays of plain values, so copying it into one
+    // that has been used before reuses its buffers. The data of the tracks comes in the order of the tracks,
+    // and the data of the track that is being made comes after the last one.
+    struct AnimationTimeline {
+        // In the order the moves were made
+        std::vector<AnimationTrack> Tracks;
+        std::vector<AnimationState> Steps;
+        std::vector<CellAnimation> CellAnimations;
+        // The boards shown by the steps and the tracks, CellCount cells each
+        std::vector<uint8_t> BoardTypes;
+        std::vector<CellState> BoardStates;
+        // A bit for every cell of every track, the cells of a track start at a whole word
+        std::vector<uint64_t> CellWords;
     };
 
     struct ActiveCellState {
@@ -94,43 +165,93 @@ private:
         uint64_t AnimationTimePassed = 0;
     };
 
+    struct HintState {
+        Vec2 Source;
+        Vec2 Destination;
+    };
+
     static constexpr int TileSize = 70; // The provided assets have this size, so for now just use it
     static constexpr int DragOffsetSuccessThreshold = int(TileSize * 0.8);
     static constexpr double CellSwitchAnimationDurationMs = 200.0;
     static constexpr double CellDestroyAnimationDurationMs = 400.0;
     static constexpr double BaseCellFallAnimationDurationMs = 800.0;
+    static constexpr uint64_t HintDelayMs = 5000;
+    static constexpr int MinLegalMovesAfterShuffle = 3;
+    // Enough for several moves with long cascades playing at once. The timeline only grows past this in rare games.
+    static constexpr size_t ReservedTimelineTracks = 16;
+    static constexpr size_t ReservedTimelineSteps = 64;
+    static constexpr size_t ReservedTimelineCellsPerStep = 8; // Times the cell count, the steps of a cascade move a few columns each
 
-    Cell& At(Vec2 indices);
-    const Cell& At(Vec2 indices) const;
-
-    int GetRandomNumber(const std::array<int, 2>& excluding = { -1, -1 });
-    Cell GenerateCellForIndex(int i, int j);
     void FillBoard();
 
-    CellDestructionData GetCellsToDestroyFromCurrentState() const;
-    void UpdateBoardState();
-    void UpdateBoardState(CellDestructionData&& cellsToRemove);
-    void MoveCellsAnimated(
-        std::vector<CellAnimationMoveData>&& moveData,
-        double animationDuration,
-        std::function<void()> completion,
-        EasingFunction easingFun = EasingFunction::EaseInCubic);
-    void DestroyCellsAnimated(std::vector<Vec2>&& cellsToDestroy, double animationTime, std::function<void()> completion);
-    void MoveDownCells();
+    // Destroys the cells and everything that gets destroyed after them, until the board settles.
+    // The score is updated right away, every step is added to the track to be animated later.
+    void ResolveCascade(AnimationTrack& track, CellDestructionData&& cellsToDestroy);
+    // A track that starts from the board as it is now. Its data goes after the last track until it's added.
+    AnimationTrack MakeTrack();
+    void AddTrack(const AnimationTrack& track);
+    void ClearTracks();
+    static void CopyTimeline(AnimationTimeline& to, const AnimationTimeline& from);
+    void UpdateTrack(AnimationTrack& track, uint64_t deltaTimeMs);
+    // Drops the tracks that have played all their steps, and the steps that have been played
+    void RemoveFinishedTracks();
+    bool IsSharingCellsWithEarlierTrack(size_t trackIndex) const;
+    bool IsTrackCell(size_t trackIndex, Vec2 index) const;
+    void SetTrackCell(size_t trackIndex, Vec2 index);
+    // A copy of the board as it is now, returns its index in the timeline
+    int AddTimelineBoard();
+    // The types and states of the board that shows the cell right now, which is only the board itself if no track has the cell
+    std::pair<const uint8_t*, const CellState*> GetShownBoard(Vec2 index) const;
+    // The animations start from the board as it is now, so they have to be queued right after the step they show
+    void QueueMoveAnimation(AnimationTrack& track, std::span<const CellAnimationMoveData> moveData, double animationDuration, EasingFunction easingFun = EasingFunction::EaseInCubic);
+    void QueueDestroyAnimation(AnimationTrack& track, const std::vector<Vec2>& destroyedCells);
+    void MoveDownCells(AnimationTrack& track);
+    void EndMove();
+    void ShuffleIfNoLegalMoves(AnimationTrack& track);
+    void UpdateHint(uint64_t deltaTimeMs);
+    void ResetHint();
+    void ApplyUndoChanges(std::span<const CellChange> changes);
 
-    bool IsIndexOnTheBoard(Vec2 index) const;
-
-    // The board is stored in a column major order. Columns are growing from left to right. Rows are growing from top to bottom.
-    GameBoard _gameBoard;
-    Screen* _screen = nullptr;
+    // Columns are growing from left to right. Rows are growing from top to bottom.
+    Board _gameBoard;
+    MatchDetector _matchDetector;
+    GravityResult _gravityResult;
+    ZobristKeys _zobristKeys;
+    uint64_t _boardHash = 0;
+    UndoHistory _undoHistory;
+    IRenderer* _renderer = nullptr;
     bool _isActive = false;
 
-    std::random_device _randomDevice;
-    std::mt19937 _randomEngine;
-    std::uniform_int_distribution<int> _randomDistribution;
+    BoardGenerator _boardGenerator;
+    RandomGenerator _seedGenerator;
+    uint64_t _gameSeed;
 
-    std::optional<AnimationState> _animationState;
+    AnimationTimeline _timeline;
+    int _wordsPerTrack = 0;
+    // Reused for the cells that fall after every destruction
+    std::vector<CellAnimationMoveData> _cellMoveData;
     std::optional<ActiveCellState> _activeCellState;
-    IGameState* _gameState;
-    AudioPlayer* _audioPlayer;
+    std::optional<HintState> _hint;
+    uint64_t _idleTimeMs = 0;
+    int _cascadeDepth = 0;
+    int _maxSwitchesPerFrame = 0;
+    int _switchCountThisFrame = 0;
+    IGameState* _gameState = nullptr;
+    IAudioSink* _audioSink;
+};
+
+// Defined after the class, as it holds the animation types the world keeps to itself
+struct GameWorld::Snapshot {
+    std::vector<uint8_t> Types;
+    std::vector<CellState> States;
+    uint64_t BoardHash = 0;
+    std::array<uint64_t, 4> RandomState {};
+    bool IsActive = false;
+    AnimationTimeline Timeline;
+    std::optional<ActiveCellState> ActiveCell;
+    std::optional<HintState> Hint;
+    uint64_t IdleTimeMs = 0;
+    int CascadeDepth = 0;
+    int SwitchCountThisFrame = 0;
+    GameStateValues Values;
 };
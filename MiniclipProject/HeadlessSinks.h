@@ -0,0 +1,21 @@
+#pragma once
+
+#include "IAudioSink.h"
+#include "IRenderer.h"
+
+// Used when the game runs without a window or an audio device, eg. in simulations and benchmarks
+
+class NullRenderer : public IRenderer {
+public:
+    int GetScreenWidth() const override { return 0; }
+
+    void DrawCell(Vec2, int, int, int) const override { }
+    void DrawDestroyAnimation(Vec2, int, double) override { }
+    void DrawText(const std::string&, const Rect&, bool) const override { }
+    void DrawBackgroundRectangle(const Rect&, Color) const override { }
+};
+
+class NullAudioSink : public IAudioSink {
+public:
+    void PlaySoundEffect(SoundEffect) override { }
+};
@@ -1,11 +1,15 @@
 #include "HighScore.h"
 
+#include <algorithm>
 #include <exception>
 #include <filesystem>
 #include <fstream>
+#include <sstream>
 
 namespace {
 static const char* const HighScoreFilePath = "./high.score";
+static const char* const ArchivedHighScoreFilePath = "./high.score.v1"; // Where a file without a version line is kept after it's migrated
+static const char* const VersionPrefix = "version ";
 
 std::vector<std::string> Split(const std::string& string, const std::string& delimiter)
 {
@@ -31,7 +35,7 @@ std::vector<std::string> Split(const std::string& string, const std::string& del
     return parts;
 }
 
-bool ReadScore(std::ifstream& inStream, std::vector<int>& scoresToReadTo, int maxScoreCount, bool shouldBeSortedAscending)
+bool ReadScore(std::istream& inStream, std::vector<int>& scoresToReadTo, int maxScoreCount, bool shouldBeSortedAscending)
 {
     std::string scoresLine;
     if (std::getline(inStream, scoresLine)) {
@@ -72,7 +76,23 @@ bool HighScore::ReadHighScore()
         if (std::filesystem::exists(HighScoreFilePath)) {
             std::ifstream highScoreStream { HighScoreFilePath };
 
-            if (ReadScore(highScoreStream, _classicScores, ScoresRemembered, false) && ReadScore(highScoreStream, _quickDeathScores, ScoresRemembered, true)) {
+            std::string firstLine;
+            if (!std::getline(highScoreStream, firstLine)) {
+                return false;
+            }
+
+            if (firstLine == VersionPrefix + std::to_string(FileVersion)) {
+                if (ReadScore(highScoreStream, _classicScores, ScoresRemembered, false) && ReadScore(highScoreStream, _quickDeathScores, ScoresRemembered, true)) {
+                    return true;
+                }
+            } else if (!firstLine.starts_with(VersionPrefix)) {
+                // A file from before the version line, its first line holds the Classic scores
+                std::istringstream classicScoresStream { firstLine };
+                ReadScore(classicScoresStream, _classicScores, ScoresRemembered, false);
+                highScoreStream.close();
+
+                std::filesystem::copy_file(HighScoreFilePath, ArchivedHighScoreFilePath, std::filesystem::copy_options::skip_existing);
+                WriteHighScore();
                 return true;
             }
         }
@@ -88,6 +108,8 @@ bool HighScore::WriteHighScore()
     try {
         std::ofstream highScoreOut { HighScoreFilePath };
 
+        highScoreOut << VersionPrefix << FileVersion << std::endl;
+
         for (auto score : _classicScores) {
             highScoreOut << score << " ";
         }
@@ -98,6 +120,9 @@ bool HighScore::WriteHighScore()
             highScoreOut << score << " ";
         }
 
+        // Ends the line even without scores, so a file with no QuickDeath scores still reads back
+        highScoreOut << std::endl;
+
         return true;
 
     } catch (const std::exception&) {
@@ -18,6 +18,9 @@ public:
 
 private:
     static constexpr int ScoresRemembered = 5;
+    // Files without a version line are from before moves made during a cascade gained less QuickDeath time. Reading one
+    // keeps its Classic scores, archives the file to high.score.v1 and starts the QuickDeath scores over.
+    static constexpr int FileVersion = 2;
 
     // Scores are stored in ascending order
     std::vector<int> _classicScores;
@@ -0,0 +1,11 @@
+#pragma once
+
+// The sounds the game rules can play. Implemented by AudioPlayer, so the rules don't depend on SDL Mixer.
+class IAudioSink {
+public:
+    enum class SoundEffect { TileDisappear };
+
+    virtual void PlaySoundEffect(SoundEffect effect) = 0;
+
+    virtual ~IAudioSink() = default;
+};
@@ -0,0 +1,33 @@
+#pragma once
+
+#include "Vec2.h"
+
+#include <cstdint>
+#include <string>
+
+struct Rect {
+    int x;
+    int y;
+    int w;
+    int h;
+};
+
+struct Color {
+    uint8_t r;
+    uint8_t g;
+    uint8_t b;
+    uint8_t a = 255;
+};
+
+// Everything the game rules need to draw themselves. Implemented by Screen, so the rules don't depend on SDL.
+class IRenderer {
+public:
+    virtual int GetScreenWidth() const = 0;
+
+    virtual void DrawCell(Vec2 coords, int cellType, int sourceSize, int destinationSize) const = 0;
+    virtual void DrawDestroyAnimation(Vec2 coords, int size, double progress) = 0;
+    virtual void DrawText(const std::string& text, const Rect& textRect, bool useLargeFont) const = 0;
+    virtual void DrawBackgroundRectangle(const Rect& rect, Color color = { 50, 50, 50, 100 }) const = 0;
+
+    virtual ~IRenderer() = default;
+};
@@ -12,6 +12,9 @@ void InputProcessor::ProcessKeyEvent(const SDL_Event& keyEvent)
     case SDLK_ESCAPE: {
         KeyPressed.Invoke(Key::Escape);
     } break;
+    case SDLK_SPACE: {
+        KeyPressed.Invoke(Key::Space);
+    } break;
     }
 }
 
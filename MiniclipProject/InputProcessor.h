@@ -9,6 +9,7 @@
 
 enum class Key {
     Escape,
+    Space,
 };
 
 class InputProcessor {
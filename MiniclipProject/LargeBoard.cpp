@@ -0,0 +1,370 @@
+#include "LargeBoard.h"
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+
+namespace {
+constexpr int ChunkSize = LargeBoard::ChunkSize;
+constexpr int Halo = 2; // Deciding if a cell is part of a run needs the 2 cells on each side of it
+constexpr int PaddedSize = ChunkSize + 2 * Halo;
+constexpr uint8_t OffBoard = 0xFF;
+
+// The types of a chunk with a border of Halo cells taken from its neighbours, column major.
+// Cells outside of the board are OffBoard, which is never equal to a cell on the board.
+using PaddedChunk = std::array<uint8_t, PaddedSize * PaddedSize>;
+
+void LoadPaddedChunk(const LargeBoard& board, int chunkIndex, PaddedChunk& padded)
+{
+    padded.fill(OffBoard);
+
+    int chunkCol = chunkIndex % board.GetChunkColCount();
+    int chunkRow = chunkIndex / board.GetChunkColCount();
+
+    // The chunk itself and the border from its 8 neighbours, as the block of columns each one contributes
+    for (int dx = -1; dx <= 1; ++dx) {
+        for (int dy = -1; dy <= 1; ++dy) {
+            int neighbourCol = chunkCol + dx;
+            int neighbourRow = chunkRow + dy;
+            if (neighbourCol < 0 || neighbourCol >= board.GetChunkColCount() || neighbourRow < 0 || neighbourRow >= board.GetChunkRowCount()) {
+                continue;
+            }
+
+            int neighbourIndex = neighbourRow * board.GetChunkColCount() + neighbourCol;
+            auto neighbourSize = board.GetChunkSize(neighbourIndex);
+
+            // Chunks to the left and above are always whole, the ones to the right and below can be cut off by the board
+            int sourceX = dx < 0 ? ChunkSize - Halo : 0;
+            int sourceY = dy < 0 ? ChunkSize - Halo : 0;
+            int width = dx == 0 ? neighbourSize.x : std::min(Halo, neighbourSize.x);
+            int height = dy == 0 ? neighbourSize.y : std::min(Halo, neighbourSize.y);
+            int targetX = Halo + dx * ChunkSize + sourceX;
+            int targetY = Halo + dy * ChunkSize + sourceY;
+
+            for (int x = 0; x < width; ++x) {
+                std::memcpy(&padded[size_t(targetX + x) * PaddedSize + targetY], board.ChunkColumnTypes(neighbourIndex, sourceX + x) + sourceY, size_t(height));
+            }
+        }
+    }
+}
+
+struct ChunkMatchResult {
+    int64_t DestroyedCount = 0;
+    uint64_t DestroyedColumnMask = 0;
+    int HighestRowCombo = 0;
+    int HighestColumnCombo = 0;
+};
+
+// Walks a run from its first cell to find its length, the part outside of the padded chunk is read from the board
+int MeasureRun(const LargeBoard& board, Vec2 start, Vec2 direction)
+{
+    auto type = board.Type(start);
+    int length = 1;
+
+    for (auto index = start + direction; board.IsIndexOnTheBoard(index) && board.Type(index) == type; index = index + direction) {
+        ++length;
+    }
+
+    return length;
+}
+
+// Packs 8 bytes that are either 0 or 1 into the low 8 bits, the first byte going to bit 0
+uint64_t PackBytes(const uint8_t* bytes)
+{
+    uint64_t word;
+    std::memcpy(&word, bytes, sizeof(word));
+    return (word * 0x0102040810204080ull) >> 56;
+}
+
+ChunkMatchResult FindMatchesInChunk(const LargeBoard& board, int chunkIndex, std::array<uint64_t, ChunkSize>& destroyed)
+{
+    PaddedChunk padded;
+    LoadPaddedChunk(board, chunkIndex, padded);
+
+    auto origin = board.GetChunkOrigin(chunkIndex);
+    auto size = board.GetChunkSize(chunkIndex);
+    ChunkMatchResult result;
+
+    destroyed.fill(0);
+    alignas(8) std::array<uint8_t, ChunkSize> destroyedColumn {};
+
+    for (int x = 0; x < size.x; ++x) {
+        const uint8_t* left2 = &padded[size_t(x) * PaddedSize + Halo];
+        const uint8_t* left1 = left2 + PaddedSize;
+        const uint8_t* center = left1 + PaddedSize;
+        const uint8_t* right1 = center + PaddedSize;
+        const uint8_t* right2 = right1 + PaddedSize;
+
+        // Branch free, so the compiler can do a whole column with a few vector instructions
+        int destroyedCount = 0;
+        int anyRunStart = 0;
+        for (int y = 0; y < size.y; ++y) {
+            auto c = center[y];
+            int sameLeft1 = c == left1[y], sameLeft2 = c == left2[y], sameRight1 = c == right1[y], sameRight2 = c == right2[y];
+            int sameUp1 = c == center[y - 1], sameUp2 = c == center[y - 2], sameDown1 = c == center[y + 1], sameDown2 = c == center[y + 2];
+
+            int inRow = (sameLeft1 & sameLeft2) | (sameLeft1 & sameRight1) | (sameRight1 & sameRight2);
+            int inColumn = (sameUp1 & sameUp2) | (sameUp1 & sameDown1) | (sameDown1 & sameDown2);
+            int isRunStart = ((sameLeft1 ^ 1) & sameRight1 & sameRight2) | ((sameUp1 ^ 1) & sameDown1 & sameDown2);
+
+            destroyedColumn[y] = uint8_t(inRow | inColumn);
+            destroyedCount += inRow | inColumn;
+            anyRunStart |= isRunStart;
+        }
+
+        result.DestroyedCount += destroyedCount;
+        result.DestroyedColumnMask |= uint64_t(destroyedCount > 0) << x;
+
+        if (destroyedCount > 0) {
+            for (int y = 0; y < size.y; y += 8) {
+                destroyed[x] |= PackBytes(&destroyedColumn[y]) << y;
+            }
+        }
+
+        if (!anyRunStart) {
+            continue;
+        }
+
+        // Runs are rare, so their lengths are measured one by one. Each run is measured by the chunk of its first cell.
+        for (int y = 0; y < size.y; ++y) {
+            auto c = center[y];
+            if (c != left1[y] && c == right1[y] && c == right2[y]) {
+                result.HighestRowCombo = std::max(result.HighestRowCombo, MeasureRun(board, origin + Vec2 { x, y }, Vec2 { 1, 0 }));
+            }
+            if (c != center[y - 1] && c == center[y + 1] && c == center[y + 2]) {
+                result.HighestColumnCombo = std::max(result.HighestColumnCombo, MeasureRun(board, origin + Vec2 { x, y }, Vec2 { 0, 1 }));
+            }
+        }
+    }
+
+    return result;
+}
+}
+
+LargeBoard::LargeBoard(int colCount, int rowCount)
+    : _colCount(colCount)
+    , _rowCount(rowCount)
+    , _chunkColCount((colCount + ChunkSize - 1) / ChunkSize)
+    , _chunkRowCount((rowCount + ChunkSize - 1) / ChunkSize)
+    , _chunks(size_t(_chunkColCount) * _chunkRowCount)
+{
+    for (auto& chunk : _chunks) {
+        chunk.States.fill(CellState::Normal);
+    }
+}
+
+bool LargeBoard::IsIndexOnTheBoard(Vec2 index) const
+{
+    return index.x >= 0 && index.x < _colCount && index.y >= 0 && index.y < _rowCount;
+}
+
+Vec2 LargeBoard::GetChunkOrigin(int chunkIndex) const
+{
+    return Vec2 { chunkIndex % _chunkColCount * ChunkSize, chunkIndex / _chunkColCount * ChunkSize };
+}
+
+Vec2 LargeBoard::GetChunkSize(int chunkIndex) const
+{
+    auto origin = GetChunkOrigin(chunkIndex);
+    return Vec2 { std::min(ChunkSize, _colCount - origin.x), std::min(ChunkSize, _rowCount - origin.y) };
+}
+
+LargeBoardEngine::LargeBoardEngine(int tileKindCount, uint64_t seed, WorkStealingPool& pool)
+    : TileKindCount(tileKindCount)
+    , _seed(seed)
+    , _pool(&pool)
+{
+    assert(tileKindCount > 0 && tileKindCount < OffBoard);
+}
+
+void LargeBoardEngine::Fill(LargeBoard& board)
+{
+    auto fillSeed = RandomGenerator(_seed, _generation++).Next();
+
+    _pool->ParallelFor(size_t(board.GetChunkCount()), [&](size_t chunkIndex) {
+        RandomGenerator random(fillSeed, chunkIndex);
+        auto size = board.GetChunkSize(int(chunkIndex));
+
+        for (int x = 0; x < size.x; ++x) {
+            auto types = board.ChunkColumnTypes(int(chunkIndex), x);
+            auto states = board.ChunkColumnStates(int(chunkIndex), x);
+            for (int y = 0; y < size.y; ++y) {
+                types[y] = uint8_t(random.NextInt(TileKindCount));
+                states[y] = CellState::Normal;
+            }
+        }
+    });
+}
+
+LargeBoardMatches LargeBoardEngine::FindMatches(const LargeBoard& board)
+{
+    std::vector<int> chunkIndices(size_t(board.GetChunkCount()));
+    for (int i = 0; i < board.GetChunkCount(); ++i) {
+        chunkIndices[i] = i;
+    }
+
+    return FindMatchesInChunks(board, chunkIndices);
+}
+
+LargeBoardMatches LargeBoardEngine::FindMatchesAfterFall(const LargeBoard& board, const LargeGravityResult& gravityResult)
+{
+    assert(int(gravityResult.LowestChangedRows.size()) == board.GetColCount());
+
+    // A changed cell can complete a run with the 2 cells on either side of it and the 2 cells below it
+    std::vector<int> lowestDirtyChunkRows(size_t(board.GetChunkColCount()), -1);
+    for (int x = 0; x < board.GetColCount(); ++x) {
+        auto lowestChangedRow = gravityResult.LowestChangedRows[x];
+        if (lowestChangedRow < 0) {
+            continue;
+        }
+
+        auto lowestChunkRow = std::min(lowestChangedRow + Halo, board.GetRowCount() - 1) / ChunkSize;
+        for (int chunkCol = std::max(x - Halo, 0) / ChunkSize; chunkCol <= std::min(x + Halo, board.GetColCount() - 1) / ChunkSize; ++chunkCol) {
+            lowestDirtyChunkRows[chunkCol] = std::max(lowestDirtyChunkRows[chunkCol], lowestChunkRow);
+        }
+    }
+
+    std::vector<int> chunkIndices;
+    for (int chunkCol = 0; chunkCol < board.GetChunkColCount(); ++chunkCol) {
+        for (int chunkRow = 0; chunkRow <= lowestDirtyChunkRows[chunkCol]; ++chunkRow) {
+            chunkIndices.push_back(chunkRow * board.GetChunkColCount() + chunkCol);
+        }
+    }
+
+    return FindMatchesInChunks(board, chunkIndices);
+}
+
+LargeBoardMatches LargeBoardEngine::FindMatchesInChunks(const LargeBoard& board, const std::vector<int>& chunkIndices)
+{
+    LargeBoardMatches matches;
+    matches.ScannedChunks = chunkIndices;
+    matches.DestroyedChunks.resize(chunkIndices.size());
+    matches.DestroyedColumnMasks.resize(chunkIndices.size());
+
+    std::vector<ChunkMatchResult> chunkResults(chunkIndices.size());
+
+    _pool->ParallelFor(chunkIndices.size(), [&](size_t i) {
+        chunkResults[i] = FindMatchesInChunk(board, chunkIndices[i], matches.DestroyedChunks[i]);
+    });
+
+    for (size_t i = 0; i < chunkIndices.size(); ++i) {
+        const auto& chunkResult = chunkResults[i];
+        matches.DestroyedColumnMasks[i] = chunkResult.DestroyedColumnMask;
+        matches.DestroyedCount += chunkResult.DestroyedCount;
+        matches.HighestRowCombo = std::max(matches.HighestRowCombo, chunkResult.HighestRowCombo);
+        matches.HighestColumnCombo = std::max(matches.HighestColumnCombo, chunkResult.HighestColumnCombo);
+    }
+
+    return matches;
+}
+
+void LargeBoardEngine::DestroyMatches(LargeBoard& board, const LargeBoardMatches& matches)
+{
+    assert(matches.DestroyedChunks.size() == matches.ScannedChunks.size());
+
+    _pool->ParallelFor(matches.ScannedChunks.size(), [&](size_t i) {
+        auto chunkIndex = matches.ScannedChunks[i];
+        const auto& destroyed = matches.DestroyedChunks[i];
+
+        for (auto columnMask = matches.DestroyedColumnMasks[i]; columnMask != 0; columnMask &= columnMask - 1) {
+            int x = std::countr_zero(columnMask);
+            auto states = board.ChunkColumnStates(chunkIndex, x);
+            for (auto rowMask = destroyed[x]; rowMask != 0; rowMask &= rowMask - 1) {
+                states[std::countr_zero(rowMask)] = CellState::Destroyed;
+            }
+        }
+    });
+}
+
+LargeGravityResult LargeBoardEngine::ApplyGravity(LargeBoard& board, const LargeBoardMatches& destroyedMatches)
+{
+    auto refillSeed = RandomGenerator(_seed, _generation++).Next();
+
+    LargeGravityResult result;
+    result.LowestChangedRows.assign(size_t(board.GetColCount()), -1);
+
+    std::vector<uint64_t> chunkColumnMasks(size_t(board.GetChunkColCount()), 0);
+    for (size_t i = 0; i < destroyedMatches.ScannedChunks.size(); ++i) {
+        chunkColumnMasks[destroyedMatches.ScannedChunks[i] % board.GetChunkColCount()] |= destroyedMatches.DestroyedColumnMasks[i];
+    }
+
+    std::vector<int> columns;
+    for (int x = 0; x < board.GetColCount(); ++x) {
+        if (chunkColumnMasks[x / ChunkSize] & (uint64_t(1) << (x % ChunkSize))) {
+            columns.push_back(x);
+        }
+    }
+
+    std::vector<int> spawnedCounts(columns.size(), 0);
+
+    // Columns are independent, so every column is a task. It's one cache line per chunk, no two workers write the same line.
+    _pool->ParallelFor(columns.size(), [&](size_t i) {
+        auto x = columns[i];
+        int chunkCol = x / ChunkSize;
+        int colInChunk = x % ChunkSize;
+        int rowCount = board.GetRowCount();
+
+        // The column is spread over a chunk per ChunkSize rows, so it's gathered, compacted and scattered back
+        thread_local std::vector<uint8_t> types;
+        thread_local std::vector<CellState> states;
+        types.resize(size_t(rowCount));
+        states.resize(size_t(rowCount));
+
+        for (int chunkRow = 0; chunkRow < board.GetChunkRowCount(); ++chunkRow) {
+            int chunkIndex = chunkRow * board.GetChunkColCount() + chunkCol;
+            int y = chunkRow * ChunkSize;
+            int count = std::min(ChunkSize, rowCount - y);
+            std::memcpy(&types[y], board.ChunkColumnTypes(chunkIndex, colInChunk), size_t(count));
+            std::memcpy(&states[y], board.ChunkColumnStates(chunkIndex, colInChunk), size_t(count) * sizeof(CellState));
+        }
+
+        int lowestChangedRow = rowCount - 1;
+        while (lowestChangedRow >= 0 && states[lowestChangedRow] != CellState::Destroyed) {
+            --lowestChangedRow;
+        }
+        if (lowestChangedRow < 0) {
+            return;
+        }
+
+        int writeRow = lowestChangedRow;
+        for (int y = lowestChangedRow; y >= 0; --y) {
+            types[writeRow] = types[y];
+            writeRow -= states[y] != CellState::Destroyed;
+        }
+
+        RandomGenerator random(refillSeed, uint64_t(x));
+        random.NextInts(TileKindCount, types.data(), writeRow + 1);
+
+        for (int chunkRow = 0; chunkRow <= lowestChangedRow / ChunkSize; ++chunkRow) {
+            int chunkIndex = chunkRow * board.GetChunkColCount() + chunkCol;
+            int y = chunkRow * ChunkSize;
+            int count = std::min(ChunkSize, lowestChangedRow + 1 - y);
+            std::memcpy(board.ChunkColumnTypes(chunkIndex, colInChunk), &types[y], size_t(count));
+            std::fill_n(board.ChunkColumnStates(chunkIndex, colInChunk), count, CellState::Normal);
+        }
+
+        result.LowestChangedRows[x] = lowestChangedRow;
+        spawnedCounts[i] = writeRow + 1;
+    });
+
+    for (auto spawnedCount : spawnedCounts) {
+        result.SpawnedCount += spawnedCount;
+    }
+
+    return result;
+}
+
+int LargeBoardEngine::ResolveCascade(LargeBoard& board, int maxSteps)
+{
+    int steps = 0;
+    auto matches = FindMatches(board);
+
+    while (steps < maxSteps && matches.DestroyedCount > 0) {
+        DestroyMatches(board, matches);
+        auto gravityResult = ApplyGravity(board, matches);
+        matches = FindMatchesAfterFall(board, gravityResult);
+        ++steps;
+    }
+
+    return steps;
+}
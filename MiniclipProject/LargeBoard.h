@@ -0,0 +1,122 @@
+#pragma once
+
+#include "Board.h"
+#include "RandomGenerator.h"
+#include "Vec2.h"
+#include "WorkStealingPool.h"
+
+#include <array>
+#include <cassert>
+#include <cstdint>
+#include <vector>
+
+// A board for stress testing the engine with millions of cells, eg. 1024x1024 or bigger, of any shape.
+// The cells are stored in square chunks of ChunkSize x ChunkSize, each one column major like Board,
+// so a chunk and the borders of its neighbours fit into the L1 cache while it's being scanned.
+class LargeBoard {
+public:
+    static constexpr int ChunkSize = 64;
+    static constexpr int ChunkCellCount = ChunkSize * ChunkSize;
+
+    LargeBoard(int colCount, int rowCount);
+
+    int GetColCount() const { return _colCount; }
+    int GetRowCount() const { return _rowCount; }
+    int GetChunkColCount() const { return _chunkColCount; }
+    int GetChunkRowCount() const { return _chunkRowCount; }
+    int GetChunkCount() const { return _chunkColCount * _chunkRowCount; }
+
+    uint8_t& Type(Vec2 index) { return ChunkAt(index).Types[IndexInChunk(index)]; }
+    uint8_t Type(Vec2 index) const { return ChunkAt(index).Types[IndexInChunk(index)]; }
+    CellState& State(Vec2 index) { return ChunkAt(index).States[IndexInChunk(index)]; }
+    CellState State(Vec2 index) const { return ChunkAt(index).States[IndexInChunk(index)]; }
+
+    bool IsIndexOnTheBoard(Vec2 index) const;
+
+    // The top left cell of the chunk and the number of its columns and rows that are on the board
+    Vec2 GetChunkOrigin(int chunkIndex) const;
+    Vec2 GetChunkSize(int chunkIndex) const;
+
+    // The cells of one column of a chunk, ChunkSize of them one after the other
+    uint8_t* ChunkColumnTypes(int chunkIndex, int col) { return &_chunks[chunkIndex].Types[size_t(col) * ChunkSize]; }
+    const uint8_t* ChunkColumnTypes(int chunkIndex, int col) const { return &_chunks[chunkIndex].Types[size_t(col) * ChunkSize]; }
+    CellState* ChunkColumnStates(int chunkIndex, int col) { return &_chunks[chunkIndex].States[size_t(col) * ChunkSize]; }
+    const CellState* ChunkColumnStates(int chunkIndex, int col) const { return &_chunks[chunkIndex].States[size_t(col) * ChunkSize]; }
+
+private:
+    // A column of a chunk is exactly one cache line, so workers processing neighbouring columns don't share lines
+    struct alignas(64) Chunk {
+        std::array<uint8_t, ChunkCellCount> Types {};
+        std::array<CellState, ChunkCellCount> States {};
+    };
+
+    int _colCount;
+    int _rowCount;
+    int _chunkColCount;
+    int _chunkRowCount;
+
+    // Row major grid of chunks
+    std::vector<Chunk> _chunks;
+
+    Chunk& ChunkAt(Vec2 index)
+    {
+        assert(IsIndexOnTheBoard(index));
+        return _chunks[size_t(index.y / ChunkSize) * _chunkColCount + index.x / ChunkSize];
+    }
+
+    const Chunk& ChunkAt(Vec2 index) const
+    {
+        assert(IsIndexOnTheBoard(index));
+        return _chunks[size_t(index.y / ChunkSize) * _chunkColCount + index.x / ChunkSize];
+    }
+
+    static int IndexInChunk(Vec2 index) { return (index.x % ChunkSize) * ChunkSize + index.y % ChunkSize; }
+};
+
+struct LargeBoardMatches {
+    // Only the chunks that were scanned are listed, chunks that weren't have no destroyed cells
+    std::vector<int> ScannedChunks;
+    // For every scanned chunk, bit y of word x is set if the cell at column x and row y of the chunk is part of a run
+    std::vector<std::array<uint64_t, LargeBoard::ChunkSize>> DestroyedChunks;
+    // For every scanned chunk, bit x is set if column x of the chunk has a destroyed cell
+    std::vector<uint64_t> DestroyedColumnMasks;
+    int64_t DestroyedCount = 0;
+    int HighestRowCombo = 0;
+    int HighestColumnCombo = 0;
+};
+
+struct LargeGravityResult {
+    int64_t SpawnedCount = 0;
+    // The lowest row that changed in every column, or -1 if the column didn't change
+    std::vector<int> LowestChangedRows;
+};
+
+// Match detection, destruction and gravity for a LargeBoard, with every step split over the workers of the pool.
+// Chunks only write their own cells and every column of the board gets its own random stream for the refill,
+// so the results don't depend on the number of threads.
+class LargeBoardEngine {
+public:
+    LargeBoardEngine(int tileKindCount, uint64_t seed, WorkStealingPool& pool);
+
+    // Random tiles, runs included. They are removed by the first cascade.
+    void Fill(LargeBoard& board);
+
+    LargeBoardMatches FindMatches(const LargeBoard& board);
+    // Only scans the chunks that the fall could have changed, so late cascade steps with a few runs are cheap.
+    // Gives the same result as FindMatches as long as the rest of the board had no runs.
+    LargeBoardMatches FindMatchesAfterFall(const LargeBoard& board, const LargeGravityResult& gravityResult);
+    void DestroyMatches(LargeBoard& board, const LargeBoardMatches& matches);
+    // Drops the cells above the ones destroyed by DestroyMatches and fills the top of the columns with new tiles
+    LargeGravityResult ApplyGravity(LargeBoard& board, const LargeBoardMatches& destroyedMatches);
+
+    // Destroys, drops and refills until the board has no runs, or maxSteps is reached. Returns the number of steps.
+    int ResolveCascade(LargeBoard& board, int maxSteps);
+
+private:
+    const int TileKindCount;
+    uint64_t _seed;
+    uint64_t _generation = 0;
+    WorkStealingPool* _pool;
+
+    LargeBoardMatches FindMatchesInChunks(const LargeBoard& board, const std::vector<int>& chunkIndices);
+};
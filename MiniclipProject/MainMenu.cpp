@@ -120,6 +120,18 @@ void MainMenu::ShowLeaderboard(const std::vector<int>& classicHighScores, const
     _isShowingLeaderboard = true;
 }
 
+std::optional<Vec2> MainMenu::GetButtonCenter(ButtonType type) const
+{
+    const auto& currentButtons = _isShowingLeaderboard ? _leaderboardButtons : _buttons;
+    for (const auto& button : currentButtons) {
+        if (button.Type == type) {
+            return Vec2 { button.Position.x + button.Position.w / 2, button.Position.y + button.Position.h / 2 };
+        }
+    }
+
+    return std::nullopt;
+}
+
 void MainMenu::GoBackFromLeaderboard()
 {
     _isShowingLeaderboard = false;
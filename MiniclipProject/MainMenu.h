@@ -25,6 +25,8 @@ public:
     void Activate(bool needsResumeButton, const std::vector<std::string>& additionalText);
     void Deactivate();
     void ShowLeaderboard(const std::vector<int>& classicHighScores, const std::vector<int>& quickDeathHighScores);
+    // Where the button is on the screen, if it is currently shown
+    std::optional<Vec2> GetButtonCenter(ButtonType type) const;
 
     Event<std::function<void(ButtonType clickedButton)>> ButtonClicked;
 
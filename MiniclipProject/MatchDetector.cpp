@@ -0,0 +1,389 @@
+#include "MatchDetector.h"
+
+#include "BasicBoard.h"
+
+#include <algorithm>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define MATCH_DETECTOR_USE_AVX2
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define MATCH_DETECTOR_USE_SSE2
+#endif
+
+namespace {
+constexpr int BitsPerWord = CellMask::BitsPerWord;
+
+// Column x of the result holds column (x + shift) of the row
+uint64_t ShiftedTowardsLowerColumns(const uint64_t* row, int wordCount, int word, int shift)
+{
+    int sourceWord = word + shift / BitsPerWord;
+    int bitShift = shift % BitsPerWord;
+
+    uint64_t low = sourceWord < wordCount ? row[sourceWord] >> bitShift : 0;
+    uint64_t high = (bitShift != 0 && sourceWord + 1 < wordCount) ? row[sourceWord + 1] << (BitsPerWord - bitShift) : 0;
+
+    return low | high;
+}
+
+// Column x of the result holds column (x - shift) of the row
+uint64_t ShiftedTowardsHigherColumns(const uint64_t* row, int word, int shift)
+{
+    int sourceWord = word - shift / BitsPerWord;
+    int bitShift = shift % BitsPerWord;
+
+    uint64_t low = sourceWord >= 0 ? row[sourceWord] << bitShift : 0;
+    uint64_t high = (bitShift != 0 && sourceWord - 1 >= 0) ? row[sourceWord - 1] >> (BitsPerWord - bitShift) : 0;
+
+    return low | high;
+}
+
+// The column runs are found by combining whole rows with each other, these loops are where wide boards spend their time
+
+void And3(uint64_t* destination, const uint64_t* a, const uint64_t* b, const uint64_t* c, int count)
+{
+    int i = 0;
+#if defined(MATCH_DETECTOR_USE_AVX2)
+    for (; i + 4 <= count; i += 4) {
+        auto result = _mm256_and_si256(
+            _mm256_and_si256(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i)), _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + i))),
+            _mm256_loadu_si256(reinterpret_cast<const __m256i*>(c + i)));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(destination + i), result);
+    }
+#elif defined(MATCH_DETECTOR_USE_SSE2)
+    for (; i + 2 <= count; i += 2) {
+        auto result = _mm_and_si128(
+            _mm_and_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i)), _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i))),
+            _mm_loadu_si128(reinterpret_cast<const __m128i*>(c + i)));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(destination + i), result);
+    }
+#endif
+    for (; i < count; ++i) {
+        destination[i] = a[i] & b[i] & c[i];
+    }
+}
+
+void OrInto(uint64_t* destination, const uint64_t* source, int count)
+{
+    int i = 0;
+#if defined(MATCH_DETECTOR_USE_AVX2)
+    for (; i + 4 <= count; i += 4) {
+        auto* target = reinterpret_cast<__m256i*>(destination + i);
+        _mm256_storeu_si256(target, _mm256_or_si256(_mm256_loadu_si256(target), _mm256_loadu_si256(reinterpret_cast<const __m256i*>(source + i))));
+    }
+#elif defined(MATCH_DETECTOR_USE_SSE2)
+    for (; i + 2 <= count; i += 2) {
+        auto* target = reinterpret_cast<__m128i*>(destination + i);
+        _mm_storeu_si128(target, _mm_or_si128(_mm_loadu_si128(target), _mm_loadu_si128(reinterpret_cast<const __m128i*>(source + i))));
+    }
+#endif
+    for (; i < count; ++i) {
+        destination[i] |= source[i];
+    }
+}
+
+// Returns whether any bit is left in the destination
+bool AndInto(uint64_t* destination, const uint64_t* source, int count)
+{
+    uint64_t any = 0;
+    int i = 0;
+#if defined(MATCH_DETECTOR_USE_AVX2)
+    auto anyVector = _mm256_setzero_si256();
+    for (; i + 4 <= count; i += 4) {
+        auto* target = reinterpret_cast<__m256i*>(destination + i);
+        auto result = _mm256_and_si256(_mm256_loadu_si256(target), _mm256_loadu_si256(reinterpret_cast<const __m256i*>(source + i)));
+        _mm256_storeu_si256(target, result);
+        anyVector = _mm256_or_si256(anyVector, result);
+    }
+    any = _mm256_testz_si256(anyVector, anyVector) ? 0 : 1;
+#elif defined(MATCH_DETECTOR_USE_SSE2)
+    auto anyVector = _mm_setzero_si128();
+    for (; i + 2 <= count; i += 2) {
+        auto* target = reinterpret_cast<__m128i*>(destination + i);
+        auto result = _mm_and_si128(_mm_loadu_si128(target), _mm_loadu_si128(reinterpret_cast<const __m128i*>(source + i)));
+        _mm_storeu_si128(target, result);
+        anyVector = _mm_or_si128(anyVector, result);
+    }
+    any = _mm_movemask_epi8(_mm_cmpeq_epi8(anyVector, _mm_setzero_si128())) == 0xFFFF ? 0 : 1;
+#endif
+    for (; i < count; ++i) {
+        destination[i] &= source[i];
+        any |= destination[i];
+    }
+
+    return any != 0;
+}
+
+bool AnyBitSet(const uint64_t* words, int count)
+{
+    return std::any_of(words, words + count, [](uint64_t word) { return word != 0; });
+}
+
+// Marks every run of a single row or column in the mask and returns the length of the longest one
+template <class TypeAt, class IndexAt>
+int MarkRunsInLine(int lineLength, TypeAt&& typeAt, IndexAt&& indexAt, CellMask& destroyedCells)
+{
+    int longestRun = 0;
+    int start = 0;
+
+    while (start < lineLength - 2) {
+        auto type = typeAt(start);
+        int end = start + 1;
+
+        while (end < lineLength && typeAt(end) == type) {
+            ++end;
+        }
+
+        if (end - start >= MatchDetector::MinimumRunLength) {
+            longestRun = std::max(longestRun, end - start);
+
+            for (int i = start; i < end; ++i) {
+                destroyedCells.Set(indexAt(i));
+            }
+        }
+
+        start = end;
+    }
+
+    return longestRun;
+}
+}
+
+CellDestructionData::CellDestructionData(CellMask&& destroyedMask, int highestRowCombo, int highestColCombo)
+    : DestroyedMask(std::move(destroyedMask))
+    , DestroyedCells(DestroyedMask.ToIndices())
+    , HighestRowCombo(highestRowCombo)
+    , HighestColumnCombo(highestColCombo)
+{
+}
+
+MatchDetector::MatchDetector(int colCount, int rowCount, int tileKindCount, bool useFixedBoard)
+    : _colCount(colCount)
+    , _rowCount(rowCount)
+    , _tileKindCount(tileKindCount)
+    , _wordsPerRow((colCount + BitsPerWord - 1) / BitsPerWord)
+    , _wordsPerKind(_wordsPerRow * rowCount)
+    , _fixedBoard(useFixedBoard ? FindFixedBoardFunctions(colCount, rowCount, tileKindCount) : nullptr)
+    , _kindMasks(size_t(_wordsPerKind) * tileKindCount)
+    , _runStarts(_wordsPerKind)
+{
+}
+
+CellDestructionData MatchDetector::FindMatches(const Board& board)
+{
+    assert(board.GetColCount() == _colCount && board.GetRowCount() == _rowCount);
+
+    if (_fixedBoard) {
+        return _fixedBoard->FindMatches(board);
+    }
+
+    BuildKindMasks(board);
+
+    CellMask destroyedCells(_colCount, _rowCount);
+    int maxRowStreak = 0;
+    int maxColStreak = 0;
+
+    for (int kind = 0; kind < _tileKindCount; ++kind) {
+        const uint64_t* kindMask = _kindMasks.data() + size_t(kind) * _wordsPerKind;
+
+        maxRowStreak = std::max(maxRowStreak, FindRowRuns(kindMask, destroyedCells));
+        maxColStreak = std::max(maxColStreak, FindColumnRuns(kindMask, destroyedCells));
+    }
+
+    return CellDestructionData(std::move(destroyedCells), maxRowStreak, maxColStreak);
+}
+
+void MatchDetector::BuildKindMasks(const Board& board)
+{
+    std::fill(_kindMasks.begin(), _kindMasks.end(), uint64_t(0));
+
+    for (int x = 0; x < _colCount; ++x) {
+        auto column = board.ColumnTypes(x);
+        auto wordInRow = x / BitsPerWord;
+        auto bit = uint64_t(1) << (x % BitsPerWord);
+
+        for (int y = 0; y < _rowCount; ++y) {
+            assert(column[y] < _tileKindCount);
+            _kindMasks[size_t(column[y]) * _wordsPerKind + size_t(y) * _wordsPerRow + wordInRow] |= bit;
+        }
+    }
+}
+
+int MatchDetector::FindRowRuns(const uint64_t* kindMask, CellMask& destroyedCells)
+{
+    if (_colCount < MinimumRunLength) {
+        return 0;
+    }
+
+    uint64_t* runStarts = _runStarts.data();
+    uint64_t* destroyed = destroyedCells.Words();
+    uint64_t anyRun = 0;
+
+    // A bit is set in runStarts if the cell and the next 2 cells to its right are all of this kind
+    for (int y = 0; y < _rowCount; ++y) {
+        const uint64_t* row = kindMask + size_t(y) * _wordsPerRow;
+        uint64_t* rowRunStarts = runStarts + size_t(y) * _wordsPerRow;
+
+        for (int w = 0; w < _wordsPerRow; ++w) {
+            rowRunStarts[w] = row[w] & ShiftedTowardsLowerColumns(row, _wordsPerRow, w, 1) & ShiftedTowardsLowerColumns(row, _wordsPerRow, w, 2);
+            anyRun |= rowRunStarts[w];
+        }
+
+        if (anyRun == 0) {
+            continue;
+        }
+
+        uint64_t* destroyedRow = destroyed + size_t(y) * _wordsPerRow;
+        for (int w = 0; w < _wordsPerRow; ++w) {
+            destroyedRow[w] |= rowRunStarts[w] | ShiftedTowardsHigherColumns(rowRunStarts, w, 1) | ShiftedTowardsHigherColumns(rowRunStarts, w, 2);
+        }
+    }
+
+    if (anyRun == 0) {
+        return 0;
+    }
+
+    // Keep extending the runs by one cell until none of them can be extended, that is the longest streak
+    int longestRun = MinimumRunLength;
+    while (longestRun < _colCount) {
+        anyRun = 0;
+
+        for (int y = 0; y < _rowCount; ++y) {
+            const uint64_t* row = kindMask + size_t(y) * _wordsPerRow;
+            uint64_t* rowRunStarts = runStarts + size_t(y) * _wordsPerRow;
+
+            for (int w = 0; w < _wordsPerRow; ++w) {
+                rowRunStarts[w] &= ShiftedTowardsLowerColumns(row, _wordsPerRow, w, longestRun);
+                anyRun |= rowRunStarts[w];
+            }
+        }
+
+        if (anyRun == 0) {
+            break;
+        }
+
+        ++longestRun;
+    }
+
+    return longestRun;
+}
+
+int MatchDetector::FindColumnRuns(const uint64_t* kindMask, CellMask& destroyedCells)
+{
+    if (_rowCount < MinimumRunLength) {
+        return 0;
+    }
+
+    uint64_t* runStarts = _runStarts.data();
+    uint64_t* destroyed = destroyedCells.Words();
+
+    // Rows are stored one after the other, so shifting by whole rows is just an offset into the word array
+    int startCount = (_rowCount - 2) * _wordsPerRow;
+    And3(runStarts, kindMask, kindMask + _wordsPerRow, kindMask + 2 * _wordsPerRow, startCount);
+
+    if (!AnyBitSet(runStarts, startCount)) {
+        return 0;
+    }
+
+    OrInto(destroyed, runStarts, startCount);
+    OrInto(destroyed + _wordsPerRow, runStarts, startCount);
+    OrInto(destroyed + 2 * _wordsPerRow, runStarts, startCount);
+
+    int longestRun = MinimumRunLength;
+    while (longestRun < _rowCount) {
+        int count = (_rowCount - longestRun) * _wordsPerRow;
+
+        if (!AndInto(runStarts, kindMask + size_t(longestRun) * _wordsPerRow, count)) {
+            break;
+        }
+
+        ++longestRun;
+    }
+
+    return longestRun;
+}
+
+CellDestructionData MatchDetector::FindMatchesAfterSwap(const Board& board, Vec2 lhs, Vec2 rhs) const
+{
+    assert(board.GetColCount() == _colCount && board.GetRowCount() == _rowCount);
+
+    if (_fixedBoard) {
+        return _fixedBoard->FindMatchesAfterSwap(board, lhs, rhs);
+    }
+
+    auto typeAt = [&board, lhs, rhs](Vec2 index) {
+        if (index == lhs) {
+            return board.Type(rhs);
+        } else if (index == rhs) {
+            return board.Type(lhs);
+        }
+
+        return board.Type(index);
+    };
+
+    CellMask destroyedCells(_colCount, _rowCount);
+    int maxRowStreak = 0;
+    int maxColStreak = 0;
+
+    for (int y : { lhs.y, rhs.y }) {
+        maxRowStreak = std::max(maxRowStreak,
+            MarkRunsInLine(
+                _colCount, [&](int x) { return typeAt(Vec2 { x, y }); }, [y](int x) { return Vec2 { x, y }; }, destroyedCells));
+
+        if (lhs.y == rhs.y) {
+            break;
+        }
+    }
+
+    for (int x : { lhs.x, rhs.x }) {
+        maxColStreak = std::max(maxColStreak,
+            MarkRunsInLine(
+                _rowCount, [&](int y) { return typeAt(Vec2 { x, y }); }, [x](int y) { return Vec2 { x, y }; }, destroyedCells));
+
+        if (lhs.x == rhs.x) {
+            break;
+        }
+    }
+
+    return CellDestructionData(std::move(destroyedCells), maxRowStreak, maxColStreak);
+}
+
+CellDestructionData MatchDetector::FindMatchesAfterFall(const Board& board, const std::vector<int>& lowestChangedRows) const
+{
+    assert(board.GetColCount() == _colCount && board.GetRowCount() == _rowCount);
+    assert(int(lowestChangedRows.size()) == _colCount);
+
+    // On small boards scanning everything at once is faster than scanning only the changed lines
+    if (_fixedBoard) {
+        return _fixedBoard->FindMatches(board);
+    }
+
+    CellMask destroyedCells(_colCount, _rowCount);
+    int maxRowStreak = 0;
+    int maxColStreak = 0;
+    int lowestChangedRow = -1;
+
+    for (int x = 0; x < _colCount; ++x) {
+        if (lowestChangedRows[x] < 0) {
+            continue;
+        }
+
+        auto column = board.ColumnTypes(x);
+        maxColStreak = std::max(maxColStreak,
+            MarkRunsInLine(
+                _rowCount, [&column](int y) { return column[y]; }, [x](int y) { return Vec2 { x, y }; }, destroyedCells));
+
+        lowestChangedRow = std::max(lowestChangedRow, lowestChangedRows[x]);
+    }
+
+    // Cells only fall down, so every row below the lowest change is the same as before
+    for (int y = 0; y <= lowestChangedRow; ++y) {
+        auto row = board.RowTypes(y);
+        maxRowStreak = std::max(maxRowStreak,
+            MarkRunsInLine(
+                _colCount, [&row](int x) { return row[x]; }, [y](int x) { return Vec2 { x, y }; }, destroyedCells));
+    }
+
+    return CellDestructionData(std::move(destroyedCells), maxRowStreak, maxColStreak);
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#include "Board.h"
+#include "CellMask.h"
+#include "Vec2.h"
+
+#include <cstdint>
+#include <vector>
+
+struct FixedBoardFunctions;
+
+struct CellDestructionData {
+    CellDestructionData(CellMask&& destroyedMask, int highestRowCombo, int highestColCombo);
+
+    CellMask DestroyedMask;
+    std::vector<Vec2> DestroyedCells;
+    int HighestRowCombo;
+    int HighestColumnCombo;
+};
+
+// Finds every run of at least 3 cells of the same kind on the board.
+// Keeps one bitboard per tile kind, so runs are found with shifts and ANDs instead of cell by cell comparisons.
+// Common board sizes are handed to a compile-time sized BasicBoard instead.
+class MatchDetector {
+public:
+    static constexpr int MinimumRunLength = 3;
+
+    // useFixedBoard only exists so the benchmarks can compare against the runtime sized scans
+    MatchDetector(int colCount, int rowCount, int tileKindCount, bool useFixedBoard = true);
+
+    CellDestructionData FindMatches(const Board& board);
+
+    // The incremental versions below only scan the rows and columns that could have changed,
+    // so they give the same result as FindMatches as long as the rest of the board had no matches.
+
+    // Checks the board as if lhs and rhs were switched, without modifying it
+    CellDestructionData FindMatchesAfterSwap(const Board& board, Vec2 lhs, Vec2 rhs) const;
+    // lowestChangedRows holds the lowest row that changed in every column, or -1 if the column didn't change
+    CellDestructionData FindMatchesAfterFall(const Board& board, const std::vector<int>& lowestChangedRows) const;
+
+private:
+    int _colCount;
+    int _rowCount;
+    int _tileKindCount;
+    int _wordsPerRow;
+    int _wordsPerKind;
+    const FixedBoardFunctions* _fixedBoard;
+
+    // Laid out the same way as the words of a CellMask, one board after the other for every kind
+    std::vector<uint64_t> _kindMasks;
+    std::vector<uint64_t> _runStarts;
+
+    void BuildKindMasks(const Board& board);
+    int FindRowRuns(const uint64_t* kindMask, CellMask& destroyedCells);
+    int FindColumnRuns(const uint64_t* kindMask, CellMask& destroyedCells);
+};
@@ -0,0 +1,265 @@
+#include "MctsPlayer.h"
+
+#include "BoardGenerator.h"
+#include "CascadeResolver.h"
+#include "GameState.h"
+#include "MatchDetector.h"
+
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <cmath>
+
+namespace {
+using Clock = std::chrono::steady_clock;
+
+constexpr int NoNode = -1;
+}
+
+// The tree and the scratch space of one search thread
+class MctsPlayer::Searcher {
+public:
+    Searcher(int colCount, int rowCount, int tileKindCount, GameMode mode, const GameRules& rules, const MctsOptions& options)
+        : _options(options)
+        , _mode(mode)
+        , _rules(rules)
+        , _matchDetector(colCount, rowCount, tileKindCount)
+        , _cascadeResolver(colCount, rowCount, tileKindCount)
+        , _refillGenerator(tileKindCount, 0)
+        , _board(colCount, rowCount)
+        , _childBySwap(size_t(colCount) * rowCount * 2, NoNode)
+    {
+    }
+
+    void Search(const Board& rootBoard, uint64_t seed, uint64_t searcherIndex, Clock::time_point deadline, bool hasDeadline)
+    {
+        // Separate streams for the refills and the playout moves, different for every thread
+        _refillGenerator.SetRandomGenerator(RandomGenerator(seed, 2 * searcherIndex));
+        _random.Seed(seed, 2 * searcherIndex + 1);
+
+        _nodes.clear();
+        _nodes.push_back(Node {});
+        _bestReward = 1.0;
+        _playoutCount = 0;
+
+        while (_options.MaxPlayoutsPerThread == 0 || _playoutCount < _options.MaxPlayoutsPerThread) {
+            if (hasDeadline && Clock::now() >= deadline) {
+                break;
+            }
+
+            Playout(rootBoard);
+            ++_playoutCount;
+        }
+    }
+
+    uint64_t GetPlayoutCount() const { return _playoutCount; }
+
+    // Calls action(swap, visits, totalReward) for every first move that was tried
+    template <class Action>
+    void ForEachRootChild(Action&& action) const
+    {
+        for (int child = _nodes[0].FirstChild; child != NoNode; child = _nodes[size_t(child)].NextSibling) {
+            const auto& node = _nodes[size_t(child)];
+            action(node.Move, node.Visits, node.TotalReward);
+        }
+    }
+
+private:
+    struct Node {
+        LegalSwap Move {};
+        int FirstChild = NoNode;
+        int NextSibling = NoNode;
+        uint32_t Visits = 0;
+        double TotalReward = 0.0;
+    };
+
+    const MctsOptions& _options;
+    GameMode _mode;
+    GameRules _rules;
+
+    MatchDetector _matchDetector;
+    CascadeResolver _cascadeResolver;
+    BoardGenerator _refillGenerator;
+    RandomGenerator _random;
+    Board _board;
+
+    std::vector<Node> _nodes;
+    std::vector<int> _path;
+    std::vector<LegalSwap> _swaps;
+    // The child of the current node for every swap, indexed by SwapKey. Only filled while a node is being selected from.
+    std::vector<int> _childBySwap;
+    double _bestReward = 1.0;
+    uint64_t _playoutCount = 0;
+
+    int SwapKey(const LegalSwap& swap) const
+    {
+        // The destination is always to the right or below the source
+        return (swap.Source.x * _board.GetRowCount() + swap.Source.y) * 2 + (swap.Destination.y != swap.Source.y);
+    }
+
+    void Playout(const Board& rootBoard)
+    {
+        _board = rootBoard;
+        // A new game state for every playout keeps its running totals from overflowing
+        auto gameState = MakeGameState(_mode, _rules);
+
+        _path.clear();
+        _path.push_back(0);
+        bool isInTree = true;
+        double reward = 0.0;
+
+        for (int moveIndex = 0; moveIndex < _options.PlayoutDepth; ++moveIndex) {
+            MoveFinder::FindLegalSwaps(_board, _swaps);
+            if (_swaps.empty()) {
+                break;
+            }
+
+            LegalSwap move;
+            if (isInTree) {
+                int node = SelectChild(_path.back());
+                isInTree = _nodes[size_t(node)].Visits > 0;
+                _path.push_back(node);
+                move = _nodes[size_t(node)].Move;
+            } else {
+                move = _swaps[size_t(_random.NextInt(int(_swaps.size())))];
+            }
+
+            auto cellsToDestroy = _matchDetector.FindMatchesAfterSwap(_board, move.Source, move.Destination);
+            _board.SwapCells(move.Source, move.Destination);
+            reward += _cascadeResolver.ResolveScore(_board, _refillGenerator, std::move(cellsToDestroy), *gameState);
+        }
+
+        _bestReward = std::max(_bestReward, reward);
+
+        for (int node : _path) {
+            ++_nodes[size_t(node)].Visits;
+            _nodes[size_t(node)].TotalReward += reward;
+        }
+    }
+
+    // Picks the child of parent to play among the legal swaps of the current board. A swap that wasn't tried from parent yet
+    // gets a new child (chosen randomly if there are more), otherwise the child with the best UCB1 score is taken.
+    // A child whose move isn't legal on this playout's board is skipped, so only the visits of the legal ones count.
+    int SelectChild(int parent)
+    {
+        for (int child = _nodes[size_t(parent)].FirstChild; child != NoNode; child = _nodes[size_t(child)].NextSibling) {
+            _childBySwap[size_t(SwapKey(_nodes[size_t(child)].Move))] = child;
+        }
+
+        int untriedCount = 0;
+        uint64_t parentVisits = 0;
+        for (const auto& swap : _swaps) {
+            int child = _childBySwap[size_t(SwapKey(swap))];
+            if (child == NoNode) {
+                ++untriedCount;
+            } else {
+                parentVisits += _nodes[size_t(child)].Visits;
+            }
+        }
+
+        int selected = NoNode;
+        if (untriedCount > 0) {
+            int untriedIndex = _random.NextInt(untriedCount);
+            for (const auto& swap : _swaps) {
+                if (_childBySwap[size_t(SwapKey(swap))] == NoNode && untriedIndex-- == 0) {
+                    selected = AddChild(parent, swap);
+                    break;
+                }
+            }
+        } else {
+            double logParentVisits = std::log(double(parentVisits));
+            double bestScore = -1.0;
+
+            for (const auto& swap : _swaps) {
+                int child = _childBySwap[size_t(SwapKey(swap))];
+                const auto& node = _nodes[size_t(child)];
+                double score = node.TotalReward / (node.Visits * _bestReward)
+                    + _options.ExplorationConstant * std::sqrt(logParentVisits / node.Visits);
+                if (score > bestScore) {
+                    bestScore = score;
+                    selected = child;
+                }
+            }
+        }
+
+        for (int child = _nodes[size_t(parent)].FirstChild; child != NoNode; child = _nodes[size_t(child)].NextSibling) {
+            _childBySwap[size_t(SwapKey(_nodes[size_t(child)].Move))] = NoNode;
+        }
+
+        return selected;
+    }
+
+    int AddChild(int parent, const LegalSwap& swap)
+    {
+        int child = int(_nodes.size());
+        _nodes.push_back(Node { swap, NoNode, _nodes[size_t(parent)].FirstChild });
+        _nodes[size_t(parent)].FirstChild = child;
+
+        return child;
+    }
+};
+
+MctsPlayer::MctsPlayer(int colCount, int rowCount, int tileKindCount, GameMode mode, const GameRules& rules, const MctsOptions& options, uint64_t seed)
+    : _options(options)
+    , _seedGenerator(seed)
+    , _pool(options.ThreadCount)
+{
+    assert(options.PlayoutDepth >= 1);
+
+    for (int i = 0; i < _pool.GetThreadCount(); ++i) {
+        _searchers.push_back(std::make_unique<Searcher>(colCount, rowCount, tileKindCount, mode, rules, _options));
+    }
+}
+
+MctsPlayer::~MctsPlayer() = default;
+
+std::optional<ScoredMove> MctsPlayer::ChooseMove(const Board& board, double budgetMs)
+{
+    assert(budgetMs > 0 || _options.MaxPlayoutsPerThread > 0);
+
+    std::vector<LegalSwap> rootSwaps;
+    MoveFinder::FindLegalSwaps(board, rootSwaps);
+    if (rootSwaps.empty()) {
+        return std::nullopt;
+    }
+
+    auto start = Clock::now();
+    auto deadline = start + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double, std::milli>(budgetMs));
+    auto seed = _seedGenerator.Next();
+
+    for (size_t i = 0; i < _searchers.size(); ++i) {
+        _pool.Submit([this, &board, seed, i, deadline, budgetMs]() {
+            _searchers[i]->Search(board, seed, i, deadline, budgetMs > 0);
+        });
+    }
+    _pool.Wait();
+
+    // The root has the same legal moves in every tree, so the trees are merged by adding up the visits of every move
+    std::optional<ScoredMove> bestMove;
+    uint64_t bestVisits = 0;
+
+    for (const auto& swap : rootSwaps) {
+        uint64_t visits = 0;
+        double totalReward = 0.0;
+        for (const auto& searcher : _searchers) {
+            searcher->ForEachRootChild([&](const LegalSwap& move, uint32_t moveVisits, double moveReward) {
+                if (move.Source == swap.Source && move.Destination == swap.Destination) {
+                    visits += moveVisits;
+                    totalReward += moveReward;
+                }
+            });
+        }
+
+        if (visits > bestVisits) {
+            bestVisits = visits;
+            bestMove = ScoredMove { swap.Source, swap.Destination, totalReward / double(visits) };
+        }
+    }
+
+    _lastStats = MctsStats { 0, int(_searchers.size()), std::chrono::duration<double, std::milli>(Clock::now() - start).count() };
+    for (const auto& searcher : _searchers) {
+        _lastStats.PlayoutCount += searcher->GetPlayoutCount();
+    }
+
+    return bestMove;
+}
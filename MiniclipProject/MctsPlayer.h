@@ -0,0 +1,56 @@
+#pragma once
+
+#include "Board.h"
+#include "GameMode.h"
+#include "GameState.h"
+#include "MoveFinder.h"
+#include "RandomGenerator.h"
+#include "WorkStealingPool.h"
+
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <vector>
+
+struct MctsOptions {
+    // 0 starts a search thread for every hardware thread
+    int ThreadCount = 0;
+    // How many moves a playout makes from the board being solved, the ones chosen by the tree included
+    int PlayoutDepth = 4;
+    // The C of UCB1. The rewards are scaled by the best playout of the search, so they are between 0 and 1.
+    double ExplorationConstant = 1.0;
+    // Stops every thread after this many playouts, even if there is time left. 0 for no limit.
+    // Without a time budget the search only depends on the seed and the board.
+    uint64_t MaxPlayoutsPerThread = 0;
+};
+
+struct MctsStats {
+    uint64_t PlayoutCount = 0;
+    int ThreadCount = 0;
+    double ElapsedMs = 0.0;
+};
+
+// A Monte Carlo tree search player. Every thread grows its own tree from the same board (root parallelization),
+// and the visits of the first moves are added up at the end, so the threads never wait for each other.
+// The tiles that fall in after a move are random, so the trees are open loop: a node stands for a sequence of moves,
+// and every playout resolves them again on the board with new refills, the same way the game would.
+class MctsPlayer {
+public:
+    MctsPlayer(int colCount, int rowCount, int tileKindCount, GameMode mode, const GameRules& rules = {}, const MctsOptions& options = {}, uint64_t seed = 0);
+    ~MctsPlayer();
+
+    // Searches for budgetMs on every thread and returns the move that was played the most, or nothing if there are no legal moves.
+    // With a budget of 0 or less the search only stops at MaxPlayoutsPerThread.
+    std::optional<ScoredMove> ChooseMove(const Board& board, double budgetMs);
+
+    const MctsStats& GetLastStats() const { return _lastStats; }
+
+private:
+    class Searcher;
+
+    MctsOptions _options;
+    RandomGenerator _seedGenerator;
+    WorkStealingPool _pool;
+    std::vector<std::unique_ptr<Searcher>> _searchers;
+    MctsStats _lastStats;
+};
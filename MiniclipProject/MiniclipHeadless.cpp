@@ -0,0 +1,130 @@
+// Plays the game without a window or audio device, picking a random legal move whenever the board accepts input.
+// Usage: MiniclipHeadless [classic|quickdeath] [game count] [move limit per game] [seed] [replay file prefix]
+//        MiniclipHeadless replay <replay file>
+
+#include "Bot.h"
+#include "GameState.h"
+#include "GameWorld.h"
+#include "HeadlessSinks.h"
+#include "ReplayPlayer.h"
+#include "ReplayRecorder.h"
+
+#include <iostream>
+#include <memory>
+#include <string>
+
+namespace {
+constexpr uint64_t FrameTimeMs = 16;
+// A game that is still going after this long is stopped, it's reported separately and isn't part of the average
+constexpr uint64_t MaxGameTimeMs = 30 * 60 * 1000;
+
+int PlayReplay(const std::string& filePath)
+{
+    ReplayPlayer replayPlayer;
+    if (!replayPlayer.Open(filePath)) {
+        std::cerr << "Failed to read replay " << filePath << std::endl;
+        return 1;
+    }
+
+    const auto& header = replayPlayer.GetHeader();
+    std::cout << "Seed: " << header.Seed << std::endl;
+
+    NullRenderer renderer;
+    NullAudioSink audioSink;
+    GameWorld gameWorld(header.RowCount, header.ColCount, header.TileKindCount, renderer, audioSink, header.Seed);
+
+    auto gameState = MakeGameState(header.Mode);
+    gameWorld.Activate(*gameState, header.Seed);
+
+    int frameCount = 0;
+    while (replayPlayer.PlayFrame(gameWorld)) {
+        ++frameCount;
+    }
+
+    std::cout << "Replayed " << frameCount << " frames: ";
+    for (const auto& line : gameState->GetResult()) {
+        std::cout << line;
+    }
+    std::cout << std::endl;
+
+    auto recordedScore = replayPlayer.GetRecordedScore();
+    if (replayPlayer.GetRejectedSwitchCount() > 0 || (recordedScore && *recordedScore != gameState->GetScore())) {
+        std::cout << "Playback diverged from the recording (" << replayPlayer.GetRejectedSwitchCount() << " rejected switches, recorded score "
+                  << recordedScore.value_or(-1) << ")" << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
+}
+
+int main(int argc, char* argv[])
+{
+    if (argc > 2 && std::string(argv[1]) == "replay") {
+        return PlayReplay(argv[2]);
+    }
+
+    auto mode = (argc > 1 && std::string(argv[1]) == "quickdeath") ? GameMode::QuickDeath : GameMode::Classic;
+    int gameCount = argc > 2 ? std::stoi(argv[2]) : 10;
+    int moveLimit = argc > 3 ? std::stoi(argv[3]) : 1000;
+    uint64_t seed = argc > 4 ? std::stoull(argv[4]) : RandomGenerator::MakeSeed();
+    std::string replayPrefix = argc > 5 ? argv[5] : "";
+
+    std::cout << "Seed: " << seed << std::endl;
+
+    NullRenderer renderer;
+    NullAudioSink audioSink;
+    GameWorld gameWorld(8, 8, 5, renderer, audioSink, seed);
+    Bot bot(BotStrategy::Random, seed);
+
+    ReplayRecorder replayRecorder;
+    auto cellsSwitchedToken = gameWorld.CellsSwitched.Subscribe([&replayRecorder](Vec2 source, Vec2 destination) {
+        replayRecorder.RecordSwitch(source, destination);
+    });
+
+    std::unique_ptr<IGameState> gameState;
+    uint64_t totalScore = 0;
+    int finishedGameCount = 0;
+
+    for (int game = 0; game < gameCount; ++game) {
+        gameState = MakeGameState(mode);
+        gameWorld.Activate(*gameState);
+
+        if (!replayPrefix.empty()) {
+            auto replayPath = replayPrefix + std::to_string(game + 1) + ".replay";
+            if (!replayRecorder.Begin(replayPath, ReplayHeader { mode, gameWorld.ColCount, gameWorld.RowCount, gameWorld.TileKindCount, gameWorld.GetGameSeed() })) {
+                std::cerr << "Failed to open " << replayPath << " for writing" << std::endl;
+            }
+        }
+
+        bot.ResetMoveCount();
+        uint64_t gameTimeMs = 0;
+        while (!gameState->IsGameOver() && bot.GetMoveCount() < moveLimit && gameTimeMs < MaxGameTimeMs) {
+            bot.Update(gameWorld, FrameTimeMs);
+            gameWorld.Update(FrameTimeMs);
+            replayRecorder.RecordFrame(FrameTimeMs);
+            gameTimeMs += FrameTimeMs;
+        }
+
+        replayRecorder.End(gameState->GetScore());
+
+        std::cout << "Game " << game + 1 << " (" << bot.GetMoveCount() << " moves): ";
+        if (gameState->IsGameOver()) {
+            totalScore += gameState->GetScore();
+            ++finishedGameCount;
+
+            for (const auto& line : gameState->GetResult()) {
+                std::cout << line;
+            }
+        } else {
+            std::cout << "Stopped after " << gameTimeMs / 1000 << " s, " << (bot.GetMoveCount() < moveLimit ? "the time limit" : "the move limit") << " was reached";
+        }
+        std::cout << std::endl;
+    }
+
+    if (finishedGameCount > 0) {
+        std::cout << "Average score: " << totalScore / finishedGameCount << " (" << finishedGameCount << " of " << gameCount << " games finished)" << std::endl;
+    }
+
+    return 0;
+}
@@ -2,9 +2,29 @@
 
 #include <SDL.h>
 
-int main(int arg, char* argv[])
+#include <cctype>
+#include <optional>
+#include <string>
+
+// Usage: MiniclipProject [--replay <replay file>] [--autoplay [minutes]]
+int main(int argc, char* argv[])
 {
-    Game game;
+    std::optional<std::string> replayFilePath;
+    std::optional<AutoplayOptions> autoplayOptions;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string argument = argv[i];
+        if (argument == "--replay" && i + 1 < argc) {
+            replayFilePath = argv[++i];
+        } else if (argument == "--autoplay") {
+            autoplayOptions.emplace();
+            if (i + 1 < argc && std::isdigit(uint8_t(argv[i + 1][0]))) {
+                autoplayOptions->DurationMs = std::stoull(argv[++i]) * 60 * 1000;
+            }
+        }
+    }
+
+    Game game(replayFilePath, autoplayOptions);
     game.RunMainLoop();
 
     return 0;
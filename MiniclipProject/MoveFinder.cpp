@@ -0,0 +1,207 @@
+#include "MoveFinder.h"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+
+namespace {
+using CellPair = std::array<Vec2, 2>;
+
+// For every direction a tile can be moved in, the pairs of cells (relative to where the tile lands) that complete a run with it:
+// 2 cells further along the direction of the move, or 2 of the 3 possible cells next to it on the perpendicular axis.
+// The cell the tile came from is never part of a pair, as that will hold the other tile after the swap.
+constexpr std::array<Vec2, 4> Directions = { Vec2 { 1, 0 }, Vec2 { -1, 0 }, Vec2 { 0, 1 }, Vec2 { 0, -1 } };
+
+constexpr std::array<std::array<CellPair, 4>, 4> MakePatternTable()
+{
+    std::array<std::array<CellPair, 4>, 4> table {};
+
+    for (size_t i = 0; i < Directions.size(); ++i) {
+        auto d = Directions[i];
+        auto e = Vec2 { d.y, d.x }; // Perpendicular to the direction of the move
+
+        table[i] = {
+            CellPair { Vec2 { d.x, d.y }, Vec2 { 2 * d.x, 2 * d.y } },
+            CellPair { Vec2 { -2 * e.x, -2 * e.y }, Vec2 { -e.x, -e.y } },
+            CellPair { Vec2 { -e.x, -e.y }, Vec2 { e.x, e.y } },
+            CellPair { Vec2 { e.x, e.y }, Vec2 { 2 * e.x, 2 * e.y } },
+        };
+    }
+
+    return table;
+}
+
+constexpr auto PatternTable = MakePatternTable();
+
+int DirectionIndex(Vec2 from, Vec2 to)
+{
+    auto d = to - from;
+    return int(std::find(Directions.begin(), Directions.end(), d) - Directions.begin());
+}
+
+bool HasType(const Board& board, Vec2 index, uint8_t type)
+{
+    return board.IsIndexOnTheBoard(index) && board.Type(index) == type;
+}
+
+// Checks if the tile of the given type completes a run after being moved from -> to
+bool CompletesRun(const Board& board, Vec2 from, Vec2 to, uint8_t type)
+{
+    for (const auto& [first, second] : PatternTable[DirectionIndex(from, to)]) {
+        if (HasType(board, to + first, type) && HasType(board, to + second, type)) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+constexpr int Padding = 2;
+constexpr uint8_t OffBoard = 0xFF;
+
+// The types of the board with a border of 2 OffBoard cells around it, column major like Board,
+// so the patterns can be checked with plain offsets and without any bounds checks
+class PaddedBoard {
+public:
+    explicit PaddedBoard(const Board& board)
+        : _stride(board.GetRowCount() + 2 * Padding)
+    {
+        auto size = size_t(board.GetColCount() + 2 * Padding) * _stride;
+
+        // Boards that are played on fit on the stack, bigger ones go to the heap
+        if (size > _localTypes.size()) {
+            _heapTypes.resize(size);
+            _types = _heapTypes.data();
+        } else {
+            _types = _localTypes.data();
+        }
+
+        std::fill_n(_types, size, OffBoard);
+        for (int x = 0; x < board.GetColCount(); ++x) {
+            std::memcpy(_types + size_t(x + Padding) * _stride + Padding, board.TypeData() + size_t(x) * board.GetRowCount(), size_t(board.GetRowCount()));
+        }
+    }
+
+    int GetStride() const { return _stride; }
+    int IndexOf(Vec2 index) const { return (index.x + Padding) * _stride + index.y + Padding; }
+    uint8_t operator[](int index) const { return _types[index]; }
+
+private:
+    int _stride;
+    uint8_t* _types;
+    std::array<uint8_t, 1024> _localTypes;
+    std::vector<uint8_t> _heapTypes;
+};
+
+// Calls action for every swap of neighbouring cells that destroys something, in the same order as
+// going through the columns and rows and trying the cell to the right and then the one below. Stops when action returns false.
+template <class Action>
+void ForEachLegalSwap(const Board& board, Action&& action)
+{
+    static_assert(Directions[0] == Vec2 { 1, 0 } && Directions[1] == Vec2 { -1, 0 } && Directions[2] == Vec2 { 0, 1 } && Directions[3] == Vec2 { 0, -1 });
+
+    const PaddedBoard padded(board);
+    const int stride = padded.GetStride();
+
+    // The pattern table as offsets into the padded board
+    std::array<std::array<std::array<int, 2>, 4>, 4> offsets;
+    for (size_t direction = 0; direction < PatternTable.size(); ++direction) {
+        for (size_t pattern = 0; pattern < PatternTable[direction].size(); ++pattern) {
+            for (size_t cell = 0; cell < 2; ++cell) {
+                auto offset = PatternTable[direction][pattern][cell];
+                offsets[direction][pattern][cell] = offset.x * stride + offset.y;
+            }
+        }
+    }
+
+    auto completesRun = [&](int to, size_t direction, uint8_t type) {
+        for (const auto& [first, second] : offsets[direction]) {
+            if (padded[to + first] == type && padded[to + second] == type) {
+                return true;
+            }
+        }
+        return false;
+    };
+
+    // Moving right is direction 0 and its opposite is 1, moving down is 2 and its opposite is 3
+    const std::array<int, 2> neighbourOffsets = { stride, 1 };
+    const std::array<Vec2, 2> neighbourDeltas = { Vec2 { 1, 0 }, Vec2 { 0, 1 } };
+
+    for (int x = 0; x < board.GetColCount(); ++x) {
+        for (int y = 0; y < board.GetRowCount(); ++y) {
+            int index = padded.IndexOf(Vec2 { x, y });
+            auto type = padded[index];
+
+            for (size_t neighbour = 0; neighbour < 2; ++neighbour) {
+                int otherIndex = index + neighbourOffsets[neighbour];
+                auto otherType = padded[otherIndex];
+                if (otherType == OffBoard || otherType == type) {
+                    continue;
+                }
+
+                if (completesRun(otherIndex, 2 * neighbour, type) || completesRun(index, 2 * neighbour + 1, otherType)) {
+                    Vec2 source { x, y };
+                    if (!action(source, source + neighbourDeltas[neighbour])) {
+                        return;
+                    }
+                }
+            }
+        }
+    }
+}
+}
+
+LegalMove::LegalMove(Vec2 source, Vec2 destination, CellDestructionData&& destruction)
+    : Source(source)
+    , Destination(destination)
+    , Destruction(std::move(destruction))
+    , ComboLength(std::max(Destruction.HighestRowCombo, Destruction.HighestColumnCombo))
+{
+}
+
+bool MoveFinder::IsLegalMove(const Board& board, Vec2 source, Vec2 destination)
+{
+    assert(source.DistanceSquared(destination) == 1);
+
+    auto sourceType = board.Type(source);
+    auto destinationType = board.Type(destination);
+
+    if (sourceType == destinationType) {
+        return false;
+    }
+
+    return CompletesRun(board, source, destination, sourceType) || CompletesRun(board, destination, source, destinationType);
+}
+
+std::vector<LegalMove> MoveFinder::FindLegalMoves(const Board& board, const MatchDetector& matchDetector)
+{
+    std::vector<LegalMove> legalMoves;
+
+    ForEachLegalSwap(board, [&](Vec2 source, Vec2 destination) {
+        legalMoves.emplace_back(source, destination, matchDetector.FindMatchesAfterSwap(board, source, destination));
+        return true;
+    });
+
+    return legalMoves;
+}
+
+int MoveFinder::CountLegalMoves(const Board& board, int maxCount)
+{
+    int count = 0;
+
+    ForEachLegalSwap(board, [&](Vec2, Vec2) {
+        return ++count < maxCount;
+    });
+
+    return count;
+}
+
+void MoveFinder::FindLegalSwaps(const Board& board, std::vector<LegalSwap>& swaps)
+{
+    swaps.clear();
+
+    ForEachLegalSwap(board, [&](Vec2 source, Vec2 destination) {
+        swaps.push_back(LegalSwap { source, destination });
+        return true;
+    });
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+#include "Board.h"
+#include "MatchDetector.h"
+#include "Vec2.h"
+
+#include <climits>
+#include <vector>
+
+struct LegalMove {
+    LegalMove(Vec2 source, Vec2 destination, CellDestructionData&& destruction);
+
+    Vec2 Source;
+    Vec2 Destination;
+    CellDestructionData Destruction;
+    int ComboLength;
+};
+
+// A legal move without the cells it destroys, for searches that pick moves faster than they could score all of them
+struct LegalSwap {
+    Vec2 Source;
+    Vec2 Destination;
+};
+
+struct ScoredMove {
+    Vec2 Source;
+    Vec2 Destination;
+    // What a search expects the move (and the moves it looked at after it) to earn: points in Classic, milliseconds in QuickDeath
+    double ExpectedValue;
+};
+
+// Finds the swaps that would destroy cells, without modifying the board.
+// Candidates are filtered with a precomputed table of the shapes a single swap can complete,
+// so only the actual legal moves need a scan of their rows and columns.
+class MoveFinder {
+public:
+    static bool IsLegalMove(const Board& board, Vec2 source, Vec2 destination);
+    static std::vector<LegalMove> FindLegalMoves(const Board& board, const MatchDetector& matchDetector);
+    static int CountLegalMoves(const Board& board, int maxCount = INT_MAX);
+    // The same moves in the same order as FindLegalMoves. swaps is cleared first, so a buffer can be reused between boards.
+    static void FindLegalSwaps(const Board& board, std::vector<LegalSwap>& swaps);
+};
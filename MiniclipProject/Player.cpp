@@ -42,7 +42,7 @@ void Player::OnMouseClicked(Vec2 clickedCoordinates)
             _gameWorld->TrySwitchCells(cell, *newSelectedCell);
         }
 
-    } else if (auto newSelectedCell = _gameWorld->GetTileIndicesAtPoint(clickedCoordinates)) {
+    } else if (auto newSelectedCell = _gameWorld->GetTileIndicesAtPoint(clickedCoordinates); newSelectedCell && !_gameWorld->IsCellInMotion(*newSelectedCell)) {
         _selectedCell.emplace(clickedCoordinates, *newSelectedCell, *_gameWorld, false);
     }
 }
@@ -57,7 +57,8 @@ void Player::OnTileDragCompleted(Vec2 source)
 void Player::OnMouseDragStarted(Vec2 clickedCoordinates)
 {
     auto draggedCell = _gameWorld->GetTileIndicesAtPoint(clickedCoordinates);
-    if (draggedCell) {
+    // The cells of a cascade that is still playing can't be picked up, the rest of the board can
+    if (draggedCell && !_gameWorld->IsCellInMotion(*draggedCell)) {
         _selectedCell.emplace(clickedCoordinates, *draggedCell, *_gameWorld, true);
     }
 }
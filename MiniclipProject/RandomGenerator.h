@@ -0,0 +1,145 @@
+#pragma once
+
+#include <array>
+#include <cassert>
+#include <cstdint>
+#include <random>
+
+// xoshiro256** (https://prng.di.unimi.it/). 32 bytes of state, so it is cheap to copy and snapshot.
+// Only integer arithmetic is used, so the same seed gives the same numbers on every machine.
+class RandomGenerator {
+public:
+    explicit RandomGenerator(uint64_t seed = 0, uint64_t stream = 0)
+    {
+        Seed(seed, stream);
+    }
+
+    // A non-deterministic seed, for when the game doesn't have to be reproducible
+    static uint64_t MakeSeed()
+    {
+        std::random_device randomDevice;
+        return (uint64_t(randomDevice()) << 32) | randomDevice();
+    }
+
+    // Different streams of the same seed give independent sequences
+    void Seed(uint64_t seed, uint64_t stream = 0)
+    {
+        uint64_t splitMixState = seed ^ (stream * 0xD1B54A32D192ED03ull);
+        for (auto& word : _state) {
+            word = SplitMix64(splitMixState);
+        }
+    }
+
+    RandomGenerator Split(uint64_t stream) const
+    {
+        RandomGenerator copy = *this;
+        return RandomGenerator(copy.Next(), stream);
+    }
+
+    uint64_t Next()
+    {
+        const uint64_t result = RotateLeft(_state[1] * 5, 7) * 9;
+        const uint64_t t = _state[1] << 17;
+
+        _state[2] ^= _state[0];
+        _state[3] ^= _state[1];
+        _state[1] ^= _state[2];
+        _state[0] ^= _state[3];
+        _state[2] ^= t;
+        _state[3] = RotateLeft(_state[3], 45);
+
+        return result;
+    }
+
+    // Uniform in [0, bound), without the bias of a plain modulo (Lemire's multiply and reject)
+    int NextInt(int bound)
+    {
+        assert(bound > 0);
+
+        auto range = uint32_t(bound);
+        uint64_t product = uint64_t(uint32_t(Next() >> 32)) * range;
+        auto low = uint32_t(product);
+
+        if (low < range) {
+            uint32_t threshold = uint32_t(-range) % range;
+            while (low < threshold) {
+                product = uint64_t(uint32_t(Next() >> 32)) * range;
+                low = uint32_t(product);
+            }
+        }
+
+        return int(product >> 32);
+    }
+
+    // The same numbers as count calls to NextInt. The rejection threshold needs a division, so it's only computed
+    // the first time a value falls into the range where it's needed, and then shared by the rest of the batch.
+    void NextInts(int bound, uint8_t* values, int count)
+    {
+        assert(bound > 0 && bound <= 256);
+
+        auto range = uint32_t(bound);
+        uint32_t threshold = 0;
+        bool hasThreshold = false;
+
+        for (int i = 0; i < count; ++i) {
+            uint64_t product = uint64_t(uint32_t(Next() >> 32)) * range;
+
+            if (uint32_t(product) < range) {
+                if (!hasThreshold) {
+                    threshold = uint32_t(-range) % range;
+                    hasThreshold = true;
+                }
+                while (uint32_t(product) < threshold) {
+                    product = uint64_t(uint32_t(Next() >> 32)) * range;
+                }
+            }
+
+            values[i] = uint8_t(product >> 32);
+        }
+    }
+
+    // Uniform in [0, bound) without the excluded values. Values outside of the range (eg. -1) are ignored.
+    int NextIntExcluding(int bound, std::array<int, 2> excluded)
+    {
+        if (excluded[0] > excluded[1]) {
+            std::swap(excluded[0], excluded[1]);
+        }
+        if (excluded[0] == excluded[1] || excluded[0] < 0 || excluded[0] >= bound) {
+            excluded[0] = -1;
+        }
+        if (excluded[1] < 0 || excluded[1] >= bound) {
+            excluded[1] = -1;
+        }
+
+        int allowedCount = bound - (excluded[0] >= 0) - (excluded[1] >= 0);
+        int result = NextInt(allowedCount);
+
+        // Skip over the excluded values, going from the lowest to the highest
+        for (int value : excluded) {
+            if (value >= 0 && result >= value) {
+                ++result;
+            }
+        }
+
+        return result;
+    }
+
+    const std::array<uint64_t, 4>& GetState() const { return _state; }
+    void SetState(const std::array<uint64_t, 4>& state) { _state = state; }
+
+private:
+    std::array<uint64_t, 4> _state;
+
+    static uint64_t RotateLeft(uint64_t x, int k)
+    {
+        return (x << k) | (x >> (64 - k));
+    }
+
+    static uint64_t SplitMix64(uint64_t& state)
+    {
+        uint64_t z = (state += 0x9E3779B97F4A7C15ull);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        return z ^ (z >> 31);
+    }
+};
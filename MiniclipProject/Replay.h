@@ -0,0 +1,36 @@
+#pragma once
+
+#include "GameMode.h"
+
+#include <cstdint>
+
+// Replay files start with the header, followed by a stream of records:
+// - A byte below 0x80 is a frame, the byte itself is the frame time in ms
+// - Otherwise the byte is one of the RecordType values, followed by its data
+// Numbers are stored as LEB128 varints, so most records only take a few bytes.
+
+struct ReplayHeader {
+    static constexpr uint32_t Magic = 0x50524A42; // "BJRP"
+    static constexpr uint8_t CurrentVersion = 4;
+    // Replays of boards outside these limits are turned away when they're read, they couldn't be played back
+    static constexpr int MinBoardSize = 3;
+    static constexpr int MaxBoardSize = 64;
+    static constexpr int MinTileKindCount = 3;
+    static constexpr int MaxTileKindCount = 8;
+
+    GameMode Mode = GameMode::Classic;
+    int ColCount = 0;
+    int RowCount = 0;
+    int TileKindCount = 0;
+    uint64_t Seed = 0;
+};
+
+enum class ReplayRecordType : uint8_t {
+    ShortFrameLimit = 0x80, // Frame times below this are stored in the record type byte itself
+    Frame = 0x80, // varint frame time
+    Switch = 0x81, // varint x, varint y, direction byte
+    Pause = 0x82,
+    Resume = 0x83,
+    End = 0x84, // varint score
+    SkipAnimations = 0x85,
+};
@@ -0,0 +1,175 @@
+#include "ReplayPlayer.h"
+
+#include "GameWorld.h"
+
+#include <array>
+#include <fstream>
+#include <iterator>
+
+namespace {
+constexpr std::array<Vec2, 4> SwitchDirections = { Vec2 { 1, 0 }, Vec2 { -1, 0 }, Vec2 { 0, 1 }, Vec2 { 0, -1 } };
+}
+
+bool ReplayPlayer::Open(const std::string& filePath)
+{
+    std::ifstream in(filePath, std::ios::binary);
+    if (!in) {
+        return false;
+    }
+
+    return Load(std::vector<uint8_t>(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>()));
+}
+
+bool ReplayPlayer::Load(std::vector<uint8_t>&& data)
+{
+    _data = std::move(data);
+    _position = 0;
+    _recordedScore.reset();
+    _rejectedSwitchCount = 0;
+
+    return ReadHeader();
+}
+
+const ReplayHeader& ReplayPlayer::GetHeader() const
+{
+    return _header;
+}
+
+bool ReplayPlayer::PlayFrame(GameWorld& gameWorld)
+{
+    uint8_t recordType;
+    while (ReadByte(recordType)) {
+        if (recordType < uint8_t(ReplayRecordType::ShortFrameLimit)) {
+            gameWorld.Update(recordType);
+            return true;
+        }
+
+        switch (ReplayRecordType(recordType)) {
+        case ReplayRecordType::Frame: {
+            uint64_t deltaTimeMs;
+            if (!ReadVarint(deltaTimeMs)) {
+                return false;
+            }
+            gameWorld.Update(deltaTimeMs);
+            return true;
+        }
+        case ReplayRecordType::Switch: {
+            uint64_t x, y;
+            uint8_t direction;
+            if (!ReadVarint(x) || !ReadVarint(y) || !ReadByte(direction) || direction >= SwitchDirections.size()) {
+                return false;
+            }
+
+            Vec2 source { int(x), int(y) };
+            Vec2 destination = source + SwitchDirections[direction];
+            if (!gameWorld.IsInteractionEnabled() || !gameWorld.IsIndexOnTheBoard(source) || !gameWorld.IsIndexOnTheBoard(destination) || !gameWorld.TrySwitchCells(source, destination)) {
+                ++_rejectedSwitchCount;
+            }
+        } break;
+        case ReplayRecordType::SkipAnimations: {
+            // Skipping lets the next switch happen earlier, so it has to be played back as well
+            gameWorld.SkipAnimations();
+        } break;
+        case ReplayRecordType::Pause:
+        case ReplayRecordType::Resume: {
+            // Time doesn't pass while the game is paused, so these don't change the outcome
+        } break;
+        case ReplayRecordType::End: {
+            uint64_t score;
+            if (ReadVarint(score)) {
+                _recordedScore = int(score);
+            }
+            return false;
+        }
+        default:
+            return false;
+        }
+    }
+
+    return false;
+}
+
+std::optional<int> ReplayPlayer::GetRecordedScore() const
+{
+    return _recordedScore;
+}
+
+int ReplayPlayer::GetRejectedSwitchCount() const
+{
+    return _rejectedSwitchCount;
+}
+
+bool ReplayPlayer::ReadByte(uint8_t& value)
+{
+    if (_position >= _data.size()) {
+        return false;
+    }
+
+    value = _data[_position++];
+    return true;
+}
+
+bool ReplayPlayer::ReadVarint(uint64_t& value)
+{
+    value = 0;
+
+    for (int shift = 0; shift < 64; shift += 7) {
+        uint8_t byte;
+        if (!ReadByte(byte)) {
+            return false;
+        }
+
+        value |= uint64_t(byte & 0x7F) << shift;
+        if ((byte & 0x80) == 0) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+bool ReplayPlayer::ReadHeader()
+{
+    _header = {};
+
+    uint32_t magic = 0;
+    for (int i = 0; i < 4; ++i) {
+        uint8_t byte;
+        if (!ReadByte(byte)) {
+            return false;
+        }
+        magic |= uint32_t(byte) << (8 * i);
+    }
+
+    uint8_t version, mode;
+    if (magic != ReplayHeader::Magic || !ReadByte(version) || version != ReplayHeader::CurrentVersion || !ReadByte(mode) || mode > uint8_t(GameMode::QuickDeath)) {
+        return false;
+    }
+
+    uint64_t colCount, rowCount, tileKindCount;
+    if (!ReadVarint(colCount) || !ReadVarint(rowCount) || !ReadVarint(tileKindCount)) {
+        return false;
+    }
+
+    auto isBoardSize = [](uint64_t size) { return size >= ReplayHeader::MinBoardSize && size <= ReplayHeader::MaxBoardSize; };
+    if (!isBoardSize(colCount) || !isBoardSize(rowCount) || tileKindCount < ReplayHeader::MinTileKindCount || tileKindCount > ReplayHeader::MaxTileKindCount) {
+        return false;
+    }
+
+    uint64_t seed = 0;
+    for (int i = 0; i < 8; ++i) {
+        uint8_t byte;
+        if (!ReadByte(byte)) {
+            return false;
+        }
+        seed |= uint64_t(byte) << (8 * i);
+    }
+
+    _header.Mode = GameMode(mode);
+    _header.ColCount = int(colCount);
+    _header.RowCount = int(rowCount);
+    _header.TileKindCount = int(tileKindCount);
+    _header.Seed = seed;
+
+    return true;
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+#include "Replay.h"
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+class GameWorld;
+
+// Drives a GameWorld from a recorded replay instead of the player's input.
+// The world has to be activated with a game state of the recorded mode and with the recorded seed before playing.
+class ReplayPlayer {
+public:
+    // Both return false if the data isn't a replay of the current version, or its header describes a game that can't be played
+    bool Open(const std::string& filePath);
+    bool Load(std::vector<uint8_t>&& data);
+
+    const ReplayHeader& GetHeader() const;
+
+    // Applies the recorded switches of the next frame, then updates the world with the recorded frame time.
+    // Returns false once there are no more frames
+    bool PlayFrame(GameWorld& gameWorld);
+
+    // Only known after the last frame has been played, and only if the recording was finished
+    std::optional<int> GetRecordedScore() const;
+    // Switches that the world refused, meaning that the playback diverged from the recording
+    int GetRejectedSwitchCount() const;
+
+private:
+    std::vector<uint8_t> _data;
+    size_t _position = 0;
+    ReplayHeader _header;
+    std::optional<int> _recordedScore;
+    int _rejectedSwitchCount = 0;
+
+    bool ReadByte(uint8_t& value);
+    bool ReadVarint(uint64_t& value);
+    bool ReadHeader();
+};
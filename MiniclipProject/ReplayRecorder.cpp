@@ -0,0 +1,144 @@
+#include "ReplayRecorder.h"
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+
+namespace {
+constexpr std::array<Vec2, 4> SwitchDirections = { Vec2 { 1, 0 }, Vec2 { -1, 0 }, Vec2 { 0, 1 }, Vec2 { 0, -1 } };
+}
+
+ReplayRecorder::~ReplayRecorder()
+{
+    Flush();
+}
+
+bool ReplayRecorder::Begin(const std::string& filePath, const ReplayHeader& header)
+{
+    if (_out.is_open()) {
+        Flush();
+        _out.close();
+    }
+
+    _buffer.clear();
+    _buffer.reserve(FlushThreshold * 2);
+
+    _out.open(filePath, std::ios::binary | std::ios::trunc);
+    if (!_out) {
+        return false;
+    }
+
+    for (int i = 0; i < 4; ++i) {
+        WriteByte(uint8_t(ReplayHeader::Magic >> (8 * i)));
+    }
+    WriteByte(ReplayHeader::CurrentVersion);
+    WriteByte(uint8_t(header.Mode));
+    WriteVarint(header.ColCount);
+    WriteVarint(header.RowCount);
+    WriteVarint(header.TileKindCount);
+    for (int i = 0; i < 8; ++i) {
+        WriteByte(uint8_t(header.Seed >> (8 * i)));
+    }
+
+    Flush();
+
+    return bool(_out);
+}
+
+void ReplayRecorder::End(int score)
+{
+    if (!IsRecording()) {
+        return;
+    }
+
+    WriteByte(uint8_t(ReplayRecordType::End));
+    WriteVarint(uint64_t(score));
+
+    Flush();
+    _out.close();
+}
+
+bool ReplayRecorder::IsRecording() const
+{
+    return _out.is_open();
+}
+
+void ReplayRecorder::RecordFrame(uint64_t deltaTimeMs)
+{
+    if (!IsRecording()) {
+        return;
+    }
+
+    if (deltaTimeMs < uint64_t(ReplayRecordType::ShortFrameLimit)) {
+        WriteByte(uint8_t(deltaTimeMs));
+    } else {
+        WriteByte(uint8_t(ReplayRecordType::Frame));
+        WriteVarint(deltaTimeMs);
+    }
+
+    if (_buffer.size() >= FlushThreshold) {
+        Flush();
+    }
+}
+
+void ReplayRecorder::RecordSwitch(Vec2 source, Vec2 destination)
+{
+    if (!IsRecording()) {
+        return;
+    }
+
+    auto direction = std::find(SwitchDirections.begin(), SwitchDirections.end(), destination - source);
+    assert(direction != SwitchDirections.end());
+
+    WriteByte(uint8_t(ReplayRecordType::Switch));
+    WriteVarint(uint64_t(source.x));
+    WriteVarint(uint64_t(source.y));
+    WriteByte(uint8_t(direction - SwitchDirections.begin()));
+}
+
+void ReplayRecorder::RecordPause()
+{
+    if (IsRecording()) {
+        WriteByte(uint8_t(ReplayRecordType::Pause));
+        // Write everything out while the game is paused, so nothing is lost if the game is closed from the menu
+        Flush();
+    }
+}
+
+void ReplayRecorder::RecordResume()
+{
+    if (IsRecording()) {
+        WriteByte(uint8_t(ReplayRecordType::Resume));
+    }
+}
+
+void ReplayRecorder::RecordSkipAnimations()
+{
+    if (IsRecording()) {
+        WriteByte(uint8_t(ReplayRecordType::SkipAnimations));
+    }
+}
+
+void ReplayRecorder::WriteByte(uint8_t value)
+{
+    _buffer.push_back(value);
+}
+
+void ReplayRecorder::WriteVarint(uint64_t value)
+{
+    while (value >= 0x80) {
+        _buffer.push_back(uint8_t(value | 0x80));
+        value >>= 7;
+    }
+    _buffer.push_back(uint8_t(value));
+}
+
+void ReplayRecorder::Flush()
+{
+    if (_out.is_open() && !_buffer.empty()) {
+        _out.write(reinterpret_cast<const char*>(_buffer.data()), std::streamsize(_buffer.size()));
+        _out.flush();
+    }
+
+    _buffer.clear();
+}
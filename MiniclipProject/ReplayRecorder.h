@@ -0,0 +1,36 @@
+#pragma once
+
+#include "Replay.h"
+#include "Vec2.h"
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+// Streams the seed and the player's actions of a game to disk, so the game can be played back exactly.
+// Records are collected in memory and written in blocks, so recording a frame is just a few byte appends.
+class ReplayRecorder {
+public:
+    ~ReplayRecorder();
+
+    bool Begin(const std::string& filePath, const ReplayHeader& header);
+    void End(int score);
+    bool IsRecording() const;
+
+    void RecordFrame(uint64_t deltaTimeMs);
+    void RecordSwitch(Vec2 source, Vec2 destination);
+    void RecordPause();
+    void RecordResume();
+    void RecordSkipAnimations();
+
+private:
+    static constexpr size_t FlushThreshold = 4096;
+
+    std::ofstream _out;
+    std::vector<uint8_t> _buffer;
+
+    void WriteByte(uint8_t value);
+    void WriteVarint(uint64_t value);
+    void Flush();
+};
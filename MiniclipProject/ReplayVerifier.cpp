@@ -0,0 +1,49 @@
+#include "ReplayVerifier.h"
+
+ReplayVerification ReplayVerifier::Verify(std::vector<uint8_t>&& replay)
+{
+    ReplayVerification verification;
+
+    if (!_replayPlayer.Load(std::move(replay)) || !IsSupported(_replayPlayer.GetHeader())) {
+        return verification;
+    }
+
+    const auto& header = _replayPlayer.GetHeader();
+
+    // The previous state is kept until the world has switched over, so the new one can't get its address.
+    // The world only starts a new board if the state is a different object.
+    auto gameState = MakeGameState(header.Mode);
+    _gameWorld.Activate(*gameState, header.Seed);
+    _gameState = std::move(gameState);
+
+    while (!_gameState->IsGameOver() && _replayPlayer.PlayFrame(_gameWorld)) {
+        if (++verification.FrameCount > MaxFrameCount || _gameState->GetValues().TimePassedMs > MaxGameTimeMs) {
+            verification.Verdict = ReplayVerdict::TooLong;
+            return verification;
+        }
+    }
+
+    verification.SimulatedScore = _gameState->GetScore();
+
+    if (_replayPlayer.GetRejectedSwitchCount() > 0) {
+        verification.Verdict = ReplayVerdict::RejectedSwitch;
+        return verification;
+    }
+
+    // The game records its end on the frame it's over, so the end has to be the very next record
+    if (!_gameState->IsGameOver() || _replayPlayer.PlayFrame(_gameWorld) || !_replayPlayer.GetRecordedScore()) {
+        verification.Verdict = ReplayVerdict::NotFinished;
+        return verification;
+    }
+
+    verification.RecordedScore = *_replayPlayer.GetRecordedScore();
+    verification.Verdict = verification.RecordedScore == verification.SimulatedScore ? ReplayVerdict::Verified : ReplayVerdict::ScoreMismatch;
+
+    return verification;
+}
+
+bool ReplayVerifier::IsSupported(const ReplayHeader& header)
+{
+    return (header.Mode == GameMode::Classic || header.Mode == GameMode::QuickDeath)
+        && header.ColCount == ColCount && header.RowCount == RowCount && header.TileKindCount == TileKindCount;
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+#include "GameState.h"
+#include "GameWorld.h"
+#include "HeadlessSinks.h"
+#include "ReplayPlayer.h"
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+enum class ReplayVerdict {
+    Verified,
+    ScoreMismatch, // The game was played to the end, but the recorded score isn't what it gave
+    RejectedSwitch, // A recorded switch wasn't possible on the board, so the recording doesn't belong to this seed
+    NotFinished, // The recording ends before the game is over, or doesn't end when it's over
+    TooLong,
+    InvalidReplay, // Not a replay, or one that wasn't played on the board the game ships with
+};
+
+struct ReplayVerification {
+    ReplayVerdict Verdict = ReplayVerdict::InvalidReplay;
+    int RecordedScore = 0;
+    int SimulatedScore = 0;
+    int FrameCount = 0;
+};
+
+// Plays recorded games again with the same rules as the game, to check the score they claim before it goes on the
+// leaderboard. The game world is kept between replays, so one verifier per thread can go through them one after the
+// other without setting up a new board every time.
+class ReplayVerifier {
+public:
+    // The leaderboard only has scores from the game's own board. Anything else is a different (and maybe much easier)
+    // game, so the header isn't trusted to set up the board.
+    static constexpr int ColCount = 8;
+    static constexpr int RowCount = 8;
+    static constexpr int TileKindCount = 5;
+    // Limits how much work a single replay can cause
+    static constexpr uint64_t MaxGameTimeMs = 60 * 60 * 1000;
+    static constexpr int MaxFrameCount = 1000000;
+
+    ReplayVerification Verify(std::vector<uint8_t>&& replay);
+
+private:
+    NullRenderer _renderer;
+    NullAudioSink _audioSink;
+    ReplayPlayer _replayPlayer;
+    GameWorld _gameWorld { RowCount, ColCount, TileKindCount, _renderer, _audioSink, 0 };
+    std::unique_ptr<IGameState> _gameState;
+
+    static bool IsSupported(const ReplayHeader& header);
+};
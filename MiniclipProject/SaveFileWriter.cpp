@@ -0,0 +1,96 @@
+#include "SaveFileWriter.h"
+
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+
+SaveFileWriter::SaveFileWriter(std::string filePath)
+    : _filePath(std::move(filePath))
+    , _thread([this]() { Run(); })
+{
+}
+
+SaveFileWriter::~SaveFileWriter()
+{
+    {
+        std::lock_guard lock(_mutex);
+        _shouldStop = true;
+    }
+    _condition.notify_all();
+    _thread.join();
+}
+
+void SaveFileWriter::Write(std::vector<uint8_t>&& data)
+{
+    Submit(Request { std::move(data) });
+}
+
+void SaveFileWriter::Remove()
+{
+    Submit(Request {});
+}
+
+void SaveFileWriter::Wait()
+{
+    std::unique_lock lock(_mutex);
+    _condition.wait(lock, [this]() { return !_pendingRequest && !_isWriting; });
+}
+
+void SaveFileWriter::Submit(Request&& request)
+{
+    {
+        std::lock_guard lock(_mutex);
+        _pendingRequest = std::move(request);
+    }
+    _condition.notify_all();
+}
+
+void SaveFileWriter::Run()
+{
+    std::unique_lock lock(_mutex);
+
+    while (true) {
+        _condition.wait(lock, [this]() { return _pendingRequest || _shouldStop; });
+
+        // The last request is still written when stopping, so nothing is lost on quit
+        if (!_pendingRequest) {
+            return;
+        }
+
+        auto request = std::move(*_pendingRequest);
+        _pendingRequest.reset();
+        _isWriting = true;
+
+        lock.unlock();
+        Execute(request);
+        lock.lock();
+
+        _isWriting = false;
+        _condition.notify_all();
+    }
+}
+
+void SaveFileWriter::Execute(const Request& request)
+{
+    std::error_code error;
+
+    if (!request.Data) {
+        std::filesystem::remove(_filePath, error);
+        return;
+    }
+
+    auto temporaryFilePath = _filePath + ".tmp";
+    {
+        std::ofstream out(temporaryFilePath, std::ios::binary | std::ios::trunc);
+        out.write(reinterpret_cast<const char*>(request.Data->data()), std::streamsize(request.Data->size()));
+        if (!out) {
+            std::cerr << "Failed to write " << temporaryFilePath << std::endl;
+            return;
+        }
+    }
+
+    std::filesystem::rename(temporaryFilePath, _filePath, error);
+    if (error) {
+        std::cerr << "Failed to replace " << _filePath << ": " << error.message() << std::endl;
+    }
+}
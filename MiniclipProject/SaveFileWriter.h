@@ -0,0 +1,45 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Writes a file on its own thread, so saving never holds up a frame. Only the newest request matters,
+// one that hasn't been started yet is replaced by the next. The file is written next to the target and
+// then renamed over it, so a crash in the middle of a write leaves the previous version in place.
+class SaveFileWriter {
+public:
+    explicit SaveFileWriter(std::string filePath);
+    // Finishes the last request before returning
+    ~SaveFileWriter();
+
+    SaveFileWriter(const SaveFileWriter&) = delete;
+    SaveFileWriter& operator=(const SaveFileWriter&) = delete;
+
+    void Write(std::vector<uint8_t>&& data);
+    void Remove();
+    // Blocks until every request so far is on disk
+    void Wait();
+
+private:
+    struct Request {
+        // Without data, the file is removed
+        std::optional<std::vector<uint8_t>> Data;
+    };
+
+    std::string _filePath;
+    std::mutex _mutex;
+    std::condition_variable _condition;
+    std::optional<Request> _pendingRequest;
+    bool _isWriting = false;
+    bool _shouldStop = false;
+    std::thread _thread;
+
+    void Submit(Request&& request);
+    void Run();
+    void Execute(const Request& request);
+};
@@ -0,0 +1,247 @@
+#include "SaveState.h"
+
+#include <fstream>
+
+namespace {
+size_t GetPackedSize(int cellCount)
+{
+    return (size_t(cellCount) * SaveState::BitsPerCell + 7) / 8;
+}
+
+void WriteVarint(std::vector<uint8_t>& out, uint64_t value)
+{
+    while (value >= 0x80) {
+        out.push_back(uint8_t(value | 0x80));
+        value >>= 7;
+    }
+    out.push_back(uint8_t(value));
+}
+
+void WriteSignedVarint(std::vector<uint8_t>& out, int64_t value)
+{
+    WriteVarint(out, (uint64_t(value) << 1) ^ uint64_t(value >> 63));
+}
+
+void WriteWord(std::vector<uint8_t>& out, uint64_t value)
+{
+    for (int i = 0; i < 8; ++i) {
+        out.push_back(uint8_t(value >> (8 * i)));
+    }
+}
+
+class Reader {
+public:
+    explicit Reader(std::span<const uint8_t> data)
+        : _data(data)
+    {
+    }
+
+    bool ReadByte(uint8_t& value)
+    {
+        if (_position >= _data.size()) {
+            return false;
+        }
+        value = _data[_position++];
+        return true;
+    }
+
+    bool ReadVarint(uint64_t& value)
+    {
+        value = 0;
+        for (int shift = 0; shift < 64; shift += 7) {
+            uint8_t byte;
+            if (!ReadByte(byte)) {
+                return false;
+            }
+            value |= uint64_t(byte & 0x7F) << shift;
+            if ((byte & 0x80) == 0) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    bool ReadSignedVarint(int64_t& value)
+    {
+        uint64_t encoded;
+        if (!ReadVarint(encoded)) {
+            return false;
+        }
+        value = int64_t(encoded >> 1) ^ -int64_t(encoded & 1);
+        return true;
+    }
+
+    bool ReadWord(uint64_t& value)
+    {
+        value = 0;
+        for (int i = 0; i < 8; ++i) {
+            uint8_t byte;
+            if (!ReadByte(byte)) {
+                return false;
+            }
+            value |= uint64_t(byte) << (8 * i);
+        }
+        return true;
+    }
+
+    std::span<const uint8_t> GetRest() const { return _data.subspan(_position); }
+
+private:
+    std::span<const uint8_t> _data;
+    size_t _position = 0;
+};
+}
+
+void SaveState::PackBoard(const Board& board)
+{
+    PackedTiles.assign(GetPackedSize(board.GetCellCount()), 0);
+
+    const auto* types = board.TypeData();
+    const auto* states = board.StateData();
+    for (int i = 0; i < board.GetCellCount(); ++i) {
+        uint32_t tile = states[i] == CellState::Destroyed ? DestroyedType : types[i];
+        size_t bit = size_t(i) * BitsPerCell;
+
+        // A cell can be split between 2 bytes
+        PackedTiles[bit / 8] |= uint8_t(tile << (bit % 8));
+        if (bit % 8 > 8 - BitsPerCell) {
+            PackedTiles[bit / 8 + 1] |= uint8_t(tile >> (8 - bit % 8));
+        }
+    }
+}
+
+bool SaveState::UnpackBoard(Board& board) const
+{
+    if (board.GetColCount() != ColCount || board.GetRowCount() != RowCount || PackedTiles.size() != GetPackedSize(board.GetCellCount())) {
+        return false;
+    }
+
+    auto* types = board.TypeData();
+    auto* states = board.StateData();
+    for (int i = 0; i < board.GetCellCount(); ++i) {
+        size_t bit = size_t(i) * BitsPerCell;
+        uint32_t bits = PackedTiles[bit / 8];
+        if (bit / 8 + 1 < PackedTiles.size()) {
+            bits |= uint32_t(PackedTiles[bit / 8 + 1]) << 8;
+        }
+
+        auto tile = uint8_t((bits >> (bit % 8)) & DestroyedType);
+        if (tile == DestroyedType) {
+            types[i] = 0;
+            states[i] = CellState::Destroyed;
+        } else if (tile < TileKindCount) {
+            types[i] = tile;
+            states[i] = CellState::Normal;
+        } else {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+std::vector<uint8_t> SaveState::Serialize() const
+{
+    std::vector<uint8_t> out;
+    out.reserve(80 + PackedTiles.size());
+
+    for (int i = 0; i < 4; ++i) {
+        out.push_back(uint8_t(Magic >> (8 * i)));
+    }
+    out.push_back(CurrentVersion);
+    out.push_back(uint8_t(Mode));
+    WriteVarint(out, uint64_t(ColCount));
+    WriteVarint(out, uint64_t(RowCount));
+    WriteVarint(out, uint64_t(TileKindCount));
+    WriteVarint(out, uint64_t(CascadeDepth));
+    WriteWord(out, GameSeed);
+    for (auto word : RandomState) {
+        WriteWord(out, word);
+    }
+    WriteVarint(out, Values.TimePassedMs);
+    WriteSignedVarint(out, Values.Score);
+    WriteSignedVarint(out, Values.TimeLeftMs);
+    out.insert(out.end(), PackedTiles.begin(), PackedTiles.end());
+
+    return out;
+}
+
+std::optional<SaveState> SaveState::Deserialize(std::span<const uint8_t> data)
+{
+    Reader reader(data);
+    SaveState saveState;
+
+    uint32_t magic = 0;
+    for (int i = 0; i < 4; ++i) {
+        uint8_t byte;
+        if (!reader.ReadByte(byte)) {
+            return std::nullopt;
+        }
+        magic |= uint32_t(byte) << (8 * i);
+    }
+
+    uint8_t version, mode;
+    if (magic != Magic || !reader.ReadByte(version) || version != CurrentVersion || !reader.ReadByte(mode) || mode > uint8_t(GameMode::QuickDeath)) {
+        return std::nullopt;
+    }
+    saveState.Mode = GameMode(mode);
+
+    uint64_t colCount, rowCount, tileKindCount, cascadeDepth, timePassedMs;
+    int64_t score, timeLeftMs;
+    if (!reader.ReadVarint(colCount) || !reader.ReadVarint(rowCount) || !reader.ReadVarint(tileKindCount) || !reader.ReadVarint(cascadeDepth)
+        || !reader.ReadWord(saveState.GameSeed)) {
+        return std::nullopt;
+    }
+    for (auto& word : saveState.RandomState) {
+        if (!reader.ReadWord(word)) {
+            return std::nullopt;
+        }
+    }
+    if (!reader.ReadVarint(timePassedMs) || !reader.ReadSignedVarint(score) || !reader.ReadSignedVarint(timeLeftMs)) {
+        return std::nullopt;
+    }
+
+    // The board sizes are checked against the world when the state is restored, this only rules out nonsense
+    if (colCount == 0 || rowCount == 0 || colCount > 0xFFFF || rowCount > 0xFFFF || tileKindCount == 0 || tileKindCount > MaxTileKindCount) {
+        return std::nullopt;
+    }
+    // xoshiro never leaves the all zero state, so it can't be valid
+    if (saveState.RandomState == std::array<uint64_t, 4> {}) {
+        return std::nullopt;
+    }
+
+    saveState.ColCount = int(colCount);
+    saveState.RowCount = int(rowCount);
+    saveState.TileKindCount = int(tileKindCount);
+    saveState.CascadeDepth = int(cascadeDepth);
+    saveState.Values = GameStateValues { timePassedMs, int(score), int(timeLeftMs) };
+
+    auto packedTiles = reader.GetRest();
+    if (packedTiles.size() != GetPackedSize(saveState.ColCount * saveState.RowCount)) {
+        return std::nullopt;
+    }
+    saveState.PackedTiles.assign(packedTiles.begin(), packedTiles.end());
+
+    return saveState;
+}
+
+std::optional<SaveState> SaveState::ReadFile(const std::string& filePath)
+{
+    std::ifstream in(filePath, std::ios::binary | std::ios::ate);
+    if (!in) {
+        return std::nullopt;
+    }
+
+    auto size = in.tellg();
+    if (size <= 0) {
+        return std::nullopt;
+    }
+
+    std::vector<uint8_t> data(size_t(size), 0);
+    in.seekg(0);
+    if (!in.read(reinterpret_cast<char*>(data.data()), std::streamsize(data.size()))) {
+        return std::nullopt;
+    }
+
+    return Deserialize(data);
+}
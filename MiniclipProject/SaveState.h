@@ -0,0 +1,44 @@
+#pragma once
+
+#include "Board.h"
+#include "GameMode.h"
+#include "GameState.h"
+
+#include <array>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <string>
+#include <vector>
+
+// A game that was left in the middle, so it can be continued after a restart.
+// The file is the magic and version, then the fields below in order. Numbers are LEB128 varints (zigzag encoded if
+// they can be negative), the seed and the random state are stored as little endian 64 bit words and the tiles are
+// packed at 3 bits per cell, column by column. A cascade that is still playing is kept by storing its destroyed
+// cells as DestroyedType, the rest of it can be worked out again from the board.
+struct SaveState {
+    static constexpr uint32_t Magic = 0x53534A42; // "BJSS"
+    static constexpr uint8_t CurrentVersion = 1;
+    static constexpr int BitsPerCell = 3;
+    static constexpr uint8_t DestroyedType = (1 << BitsPerCell) - 1;
+    static constexpr int MaxTileKindCount = DestroyedType;
+
+    GameMode Mode = GameMode::Classic;
+    int ColCount = 0;
+    int RowCount = 0;
+    int TileKindCount = 0;
+    int CascadeDepth = 0;
+    uint64_t GameSeed = 0;
+    std::array<uint64_t, 4> RandomState {};
+    GameStateValues Values;
+    std::vector<uint8_t> PackedTiles;
+
+    void PackBoard(const Board& board);
+    // Returns false if the tiles don't fit the board or aren't valid kinds
+    bool UnpackBoard(Board& board) const;
+
+    std::vector<uint8_t> Serialize() const;
+    static std::optional<SaveState> Deserialize(std::span<const uint8_t> data);
+    // Reads the whole file at once
+    static std::optional<SaveState> ReadFile(const std::string& filePath);
+};
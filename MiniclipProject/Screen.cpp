@@ -7,8 +7,7 @@
 #include <iostream>
 
 namespace {
-constexpr size_t AssetTypeCount = 5;
-std::array<std::string, AssetTypeCount> AssetNames = {
+std::array<std::string, Screen::TileKindCount> AssetNames = {
     "Assets/Color1.png",
     "Assets/Color2.png",
     "Assets/Color3.png",
@@ -113,6 +112,11 @@ Screen::~Screen()
     TTF_CloseFont(_bigFont);
 }
 
+int Screen::GetScreenWidth() const
+{
+    return ScreenWidth;
+}
+
 void Screen::BeginFrame() const
 {
     SDL_RenderClear(_renderer);
@@ -181,6 +185,16 @@ void Screen::DrawBackgroundRectangle(const SDL_Rect& rect, SDL_Color color) cons
     SDL_SetRenderDrawBlendMode(_renderer, SDL_BLENDMODE_NONE);
 }
 
+void Screen::DrawText(const std::string& text, const Rect& textRect, bool useLargeFont) const
+{
+    DrawText(text, SDL_Rect { textRect.x, textRect.y, textRect.w, textRect.h }, useLargeFont);
+}
+
+void Screen::DrawBackgroundRectangle(const Rect& rect, Color color) const
+{
+    DrawBackgroundRectangle(SDL_Rect { rect.x, rect.y, rect.w, rect.h }, SDL_Color { color.r, color.g, color.b, color.a });
+}
+
 void Screen::DrawButton(const std::string& text, const SDL_Rect& coords, bool isHovered) const
 {
     DrawTexture(_menuButton, nullptr, &coords);
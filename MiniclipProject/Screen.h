@@ -1,5 +1,6 @@
 #pragma once
 
+#include "IRenderer.h"
 #include "SpriteAnimation.h"
 #include "Texture.h"
 #include "Vec2.h"
@@ -13,19 +14,23 @@
 #include <unordered_map>
 #include <vector>
 
-class Screen {
+class Screen : public IRenderer {
 public:
     static constexpr int ScreenWidth = 1024;
     static constexpr int ScreenHeight = 560;
+    // There is an image for every kind of tile up to this many
+    static constexpr int TileKindCount = 5;
 
     static std::unique_ptr<Screen> GetScreen();
     ~Screen();
 
     void TerminateWithMessage(const std::string& errorText);
 
+    int GetScreenWidth() const override;
+
     void BeginFrame() const;
-    void DrawCell(Vec2 coords, int cellType, int sourceSize, int destinationSize) const;
-    void DrawDestroyAnimation(Vec2 coords, int size, double progress);
+    void DrawCell(Vec2 coords, int cellType, int sourceSize, int destinationSize) const override;
+    void DrawDestroyAnimation(Vec2 coords, int size, double progress) override;
     void DrawTexture(const Texture& texture, const SDL_Rect* sourceRect, const SDL_Rect* destRect) const;
     void Present() const;
 
@@ -33,6 +38,9 @@ public:
     void DrawText(const std::string& text, const SDL_Rect& textRect, bool useLargeFont, SDL_Color color = { 255, 255, 255 }) const;
     void DrawBackgroundRectangle(const SDL_Rect& rect, SDL_Color color = { 50, 50, 50, 100 }) const;
 
+    void DrawText(const std::string& text, const Rect& textRect, bool useLargeFont) const override;
+    void DrawBackgroundRectangle(const Rect& rect, Color color) const override;
+
     Texture LoadImage(const std::string& filePath) const;
 
 private:
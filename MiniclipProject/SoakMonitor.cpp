@@ -0,0 +1,119 @@
+#include "SoakMonitor.h"
+
+#include "AllocationCounter.h"
+
+#include <algorithm>
+#include <numeric>
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+
+#include <psapi.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace {
+// Enough for a whole interval at 60 frames per second with some room for faster frames
+constexpr size_t ReservedFrameCount = SoakMonitor::LogIntervalMs / 1000 * 120;
+}
+
+SoakMonitor::SoakMonitor(const std::string& logFilePath)
+    : _log(logFilePath)
+    , _startResidentKb(GetResidentMemoryKb())
+    , _intervalStartAllocationCount(AllocationCounter::GetAllocationCount())
+{
+    _intervalFrameTimes.reserve(ReservedFrameCount);
+
+    _log << "time s, frames, mean frame ms, p99 frame ms, max frame ms, spikes, games, moves, "
+            "resident kb, resident growth kb, allocations per frame, live allocations"
+         << std::endl;
+}
+
+bool SoakMonitor::IsOpen() const
+{
+    return _log.is_open();
+}
+
+void SoakMonitor::RecordFrame(double frameTimeMs, uint64_t frameDeltaMs)
+{
+    ++_frameCount;
+    _elapsedMs += frameDeltaMs;
+
+    if (_intervalFrameTimes.size() < _intervalFrameTimes.capacity()) {
+        _intervalFrameTimes.push_back(frameTimeMs);
+    }
+    if (frameDeltaMs > FrameSpikeMs) {
+        ++_intervalSpikeCount;
+    }
+
+    if (_elapsedMs - _intervalStartMs >= LogIntervalMs) {
+        WriteInterval();
+    }
+}
+
+void SoakMonitor::RecordMove()
+{
+    ++_moveCount;
+}
+
+void SoakMonitor::RecordGameEnd()
+{
+    ++_gameCount;
+}
+
+void SoakMonitor::RecordProblem(const std::string& description)
+{
+    _log << "# " << _elapsedMs / 1000 << " s: " << description << std::endl;
+}
+
+void SoakMonitor::WriteInterval()
+{
+    auto frameCount = _intervalFrameTimes.size();
+    double meanMs = 0.0;
+    double p99Ms = 0.0;
+    double maxMs = 0.0;
+
+    if (frameCount > 0) {
+        meanMs = std::accumulate(_intervalFrameTimes.begin(), _intervalFrameTimes.end(), 0.0) / frameCount;
+        maxMs = *std::max_element(_intervalFrameTimes.begin(), _intervalFrameTimes.end());
+
+        auto p99 = _intervalFrameTimes.begin() + frameCount * 99 / 100;
+        std::nth_element(_intervalFrameTimes.begin(), p99, _intervalFrameTimes.end());
+        p99Ms = *p99;
+    }
+
+    auto residentKb = GetResidentMemoryKb();
+    auto allocationCount = AllocationCounter::GetAllocationCount();
+    auto liveAllocationCount = int64_t(allocationCount - AllocationCounter::GetDeallocationCount());
+
+    _log << _elapsedMs / 1000 << ", " << _frameCount << ", " << meanMs << ", " << p99Ms << ", " << maxMs << ", " << _intervalSpikeCount << ", "
+         << _gameCount << ", " << _moveCount << ", " << residentKb << ", " << int64_t(residentKb - _startResidentKb) << ", "
+         << double(allocationCount - _intervalStartAllocationCount) / std::max<size_t>(frameCount, 1) << ", " << liveAllocationCount
+         << std::endl;
+
+    _intervalStartMs = _elapsedMs;
+    _intervalFrameTimes.clear();
+    _intervalSpikeCount = 0;
+    _intervalStartAllocationCount = allocationCount;
+}
+
+uint64_t SoakMonitor::GetResidentMemoryKb()
+{
+#ifdef _WIN32
+    PROCESS_MEMORY_COUNTERS counters;
+    if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) {
+        return counters.WorkingSetSize / 1024;
+    }
+#else
+    std::ifstream statm("/proc/self/statm");
+    uint64_t totalPages = 0;
+    uint64_t residentPages = 0;
+    if (statm >> totalPages >> residentPages) {
+        return residentPages * uint64_t(sysconf(_SC_PAGESIZE)) / 1024;
+    }
+#endif
+
+    return 0;
+}
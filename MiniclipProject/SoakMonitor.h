@@ -0,0 +1,44 @@
+#pragma once
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+// Logs how the game behaves over a long unattended run: frame times, memory use, allocations and states the game
+// seems to be stuck in. A line is written for every interval of play, so a run can be watched while it's going.
+class SoakMonitor {
+public:
+    static constexpr uint64_t LogIntervalMs = 60 * 1000;
+    // Frames that took longer than this (waiting included) are counted as visible hitches
+    static constexpr uint64_t FrameSpikeMs = 50;
+
+    explicit SoakMonitor(const std::string& logFilePath);
+
+    bool IsOpen() const;
+
+    // frameTimeMs is the work of the frame, frameDeltaMs the time since the previous frame started
+    void RecordFrame(double frameTimeMs, uint64_t frameDeltaMs);
+    void RecordMove();
+    void RecordGameEnd();
+    // Written to the log right away, with the time it happened at
+    void RecordProblem(const std::string& description);
+
+private:
+    std::ofstream _log;
+
+    uint64_t _elapsedMs = 0;
+    uint64_t _intervalStartMs = 0;
+    uint64_t _frameCount = 0;
+    uint64_t _moveCount = 0;
+    uint64_t _gameCount = 0;
+    uint64_t _startResidentKb = 0;
+
+    // Reserved for a whole interval up front, so the monitor doesn't show up in the allocation counts
+    std::vector<double> _intervalFrameTimes;
+    uint64_t _intervalSpikeCount = 0;
+    uint64_t _intervalStartAllocationCount = 0;
+
+    void WriteInterval();
+    static uint64_t GetResidentMemoryKb();
+};
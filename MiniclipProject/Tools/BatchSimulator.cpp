@@ -0,0 +1,262 @@
+// Plays a large number of games with a bot on every core and reports the throughput
+// and the distribution of the results, using the same game states as the real game.
+// Usage: BatchSimulator [--mode classic|quickdeath|both] [--games N] [--bot random|greedy|first|expectimax|mcts]
+//                       [--think-ms N] [--frame-ms N] [--max-game-ms N] [--threads N] [--seed N]
+
+#include "../Bot.h"
+#include "../GameState.h"
+#include "../GameWorld.h"
+#include "../HeadlessSinks.h"
+#include "../RandomGenerator.h"
+#include "../WorkStealingPool.h"
+
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace {
+using Clock = std::chrono::steady_clock;
+
+struct SimulationOptions {
+    std::vector<GameMode> Modes { GameMode::Classic, GameMode::QuickDeath };
+    uint64_t GameCount = 10000;
+    BotStrategy Strategy = BotStrategy::Random;
+    uint64_t ThinkTimeMs = 0;
+    uint64_t FrameTimeMs = 16;
+    uint64_t MaxGameTimeMs = 30 * 60 * 1000; // Stops games that a good bot could play forever in QuickDeath
+    int ThreadCount = 0;
+    uint64_t Seed = 0;
+};
+
+// Values are counted in buckets of a fixed width, so merging the results of the workers and taking percentiles is cheap
+class Distribution {
+public:
+    explicit Distribution(uint64_t bucketWidth)
+        : _bucketWidth(bucketWidth)
+    {
+    }
+
+    void Add(uint64_t value)
+    {
+        auto bucket = size_t(value / _bucketWidth);
+        if (bucket >= _buckets.size()) {
+            _buckets.resize(bucket + 1, 0);
+        }
+
+        ++_buckets[bucket];
+        ++_count;
+        _sum += value;
+        _min = std::min(_min, value);
+        _max = std::max(_max, value);
+    }
+
+    void Merge(const Distribution& other)
+    {
+        if (other._buckets.size() > _buckets.size()) {
+            _buckets.resize(other._buckets.size(), 0);
+        }
+        for (size_t i = 0; i < other._buckets.size(); ++i) {
+            _buckets[i] += other._buckets[i];
+        }
+
+        _count += other._count;
+        _sum += other._sum;
+        _min = std::min(_min, other._min);
+        _max = std::max(_max, other._max);
+    }
+
+    uint64_t GetCount() const { return _count; }
+
+    // The lower end of the bucket that holds the given fraction of the values
+    uint64_t Percentile(double fraction) const
+    {
+        auto target = uint64_t(fraction * double(_count));
+        uint64_t seen = 0;
+        for (size_t i = 0; i < _buckets.size(); ++i) {
+            seen += _buckets[i];
+            if (seen > target) {
+                return i * _bucketWidth;
+            }
+        }
+
+        return _max;
+    }
+
+    void Print(const std::string& name, const std::string& unit) const
+    {
+        std::cout << "  " << std::left << std::setw(16) << name << std::right;
+        if (_count == 0) {
+            std::cout << "no data" << std::endl;
+            return;
+        }
+
+        std::cout << "mean " << std::fixed << std::setprecision(1) << double(_sum) / double(_count) << unit
+                  << ", min " << _min << unit
+                  << ", p10 " << Percentile(0.1) << unit
+                  << ", p50 " << Percentile(0.5) << unit
+                  << ", p90 " << Percentile(0.9) << unit
+                  << ", p99 " << Percentile(0.99) << unit
+                  << ", max " << _max << unit << std::endl;
+    }
+
+private:
+    uint64_t _bucketWidth;
+    std::vector<uint64_t> _buckets;
+    uint64_t _count = 0;
+    uint64_t _sum = 0;
+    uint64_t _min = UINT64_MAX;
+    uint64_t _max = 0;
+};
+
+struct SimulationStats {
+    Distribution ScoreMs { 100 };
+    Distribution MovesPerGame { 1 };
+    Distribution CascadeDepth { 1 };
+    uint64_t GameCount = 0;
+    uint64_t MoveCount = 0;
+    uint64_t CappedGameCount = 0;
+
+    void Merge(const SimulationStats& other)
+    {
+        ScoreMs.Merge(other.ScoreMs);
+        MovesPerGame.Merge(other.MovesPerGame);
+        CascadeDepth.Merge(other.CascadeDepth);
+        GameCount += other.GameCount;
+        MoveCount += other.MoveCount;
+        CappedGameCount += other.CappedGameCount;
+    }
+};
+
+// Every worker collects into its own stats, the padding keeps them on separate cache lines
+struct alignas(64) WorkerStats {
+    SimulationStats Stats;
+};
+
+void SimulateGame(const SimulationOptions& options, GameMode mode, uint64_t gameSeed, SimulationStats& stats)
+{
+    NullRenderer renderer;
+    NullAudioSink audioSink;
+    GameWorld gameWorld(8, 8, 5, renderer, audioSink, gameSeed);
+    Bot bot(options.Strategy, gameSeed, options.ThinkTimeMs);
+
+    auto gameState = MakeGameState(mode);
+    gameWorld.Activate(*gameState, gameSeed);
+
+    auto cascadeCompletedToken = gameWorld.CascadeCompleted.Subscribe([&stats](int cascadeDepth) { stats.CascadeDepth.Add(uint64_t(cascadeDepth)); });
+
+    uint64_t gameTimeMs = 0;
+    while (!gameState->IsGameOver() && gameTimeMs < options.MaxGameTimeMs) {
+        bot.Update(gameWorld, options.FrameTimeMs);
+        gameWorld.Update(options.FrameTimeMs);
+        gameTimeMs += options.FrameTimeMs;
+    }
+
+    if (gameState->IsGameOver()) {
+        stats.ScoreMs.Add(uint64_t(gameState->GetScore()));
+    } else {
+        ++stats.CappedGameCount;
+    }
+
+    stats.MovesPerGame.Add(uint64_t(bot.GetMoveCount()));
+    stats.MoveCount += uint64_t(bot.GetMoveCount());
+    ++stats.GameCount;
+}
+
+void RunSimulation(const SimulationOptions& options, GameMode mode, WorkStealingPool& pool)
+{
+    std::vector<WorkerStats> workerStats(size_t(pool.GetThreadCount()));
+
+    auto start = Clock::now();
+
+    pool.ParallelFor(options.GameCount, [&](size_t gameIndex) {
+        // Every game gets its own seed, so the results don't depend on which worker played it
+        auto gameSeed = RandomGenerator(options.Seed, uint64_t(mode) * options.GameCount + gameIndex).Next();
+        SimulateGame(options, mode, gameSeed, workerStats[size_t(pool.GetCurrentWorkerIndex())].Stats);
+    });
+
+    auto elapsedSeconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+    SimulationStats stats;
+    for (const auto& worker : workerStats) {
+        stats.Merge(worker.Stats);
+    }
+
+    std::cout << (mode == GameMode::Classic ? "Classic" : "QuickDeath") << ": " << stats.GameCount << " games in "
+              << std::fixed << std::setprecision(2) << elapsedSeconds << " s, "
+              << std::setprecision(0) << double(stats.GameCount) / elapsedSeconds << " games/s, "
+              << double(stats.MoveCount) / elapsedSeconds << " moves/s";
+    if (stats.CappedGameCount > 0) {
+        std::cout << ", " << stats.CappedGameCount << " games stopped at the time limit";
+    }
+    std::cout << std::endl;
+
+    stats.ScoreMs.Print(mode == GameMode::Classic ? "Time to 3000" : "Survival time", " ms");
+    stats.MovesPerGame.Print("Moves per game", "");
+    stats.CascadeDepth.Print("Cascade depth", "");
+}
+
+bool ParseOptions(int argc, char* argv[], SimulationOptions& options)
+{
+    for (int i = 1; i + 1 < argc; i += 2) {
+        std::string name = argv[i];
+        std::string value = argv[i + 1];
+
+        if (name == "--mode") {
+            if (value == "classic") {
+                options.Modes = { GameMode::Classic };
+            } else if (value == "quickdeath") {
+                options.Modes = { GameMode::QuickDeath };
+            } else if (value != "both") {
+                return false;
+            }
+        } else if (name == "--games") {
+            options.GameCount = std::stoull(value);
+        } else if (name == "--bot") {
+            auto strategy = ParseBotStrategy(value);
+            if (!strategy) {
+                return false;
+            }
+            options.Strategy = *strategy;
+        } else if (name == "--think-ms") {
+            options.ThinkTimeMs = std::stoull(value);
+        } else if (name == "--frame-ms") {
+            options.FrameTimeMs = std::max<uint64_t>(1, std::stoull(value));
+        } else if (name == "--max-game-ms") {
+            options.MaxGameTimeMs = std::stoull(value);
+        } else if (name == "--threads") {
+            options.ThreadCount = std::stoi(value);
+        } else if (name == "--seed") {
+            options.Seed = std::stoull(value);
+        } else {
+            return false;
+        }
+    }
+
+    return argc % 2 == 1;
+}
+}
+
+int main(int argc, char* argv[])
+{
+    SimulationOptions options;
+    options.Seed = RandomGenerator::MakeSeed();
+
+    if (!ParseOptions(argc, argv, options)) {
+        std::cerr << "Usage: BatchSimulator [--mode classic|quickdeath|both] [--games N] [--bot random|greedy|first|expectimax|mcts]" << std::endl
+                  << "                      [--think-ms N] [--frame-ms N] [--max-game-ms N] [--threads N] [--seed N]" << std::endl;
+        return 1;
+    }
+
+    WorkStealingPool pool(options.ThreadCount);
+
+    std::cout << "Seed: " << options.Seed << ", threads: " << pool.GetThreadCount() << std::endl;
+
+    for (auto mode : options.Modes) {
+        RunSimulation(options, mode, pool);
+    }
+
+    return 0;
+}
@@ -0,0 +1,495 @@
+// Plays games with a bot over a grid of board sizes and game rules and writes the results of every grid point
+// to a CSV file, with a 95% confidence interval of the mean score.
+// The moves of a game don't depend on the rules, so every board size is played once with the loosest rules of the
+// grid and the results for all the other rules are worked out from when cells were destroyed in that game.
+// The searching bots value the moves by the QuickDeath time formula, so with those every formula plays its own games.
+// Games that are still going at --max-game-ms are counted with the time they were stopped at. The mean of a point
+// with stopped games is only a lower bound, the CSV has the fraction of them next to it.
+// Every board size plays the same seeds, so the differences between grid points aren't hidden by the noise of the games.
+// Usage: ParameterSweep [--mode classic|quickdeath|both] [--kinds LIST] [--cols LIST] [--rows LIST] [--score LIST]
+//                       [--initial-ms LIST] [--cell-ms LIST] [--combo-ms LIST] [--games N] [--bot NAME] [--think-ms N]
+//                       [--frame-ms N] [--max-game-ms N] [--threads N] [--seed N] [--out PATH]
+// A LIST is a comma separated list of values, eg. --kinds 4,5,6
+
+#include "../Bot.h"
+#include "../GameState.h"
+#include "../GameWorld.h"
+#include "../HeadlessSinks.h"
+#include "../MatchDetector.h"
+#include "../RandomGenerator.h"
+#include "../WorkStealingPool.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <optional>
+#include <span>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+using Clock = std::chrono::steady_clock;
+
+struct SweepOptions {
+    std::vector<GameMode> Modes { GameMode::Classic, GameMode::QuickDeath };
+    std::vector<int> TileKindCounts { 5 };
+    std::vector<int> ColCounts { 8 };
+    std::vector<int> RowCounts { 8 };
+    std::vector<int> ScoresToReach { GameRules {}.ScoreToReach };
+    std::vector<int> InitialTimesLeftMs { GameRules {}.InitialTimeLeftMs };
+    std::vector<int> TimesPerCellMs { GameRules {}.TimePerCellMs };
+    std::vector<int> ComboTimesPerCellMs { GameRules {}.ComboTimePerCellMs };
+    uint64_t GameCount = 1000;
+    BotStrategy Strategy = BotStrategy::Random;
+    uint64_t ThinkTimeMs = 0;
+    uint64_t FrameTimeMs = 16;
+    uint64_t MaxGameTimeMs = 30 * 60 * 1000; // Stops games that a good bot could play forever in QuickDeath
+    int ThreadCount = 0;
+    uint64_t Seed = 0;
+    std::string OutputPath = "sweep.csv";
+};
+
+struct BoardConfig {
+    int TileKindCount;
+    int ColCount;
+    int RowCount;
+};
+
+struct GridPoint {
+    GameMode Mode;
+    BoardConfig Board;
+    GameRules Rules;
+};
+
+// The grid points that share a mode and a board, so they can share the games as well
+struct PointGroup {
+    GameMode Mode;
+    BoardConfig Board;
+    GameRules LoosestRules;
+    size_t FirstPoint;
+    size_t PointCount;
+};
+
+struct PointStats {
+    uint64_t GameCount = 0;
+    uint64_t FinishedGameCount = 0;
+    double ScoreSum = 0.0;
+    double ScoreSquareSum = 0.0;
+
+    void Merge(const PointStats& other)
+    {
+        GameCount += other.GameCount;
+        FinishedGameCount += other.FinishedGameCount;
+        ScoreSum += other.ScoreSum;
+        ScoreSquareSum += other.ScoreSquareSum;
+    }
+};
+
+// Every worker collects into its own stats, the padding keeps them on separate cache lines
+struct alignas(64) WorkerStats {
+    std::vector<PointStats> Points;
+    uint64_t GamesPlayed = 0;
+    uint64_t MoveCount = 0;
+};
+
+struct DestructionEvent {
+    uint64_t FrameEndMs; // The end of the frame it happened in, when the game is checked for being over
+    int DestroyedCellCount;
+    int HighestCombo;
+    bool IsOverlappingMove;
+};
+
+// Plays by the loosest rules and remembers every destruction, the rest of the game state is left to the real one
+class RecordingGameState : public IGameState {
+public:
+    RecordingGameState(GameMode mode, const GameRules& rules, std::vector<DestructionEvent>& events)
+        : _gameState(MakeGameState(mode, rules))
+        , _events(events)
+    {
+    }
+
+    int UpdateScore(const CellDestructionData& data) override
+    {
+        auto highestCombo = std::max(data.HighestColumnCombo, data.HighestRowCombo);
+        _events.push_back({ 0, int(data.DestroyedCells.size()), highestCombo, _isOverlappingMove });
+
+        return _gameState->UpdateScore(data);
+    }
+
+    void SetIsOverlappingMove(bool isOverlappingMove) override
+    {
+        IGameState::SetIsOverlappingMove(isOverlappingMove);
+        _gameState->SetIsOverlappingMove(isOverlappingMove);
+    }
+
+    std::vector<std::string> GetUIText() override { return _gameState->GetUIText(); }
+    std::vector<std::string> GetResult() override { return _gameState->GetResult(); }
+
+    void Update(int deltaTime) override
+    {
+        IGameState::Update(deltaTime);
+        _gameState->Update(deltaTime);
+    }
+
+    bool IsGameOver() const override { return _gameState->IsGameOver(); }
+    GameMode GetGameMode() const override { return _gameState->GetGameMode(); }
+    int GetScore() const override { return _gameState->GetScore(); }
+
+private:
+    std::unique_ptr<IGameState> _gameState;
+    std::vector<DestructionEvent>& _events;
+};
+
+// The score of a Classic game with the given rules, or nothing if it wasn't over in the recorded part
+std::optional<uint64_t> FindClassicScore(const std::vector<DestructionEvent>& events, const GameRules& rules)
+{
+    int score = 0;
+    for (const auto& event : events) {
+        score += rules.GetPoints(event.DestroyedCellCount, event.HighestCombo);
+        if (score >= rules.ScoreToReach) {
+            return event.FrameEndMs;
+        }
+    }
+
+    return std::nullopt;
+}
+
+// The score of a QuickDeath game with the given rules, or nothing if it wasn't over in the recorded part.
+// The time left only goes down between two destructions, so the game is over at the first frame
+// that runs out of time before the next destruction. Time is gained before the end of the frame is checked.
+std::optional<uint64_t> FindQuickDeathScore(const std::vector<DestructionEvent>& events, const GameRules& rules, uint64_t frameTimeMs, uint64_t playedTimeMs)
+{
+    int64_t timeGainedMs = 0;
+    uint64_t firstUncheckedFrameMs = frameTimeMs;
+
+    auto findFrameOutOfTime = [&]() {
+        auto outOfTimeMs = std::max<int64_t>(0, rules.InitialTimeLeftMs + timeGainedMs);
+        auto frameMs = (uint64_t(outOfTimeMs) + frameTimeMs - 1) / frameTimeMs * frameTimeMs;
+        return std::max(frameMs, firstUncheckedFrameMs);
+    };
+
+    for (const auto& event : events) {
+        auto frameMs = findFrameOutOfTime();
+        if (frameMs < event.FrameEndMs) {
+            return frameMs;
+        }
+
+        timeGainedMs += rules.GetTimeGainedMs(event.DestroyedCellCount, event.HighestCombo, event.IsOverlappingMove);
+        firstUncheckedFrameMs = event.FrameEndMs;
+    }
+
+    auto frameMs = findFrameOutOfTime();
+    if (frameMs <= playedTimeMs) {
+        return frameMs;
+    }
+
+    return std::nullopt;
+}
+
+void PlayGroupGame(const SweepOptions& options, const std::vector<GridPoint>& points, const PointGroup& group, uint64_t gameSeed, WorkerStats& stats)
+{
+    NullRenderer renderer;
+    NullAudioSink audioSink;
+    GameWorld gameWorld(group.Board.RowCount, group.Board.ColCount, group.Board.TileKindCount, renderer, audioSink, gameSeed);
+    // What a search is after only depends on the rules that are the same for every point of the group
+    Bot bot(options.Strategy, gameSeed, options.ThinkTimeMs, group.LoosestRules);
+
+    std::vector<DestructionEvent> events;
+    RecordingGameState gameState(group.Mode, group.LoosestRules, events);
+    gameWorld.Activate(gameState, gameSeed);
+
+    // Cells are destroyed as soon as a switch is made, which is before the time of the frame passes
+    uint64_t gameTimeMs = 0;
+    size_t timedEventCount = 0;
+    while (!gameState.IsGameOver() && gameTimeMs < options.MaxGameTimeMs) {
+        bot.Update(gameWorld, options.FrameTimeMs);
+        gameWorld.Update(options.FrameTimeMs);
+        gameTimeMs += options.FrameTimeMs;
+
+        for (; timedEventCount < events.size(); ++timedEventCount) {
+            events[timedEventCount].FrameEndMs = gameTimeMs;
+        }
+    }
+
+    for (size_t i = group.FirstPoint; i < group.FirstPoint + group.PointCount; ++i) {
+        const auto& rules = points[i].Rules;
+        auto score = group.Mode == GameMode::Classic
+            ? FindClassicScore(events, rules)
+            : FindQuickDeathScore(events, rules, options.FrameTimeMs, gameTimeMs);
+
+        // A game that wasn't over is counted with the time it was stopped at, its real score is at least that
+        auto& pointStats = stats.Points[i];
+        auto countedScore = double(score.value_or(gameTimeMs));
+        ++pointStats.GameCount;
+        pointStats.FinishedGameCount += score.has_value();
+        pointStats.ScoreSum += countedScore;
+        pointStats.ScoreSquareSum += countedScore * countedScore;
+    }
+
+    ++stats.GamesPlayed;
+    stats.MoveCount += uint64_t(bot.GetMoveCount());
+}
+
+void AddClassicGroup(const SweepOptions& options, const BoardConfig& board, std::vector<GridPoint>& points, std::vector<PointGroup>& groups)
+{
+    PointGroup group { GameMode::Classic, board, {}, points.size(), 0 };
+    group.LoosestRules.ScoreToReach = *std::max_element(options.ScoresToReach.begin(), options.ScoresToReach.end());
+
+    for (auto scoreToReach : options.ScoresToReach) {
+        GameRules rules;
+        rules.ScoreToReach = scoreToReach;
+        points.push_back({ GameMode::Classic, board, rules });
+    }
+
+    group.PointCount = points.size() - group.FirstPoint;
+    groups.push_back(group);
+}
+
+// A point for every initial time and time formula, all of them sharing the games
+void AddQuickDeathGroup(const SweepOptions& options, const BoardConfig& board, std::span<const int> timesPerCellMs, std::span<const int> comboTimesPerCellMs,
+    std::vector<GridPoint>& points, std::vector<PointGroup>& groups)
+{
+    PointGroup group { GameMode::QuickDeath, board, {}, points.size(), 0 };
+    group.LoosestRules.InitialTimeLeftMs = *std::max_element(options.InitialTimesLeftMs.begin(), options.InitialTimesLeftMs.end());
+    group.LoosestRules.TimePerCellMs = *std::max_element(timesPerCellMs.begin(), timesPerCellMs.end());
+    group.LoosestRules.ComboTimePerCellMs = *std::max_element(comboTimesPerCellMs.begin(), comboTimesPerCellMs.end());
+
+    for (auto initialTimeLeftMs : options.InitialTimesLeftMs) {
+        for (auto timePerCellMs : timesPerCellMs) {
+            for (auto comboTimePerCellMs : comboTimesPerCellMs) {
+                GameRules rules;
+                rules.InitialTimeLeftMs = initialTimeLeftMs;
+                rules.TimePerCellMs = timePerCellMs;
+                rules.ComboTimePerCellMs = comboTimePerCellMs;
+                points.push_back({ GameMode::QuickDeath, board, rules });
+            }
+        }
+    }
+
+    group.PointCount = points.size() - group.FirstPoint;
+    groups.push_back(group);
+}
+
+// Classic only depends on the score to reach and QuickDeath only on the time rules,
+// so the grid of every mode only spans the values that matter to it
+void BuildGrid(const SweepOptions& options, std::vector<GridPoint>& points, std::vector<PointGroup>& groups)
+{
+    for (auto mode : options.Modes) {
+        for (auto tileKindCount : options.TileKindCounts) {
+            for (auto colCount : options.ColCounts) {
+                for (auto rowCount : options.RowCounts) {
+                    BoardConfig board { tileKindCount, colCount, rowCount };
+
+                    if (mode == GameMode::Classic) {
+                        AddClassicGroup(options, board, points, groups);
+                    } else if (IsSearchStrategy(options.Strategy)) {
+                        // The initial time doesn't change what a search goes for, so only the points of one formula share games
+                        for (const auto& timePerCellMs : options.TimesPerCellMs) {
+                            for (const auto& comboTimePerCellMs : options.ComboTimesPerCellMs) {
+                                AddQuickDeathGroup(options, board, { &timePerCellMs, 1 }, { &comboTimePerCellMs, 1 }, points, groups);
+                            }
+                        }
+                    } else {
+                        AddQuickDeathGroup(options, board, options.TimesPerCellMs, options.ComboTimesPerCellMs, points, groups);
+                    }
+                }
+            }
+        }
+    }
+}
+
+bool WriteResults(const std::string& path, const std::vector<GridPoint>& points, const std::vector<PointStats>& stats)
+{
+    std::ofstream file(path);
+    if (!file) {
+        return false;
+    }
+
+    file << "mode,tile_kinds,cols,rows,score_to_reach,initial_time_ms,time_per_cell_ms,combo_time_per_cell_ms,"
+         << "games,finished_games,stopped_fraction,mean_score_ms,stddev_ms,ci95_low_ms,ci95_high_ms\n";
+    file << std::fixed << std::setprecision(1);
+
+    for (size_t i = 0; i < points.size(); ++i) {
+        const auto& point = points[i];
+        const auto& pointStats = stats[i];
+
+        file << (point.Mode == GameMode::Classic ? "classic" : "quickdeath") << ','
+             << point.Board.TileKindCount << ',' << point.Board.ColCount << ',' << point.Board.RowCount << ',';
+        if (point.Mode == GameMode::Classic) {
+            file << point.Rules.ScoreToReach << ",,,,";
+        } else {
+            file << ',' << point.Rules.InitialTimeLeftMs << ',' << point.Rules.TimePerCellMs << ',' << point.Rules.ComboTimePerCellMs << ',';
+        }
+        auto count = double(pointStats.GameCount);
+        file << pointStats.GameCount << ',' << pointStats.FinishedGameCount << ',';
+        file << std::setprecision(3) << double(pointStats.GameCount - pointStats.FinishedGameCount) / std::max(count, 1.0) << std::setprecision(1) << ',';
+
+        // Stopped games are in there with the time they were stopped at, so with any of them this is a lower bound.
+        // The interval uses the normal approximation, which is fine for a few dozen games.
+        if (pointStats.GameCount < 2) {
+            file << ",,,\n";
+            continue;
+        }
+
+        auto mean = pointStats.ScoreSum / count;
+        auto variance = std::max(0.0, (pointStats.ScoreSquareSum - count * mean * mean) / (count - 1.0));
+        auto stddev = std::sqrt(variance);
+        auto halfWidth = 1.96 * stddev / std::sqrt(count);
+
+        file << mean << ',' << stddev << ',' << mean - halfWidth << ',' << mean + halfWidth << '\n';
+    }
+
+    return bool(file);
+}
+
+bool ParseList(const std::string& value, std::vector<int>& values, int minimum)
+{
+    values.clear();
+
+    std::stringstream stream(value);
+    std::string item;
+    while (std::getline(stream, item, ',')) {
+        auto number = std::stoi(item);
+        if (number < minimum) {
+            return false;
+        }
+        values.push_back(number);
+    }
+
+    return !values.empty();
+}
+
+bool ParseOptions(int argc, char* argv[], SweepOptions& options)
+{
+    for (int i = 1; i + 1 < argc; i += 2) {
+        std::string name = argv[i];
+        std::string value = argv[i + 1];
+
+        bool isValid = true;
+        if (name == "--mode") {
+            if (value == "classic") {
+                options.Modes = { GameMode::Classic };
+            } else if (value == "quickdeath") {
+                options.Modes = { GameMode::QuickDeath };
+            } else if (value != "both") {
+                return false;
+            }
+        } else if (name == "--kinds") {
+            isValid = ParseList(value, options.TileKindCounts, 3);
+        } else if (name == "--cols") {
+            isValid = ParseList(value, options.ColCounts, 3);
+        } else if (name == "--rows") {
+            isValid = ParseList(value, options.RowCounts, 3);
+        } else if (name == "--score") {
+            isValid = ParseList(value, options.ScoresToReach, 1);
+        } else if (name == "--initial-ms") {
+            isValid = ParseList(value, options.InitialTimesLeftMs, 1);
+        } else if (name == "--cell-ms") {
+            isValid = ParseList(value, options.TimesPerCellMs, 0);
+        } else if (name == "--combo-ms") {
+            isValid = ParseList(value, options.ComboTimesPerCellMs, 0);
+        } else if (name == "--games") {
+            options.GameCount = std::stoull(value);
+        } else if (name == "--bot") {
+            auto strategy = ParseBotStrategy(value);
+            if (!strategy) {
+                return false;
+            }
+            options.Strategy = *strategy;
+        } else if (name == "--think-ms") {
+            options.ThinkTimeMs = std::stoull(value);
+        } else if (name == "--frame-ms") {
+            options.FrameTimeMs = std::max<uint64_t>(1, std::stoull(value));
+        } else if (name == "--max-game-ms") {
+            options.MaxGameTimeMs = std::stoull(value);
+        } else if (name == "--threads") {
+            options.ThreadCount = std::stoi(value);
+        } else if (name == "--seed") {
+            options.Seed = std::stoull(value);
+        } else if (name == "--out") {
+            options.OutputPath = value;
+        } else {
+            return false;
+        }
+
+        if (!isValid) {
+            return false;
+        }
+    }
+
+    return argc % 2 == 1;
+}
+}
+
+int main(int argc, char* argv[])
+{
+    SweepOptions options;
+    options.Seed = RandomGenerator::MakeSeed();
+
+    if (!ParseOptions(argc, argv, options)) {
+        std::cerr << "Usage: ParameterSweep [--mode classic|quickdeath|both] [--kinds LIST] [--cols LIST] [--rows LIST] [--score LIST]" << std::endl
+                  << "                      [--initial-ms LIST] [--cell-ms LIST] [--combo-ms LIST] [--games N] [--bot NAME] [--think-ms N]" << std::endl
+                  << "                      [--frame-ms N] [--max-game-ms N] [--threads N] [--seed N] [--out PATH]" << std::endl
+                  << "A LIST is a comma separated list of values, eg. --kinds 4,5,6" << std::endl;
+        return 1;
+    }
+
+    std::vector<GridPoint> points;
+    std::vector<PointGroup> groups;
+    BuildGrid(options, points, groups);
+
+    WorkStealingPool pool(options.ThreadCount);
+    std::vector<WorkerStats> workerStats(static_cast<size_t>(pool.GetThreadCount()));
+    for (auto& worker : workerStats) {
+        worker.Points.resize(points.size());
+    }
+
+    std::cout << "Seed: " << options.Seed << ", threads: " << pool.GetThreadCount() << ", " << points.size() << " grid points, "
+              << groups.size() * options.GameCount << " games to play" << std::endl;
+
+    auto start = Clock::now();
+
+    pool.ParallelFor(groups.size() * options.GameCount, [&](size_t taskIndex) {
+        const auto& group = groups[taskIndex / options.GameCount];
+        auto gameIndex = taskIndex % options.GameCount;
+
+        // The seed only depends on the game index, so every board plays the same games
+        auto gameSeed = RandomGenerator(options.Seed, gameIndex).Next();
+        PlayGroupGame(options, points, group, gameSeed, workerStats[size_t(pool.GetCurrentWorkerIndex())]);
+    });
+
+    auto elapsedSeconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+    std::vector<PointStats> stats(points.size());
+    uint64_t gamesPlayed = 0;
+    uint64_t moveCount = 0;
+    for (const auto& worker : workerStats) {
+        for (size_t i = 0; i < points.size(); ++i) {
+            stats[i].Merge(worker.Points[i]);
+        }
+        gamesPlayed += worker.GamesPlayed;
+        moveCount += worker.MoveCount;
+    }
+
+    std::cout << gamesPlayed << " games (" << moveCount << " moves) in " << std::fixed << std::setprecision(2) << elapsedSeconds << " s, "
+              << std::setprecision(0) << double(gamesPlayed * points.size()) / double(groups.size()) / elapsedSeconds << " grid point games/s" << std::endl;
+
+    if (!WriteResults(options.OutputPath, points, stats)) {
+        std::cerr << "Couldn't write " << options.OutputPath << std::endl;
+        return 1;
+    }
+
+    std::cout << "Results written to " << options.OutputPath << std::endl;
+
+    auto stoppedPointCount = std::count_if(stats.begin(), stats.end(), [](const PointStats& pointStats) { return pointStats.FinishedGameCount < pointStats.GameCount; });
+    if (stoppedPointCount > 0) {
+        std::cout << stoppedPointCount << " of " << points.size() << " grid points have games that were stopped at " << options.MaxGameTimeMs
+                  << " ms, their means are lower bounds" << std::endl;
+    }
+
+    return 0;
+}
@@ -0,0 +1,324 @@
+// Stands in for the server side of the leaderboard: submitted replays are handed to a work stealing pool and verified on every core
+// by playing them again with the game's rules. Every tenth submission is tampered with: it claims one point more than its
+// game was worth, claims a board of a different size or with fewer tile kinds, or has one of its switches taken out.
+// Those have to be turned down. Reports how many replays per second get through and how long they wait.
+// Usage: ReplayVerificationService [submissions] [distinct replays] [threads] [seed]
+
+#include "../Bot.h"
+#include "../GameState.h"
+#include "../GameWorld.h"
+#include "../HeadlessSinks.h"
+#include "../RandomGenerator.h"
+#include "../ReplayRecorder.h"
+#include "../ReplayVerifier.h"
+#include "../WorkStealingPool.h"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <deque>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <mutex>
+#include <optional>
+#include <semaphore>
+#include <string>
+#include <vector>
+
+namespace {
+constexpr uint64_t FrameTimeMs = 16;
+constexpr uint64_t BotThinkTimeMs = 400;
+// Submissions that are waiting or being verified, more have to wait like they would on a full message queue
+constexpr std::ptrdiff_t MaxPendingSubmissions = 1024;
+// Games a bot could play forever in QuickDeath are recorded again with another seed
+constexpr uint64_t MaxRecordedGameMs = 30 * 60 * 1000;
+constexpr int TamperedOneIn = 10;
+
+using Clock = std::chrono::steady_clock;
+
+enum class TamperingKind {
+    None,
+    ExtraPoint,
+    BoardSize,
+    TileKindCount,
+    RemovedSwitch,
+};
+constexpr int TamperingKindCount = int(TamperingKind::RemovedSwitch) + 1;
+
+// Where the header fields are, after the magic, the version and the mode. The sizes fit in a single varint byte.
+constexpr size_t ColCountOffset = 6;
+constexpr size_t RowCountOffset = 7;
+constexpr size_t TileKindCountOffset = 8;
+constexpr size_t HeaderSize = 17;
+
+struct Submission {
+    std::vector<uint8_t> Replay;
+    TamperingKind Tampering = TamperingKind::None;
+    Clock::time_point SubmitTime;
+};
+
+struct alignas(64) WorkerStats {
+    std::array<uint64_t, size_t(ReplayVerdict::InvalidReplay) + 1> VerdictCounts {};
+    uint64_t UnexpectedVerdictCount = 0;
+    uint64_t FrameCount = 0;
+    std::vector<double> LatenciesMs;
+};
+
+// The verifier keeps its game world between replays, so every worker has its own
+struct Worker {
+    ReplayVerifier Verifier;
+    WorkerStats Stats;
+};
+
+// Plays a game with a bot the same way the game records it, and returns the recording if the game was over in time
+std::optional<std::vector<uint8_t>> RecordGame(GameMode mode, uint64_t seed, const std::string& filePath)
+{
+    NullRenderer renderer;
+    NullAudioSink audioSink;
+    GameWorld gameWorld(8, 8, 5, renderer, audioSink, seed);
+    Bot bot(BotStrategy::Random, seed, BotThinkTimeMs);
+    ReplayRecorder replayRecorder;
+
+    auto gameState = MakeGameState(mode);
+    gameWorld.Activate(*gameState, seed);
+
+    auto cellsSwitchedToken = gameWorld.CellsSwitched.Subscribe([&replayRecorder](Vec2 source, Vec2 destination) {
+        replayRecorder.RecordSwitch(source, destination);
+    });
+    replayRecorder.Begin(filePath, ReplayHeader { mode, gameWorld.ColCount, gameWorld.RowCount, gameWorld.TileKindCount, seed });
+
+    uint64_t gameTimeMs = 0;
+    while (!gameState->IsGameOver() && gameTimeMs < MaxRecordedGameMs) {
+        bot.Update(gameWorld, FrameTimeMs);
+        gameWorld.Update(FrameTimeMs);
+        replayRecorder.RecordFrame(FrameTimeMs);
+        gameTimeMs += FrameTimeMs;
+    }
+    replayRecorder.End(gameState->GetScore());
+
+    if (!gameState->IsGameOver()) {
+        return std::nullopt;
+    }
+
+    std::ifstream in(filePath, std::ios::binary);
+    return std::vector<uint8_t>(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+}
+
+// The recording ends with the score as a varint, replace it with one that is a point higher
+std::vector<uint8_t> ClaimOneMorePoint(std::vector<uint8_t> replay, int score)
+{
+    size_t varintSize = 1;
+    for (auto value = uint64_t(score); value >= 0x80; value >>= 7) {
+        ++varintSize;
+    }
+
+    replay.resize(replay.size() - varintSize);
+    for (auto value = uint64_t(score) + 1; true; value >>= 7) {
+        if (value < 0x80) {
+            replay.push_back(uint8_t(value));
+            break;
+        }
+        replay.push_back(uint8_t(value | 0x80));
+    }
+
+    return replay;
+}
+
+// A bigger board with fewer kinds makes matches a lot more likely, which is what a forged header would go for
+std::vector<uint8_t> ClaimBoardSize(std::vector<uint8_t> replay, uint8_t colCount, uint8_t rowCount)
+{
+    replay[ColCountOffset] = colCount;
+    replay[RowCountOffset] = rowCount;
+    return replay;
+}
+
+std::vector<uint8_t> ClaimTileKindCount(std::vector<uint8_t> replay, uint8_t tileKindCount)
+{
+    replay[TileKindCountOffset] = tileKindCount;
+    return replay;
+}
+
+// Takes out the first switch, so the board is different from there on. Editing a switch isn't enough, as there are
+// often two switches next to each other that destroy the same cells and leave the same board behind.
+std::vector<uint8_t> RemoveFirstSwitch(std::vector<uint8_t> replay)
+{
+    // The record type, 2 single byte varints on the game's board and the direction
+    constexpr size_t SwitchRecordSize = 4;
+
+    size_t position = HeaderSize;
+    while (position < replay.size()) {
+        auto recordType = replay[position++];
+        if (recordType == uint8_t(ReplayRecordType::Switch)) {
+            auto recordStart = replay.begin() + std::ptrdiff_t(position - 1);
+            replay.erase(recordStart, recordStart + SwitchRecordSize);
+            break;
+        }
+        if (recordType == uint8_t(ReplayRecordType::Frame)) {
+            while (replay[position++] & 0x80) {
+            }
+        }
+    }
+
+    return replay;
+}
+
+bool IsExpectedVerdict(TamperingKind tampering, ReplayVerdict verdict)
+{
+    switch (tampering) {
+    case TamperingKind::None:
+        return verdict == ReplayVerdict::Verified;
+    case TamperingKind::ExtraPoint:
+        return verdict == ReplayVerdict::ScoreMismatch;
+    case TamperingKind::BoardSize:
+    case TamperingKind::TileKindCount:
+        return verdict == ReplayVerdict::InvalidReplay;
+    case TamperingKind::RemovedSwitch:
+        // Depending on the board the next switches aren't possible, or the game ends at another time or with another score
+        return verdict != ReplayVerdict::Verified;
+    }
+
+    return false;
+}
+
+void Verify(Submission&& submission, Worker& worker)
+{
+    auto verification = worker.Verifier.Verify(std::move(submission.Replay));
+
+    auto& stats = worker.Stats;
+    ++stats.VerdictCounts[size_t(verification.Verdict)];
+    stats.FrameCount += uint64_t(verification.FrameCount);
+
+    stats.UnexpectedVerdictCount += !IsExpectedVerdict(submission.Tampering, verification.Verdict);
+
+    stats.LatenciesMs.push_back(std::chrono::duration<double, std::milli>(Clock::now() - submission.SubmitTime).count());
+}
+
+double Percentile(std::vector<double>& values, double fraction)
+{
+    if (values.empty()) {
+        return 0.0;
+    }
+
+    auto index = std::min(values.size() - 1, size_t(fraction * double(values.size())));
+    std::nth_element(values.begin(), values.begin() + std::ptrdiff_t(index), values.end());
+    return values[index];
+}
+}
+
+int main(int argc, char* argv[])
+{
+    int submissionCount = argc > 1 ? std::stoi(argv[1]) : 20000;
+    int replayCount = argc > 2 ? std::stoi(argv[2]) : 200;
+    int threadCount = argc > 3 ? std::stoi(argv[3]) : 0;
+    uint64_t seed = argc > 4 ? std::stoull(argv[4]) : RandomGenerator::MakeSeed();
+
+    std::cout << "Seed: " << seed << std::endl;
+    std::cout << "Recording " << replayCount << " games..." << std::endl;
+
+    // Real submissions would all be different games, here the same recordings are sent again and again
+    RandomGenerator seedGenerator(seed);
+    auto filePath = (std::filesystem::temp_directory_path() / "ReplayVerificationService.replay").string();
+    std::vector<std::vector<uint8_t>> replays;
+    std::vector<std::vector<uint8_t>> tamperedReplays;
+    std::vector<TamperingKind> tamperings;
+    ReplayVerifier recordingVerifier;
+    for (int i = 0; i < replayCount; ++i) {
+        auto mode = i % 2 == 0 ? GameMode::Classic : GameMode::QuickDeath;
+        auto recording = RecordGame(mode, seedGenerator.Next(), filePath);
+        while (!recording) {
+            recording = RecordGame(mode, seedGenerator.Next(), filePath);
+        }
+
+        auto replay = std::move(*recording);
+        auto recordedVerification = recordingVerifier.Verify(std::vector<uint8_t>(replay));
+
+        // Every kind of tampering is tried in both modes
+        auto tampering = TamperingKind(1 + (i / 2) % (TamperingKindCount - 1));
+        tamperings.push_back(tampering);
+        switch (tampering) {
+        case TamperingKind::None:
+        case TamperingKind::ExtraPoint:
+            tamperedReplays.push_back(ClaimOneMorePoint(replay, recordedVerification.RecordedScore));
+            break;
+        case TamperingKind::BoardSize:
+            tamperedReplays.push_back(ClaimBoardSize(replay, 20, 20));
+            break;
+        case TamperingKind::TileKindCount:
+            tamperedReplays.push_back(ClaimTileKindCount(replay, 3));
+            break;
+        case TamperingKind::RemovedSwitch:
+            tamperedReplays.push_back(RemoveFirstSwitch(replay));
+            break;
+        }
+        replays.push_back(std::move(replay));
+    }
+    std::filesystem::remove(filePath);
+
+    WorkStealingPool pool(threadCount);
+    threadCount = pool.GetThreadCount();
+    std::vector<Worker> workers(size_t(pool.GetThreadCount()));
+    std::counting_semaphore<MaxPendingSubmissions> pendingSlots(MaxPendingSubmissions);
+    // The pool runs the newest task first, so the tasks don't carry a submission. Each one verifies the oldest waiting
+    // submission instead, which keeps them in the order they came in.
+    std::mutex pendingMutex;
+    std::deque<Submission> pendingSubmissions;
+
+    auto start = Clock::now();
+    for (int i = 0; i < submissionCount; ++i) {
+        // The latency is counted from when there's room for the submission, not from when the loop got to it
+        pendingSlots.acquire();
+        Submission submission;
+        if (i % TamperedOneIn == TamperedOneIn - 1) {
+            auto replayIndex = size_t(i / TamperedOneIn) % tamperedReplays.size();
+            submission = Submission { tamperedReplays[replayIndex], tamperings[replayIndex], Clock::now() };
+        } else {
+            submission = Submission { replays[size_t(i) % replays.size()], TamperingKind::None, Clock::now() };
+        }
+        {
+            std::lock_guard lock(pendingMutex);
+            pendingSubmissions.push_back(std::move(submission));
+        }
+
+        pool.Submit([&]() {
+            Submission oldest;
+            {
+                std::lock_guard lock(pendingMutex);
+                oldest = std::move(pendingSubmissions.front());
+                pendingSubmissions.pop_front();
+            }
+
+            Verify(std::move(oldest), workers[size_t(pool.GetCurrentWorkerIndex())]);
+            pendingSlots.release();
+        });
+    }
+    pool.Wait();
+
+    double elapsedSeconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+    WorkerStats total;
+    for (const auto& worker : workers) {
+        const auto& stats = worker.Stats;
+        for (size_t i = 0; i < total.VerdictCounts.size(); ++i) {
+            total.VerdictCounts[i] += stats.VerdictCounts[i];
+        }
+        total.UnexpectedVerdictCount += stats.UnexpectedVerdictCount;
+        total.FrameCount += stats.FrameCount;
+        total.LatenciesMs.insert(total.LatenciesMs.end(), stats.LatenciesMs.begin(), stats.LatenciesMs.end());
+    }
+
+    static const char* const verdictNames[] = { "verified", "score mismatch", "rejected switch", "not finished", "too long", "invalid" };
+    std::cout << "Verified " << submissionCount << " submissions on " << threadCount << " threads in " << elapsedSeconds << " s" << std::endl;
+    std::cout << "  " << submissionCount / elapsedSeconds << " replays/s, " << submissionCount / elapsedSeconds / threadCount << " per thread, "
+              << double(total.FrameCount) * FrameTimeMs / 1000.0 / elapsedSeconds << " s of play per second" << std::endl;
+    std::cout << "  Latency p50 " << Percentile(total.LatenciesMs, 0.5) << " ms, p99 " << Percentile(total.LatenciesMs, 0.99) << " ms" << std::endl;
+    for (size_t i = 0; i < total.VerdictCounts.size(); ++i) {
+        if (total.VerdictCounts[i] > 0) {
+            std::cout << "  " << verdictNames[i] << ": " << total.VerdictCounts[i] << std::endl;
+        }
+    }
+    std::cout << "  Unexpected verdicts: " << total.UnexpectedVerdictCount << std::endl;
+
+    return total.UnexpectedVerdictCount == 0 ? 0 : 1;
+}
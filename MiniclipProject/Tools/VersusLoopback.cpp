@@ -0,0 +1,236 @@
+// Plays a versus match between two bots, either both in this process or one in each of two processes connected
+// over loopback UDP. Every packet is held back by a delay and some are dropped, like on a bad connection.
+// Reports how often the sides had to roll back or wait for each other, and whether they ever disagreed.
+// Usage: VersusLoopback local [frames] [delay ms] [loss percent] [seed]
+//        VersusLoopback peer <local port> <remote port> [frames] [delay ms] [loss percent] [seed]
+// Two processes play the same match when they get the same frames and seed and each other's ports.
+
+#include "../Bot.h"
+#include "../HeadlessSinks.h"
+#include "../RandomGenerator.h"
+#include "../UdpSocket.h"
+#include "../VersusSession.h"
+
+#include <chrono>
+#include <deque>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+constexpr BotStrategy Strategy = BotStrategy::Random;
+constexpr uint64_t ThinkTimeMs = 250;
+// Keep sending after the match is over, so the other side gets the last inputs even if packets are lost
+constexpr uint64_t LingerMs = 1000;
+
+using Clock = std::chrono::steady_clock;
+
+struct LinkOptions {
+    uint64_t DelayMs = 100;
+    int LossPercent = 10;
+};
+
+class LossyLink {
+public:
+    LossyLink(const LinkOptions& options, uint64_t seed)
+        : _options(options)
+        , _random(seed, 4)
+    {
+    }
+
+    void Send(uint64_t nowMs, const std::vector<uint8_t>& packet)
+    {
+        if (_random.NextInt(100) >= _options.LossPercent) {
+            _packets.push_back(DelayedPacket { nowMs + _options.DelayMs, packet });
+        }
+    }
+
+    template <class Action>
+    void Deliver(uint64_t nowMs, Action&& action)
+    {
+        while (!_packets.empty() && _packets.front().DeliveryTimeMs <= nowMs) {
+            action(_packets.front().Data);
+            _packets.pop_front();
+        }
+    }
+
+private:
+    struct DelayedPacket {
+        uint64_t DeliveryTimeMs;
+        std::vector<uint8_t> Data;
+    };
+
+    LinkOptions _options;
+    RandomGenerator _random;
+    std::deque<DelayedPacket> _packets;
+};
+
+struct Side {
+    Side(uint64_t seed, uint64_t botSeed, NullRenderer& renderer, NullAudioSink& audioSink)
+        : Session(GameMode::Classic, seed, renderer, audioSink)
+        , Player(Strategy, botSeed, ThinkTimeMs)
+    {
+    }
+
+    VersusSession Session;
+    Bot Player;
+    int StalledFrameCount = 0;
+    std::vector<uint8_t> Packet;
+};
+
+void PlayFrame(Side& side, int frameCount)
+{
+    if (side.Session.GetFrame() < frameCount) {
+        if (side.Session.CanAdvance()) {
+            side.Player.Update(side.Session.GetLocalWorld(), VersusSession::FrameTimeMs);
+            side.Session.AdvanceFrame();
+        } else {
+            ++side.StalledFrameCount;
+        }
+    }
+
+    side.Session.WritePacket(side.Packet);
+}
+
+bool IsDone(const Side& side, int frameCount)
+{
+    return side.Session.GetFrame() >= frameCount && side.Session.IsRemoteConfirmed() && side.Session.GetPeerAckedFrameCount() >= frameCount;
+}
+
+const char* ToString(VersusResult result)
+{
+    switch (result) {
+    case VersusResult::Undecided:
+        return "undecided";
+    case VersusResult::LocalWins:
+        return "won";
+    case VersusResult::RemoteWins:
+        return "lost";
+    case VersusResult::Draw:
+        return "draw";
+    }
+
+    return "";
+}
+
+void PrintReport(const std::string& name, const Side& side)
+{
+    const auto& stats = side.Session.GetStats();
+    std::cout << name << ": " << side.Session.GetFrame() << " frames, " << side.StalledFrameCount << " stalled, "
+              << stats.RollbackCount << " rollbacks (" << (stats.RollbackCount > 0 ? double(stats.ResimulatedFrameCount) / stats.RollbackCount : 0.0)
+              << " frames on average, " << stats.MaxRollbackFrames << " max, " << stats.MaxRollbackMs << " ms max), "
+              << stats.VerifiedFrameCount << " checksums verified, " << stats.DesyncCount << " desyncs, " << ToString(side.Session.GetResult()) << std::endl;
+    std::cout << name << " checksums: local " << side.Session.GetLocalChecksum() << ", remote " << side.Session.GetRemoteChecksum() << std::endl;
+}
+
+int RunLocal(int frameCount, const LinkOptions& linkOptions, uint64_t seed)
+{
+    NullRenderer renderer;
+    NullAudioSink audioSink;
+    Side first(seed, seed + 1, renderer, audioSink);
+    Side second(seed, seed + 2, renderer, audioSink);
+    LossyLink firstToSecond(linkOptions, seed + 1);
+    LossyLink secondToFirst(linkOptions, seed + 2);
+
+    // Time is counted in frames, so the delay is the same as between two processes but the match runs as fast as it can
+    uint64_t maxTickCount = uint64_t(frameCount) * 4 + 1000;
+    uint64_t tick = 0;
+    for (; tick < maxTickCount && !(IsDone(first, frameCount) && IsDone(second, frameCount)); ++tick) {
+        auto nowMs = tick * VersusSession::FrameTimeMs;
+        firstToSecond.Deliver(nowMs, [&second](const std::vector<uint8_t>& packet) { second.Session.ReceivePacket(packet); });
+        secondToFirst.Deliver(nowMs, [&first](const std::vector<uint8_t>& packet) { first.Session.ReceivePacket(packet); });
+
+        PlayFrame(first, frameCount);
+        PlayFrame(second, frameCount);
+
+        firstToSecond.Send(nowMs, first.Packet);
+        secondToFirst.Send(nowMs, second.Packet);
+    }
+
+    PrintReport("First", first);
+    PrintReport("Second", second);
+
+    bool isInSync = first.Session.GetLocalChecksum() == second.Session.GetRemoteChecksum() && second.Session.GetLocalChecksum() == first.Session.GetRemoteChecksum()
+        && first.Session.GetStats().DesyncCount == 0 && second.Session.GetStats().DesyncCount == 0;
+    bool isFinished = tick < maxTickCount;
+    std::cout << (isFinished ? "" : "Timed out, ") << (isInSync ? "in sync" : "OUT OF SYNC") << std::endl;
+
+    return isInSync && isFinished ? 0 : 1;
+}
+
+int RunPeer(uint16_t localPort, uint16_t remotePort, int frameCount, const LinkOptions& linkOptions, uint64_t seed)
+{
+    UdpSocket socket;
+    if (!socket.Open(localPort)) {
+        std::cerr << "Failed to open a UDP socket on port " << localPort << std::endl;
+        return 1;
+    }
+
+    NullRenderer renderer;
+    NullAudioSink audioSink;
+    Side side(seed, seed + localPort, renderer, audioSink);
+    LossyLink outgoing(linkOptions, seed + localPort);
+    std::vector<uint8_t> receiveBuffer(VersusSession::MaxPacketSize);
+
+    auto start = Clock::now();
+    auto timeoutMs = uint64_t(frameCount) * VersusSession::FrameTimeMs * 4 + 10000;
+    std::optional<uint64_t> doneTimeMs;
+    uint64_t nowMs = 0;
+
+    for (uint64_t tick = 0; nowMs < timeoutMs; ++tick) {
+        // Frames are played at the game's pace, so the delay is the same number of frames as in the game
+        std::this_thread::sleep_until(start + std::chrono::milliseconds(tick * VersusSession::FrameTimeMs));
+        nowMs = uint64_t(std::chrono::duration_cast<std::chrono::milliseconds>(Clock::now() - start).count());
+
+        while (auto size = socket.Receive(receiveBuffer)) {
+            side.Session.ReceivePacket(std::span<const uint8_t>(receiveBuffer.data(), *size));
+        }
+
+        PlayFrame(side, frameCount);
+        outgoing.Send(nowMs, side.Packet);
+        outgoing.Deliver(nowMs, [&socket, remotePort](const std::vector<uint8_t>& packet) { socket.Send(remotePort, packet); });
+
+        if (!doneTimeMs && IsDone(side, frameCount)) {
+            doneTimeMs = nowMs;
+        }
+        if (doneTimeMs && nowMs >= *doneTimeMs + LingerMs) {
+            break;
+        }
+    }
+
+    PrintReport("Port " + std::to_string(localPort), side);
+
+    bool isInSync = side.Session.GetStats().DesyncCount == 0;
+    std::cout << (doneTimeMs ? "" : "Timed out, ") << (isInSync ? "no desyncs" : "OUT OF SYNC") << std::endl;
+
+    return isInSync && doneTimeMs ? 0 : 1;
+}
+}
+
+int main(int argc, char* argv[])
+{
+    std::string mode = argc > 1 ? argv[1] : "local";
+
+    if (mode == "local") {
+        int frameCount = argc > 2 ? std::stoi(argv[2]) : 3600;
+        LinkOptions linkOptions { argc > 3 ? std::stoull(argv[3]) : 100, argc > 4 ? std::stoi(argv[4]) : 10 };
+        uint64_t seed = argc > 5 ? std::stoull(argv[5]) : RandomGenerator::MakeSeed();
+        std::cout << "Seed: " << seed << std::endl;
+
+        return RunLocal(frameCount, linkOptions, seed);
+    } else if (mode == "peer" && argc > 3) {
+        auto localPort = uint16_t(std::stoi(argv[2]));
+        auto remotePort = uint16_t(std::stoi(argv[3]));
+        int frameCount = argc > 4 ? std::stoi(argv[4]) : 3600;
+        LinkOptions linkOptions { argc > 5 ? std::stoull(argv[5]) : 100, argc > 6 ? std::stoi(argv[6]) : 10 };
+        // Both processes have to agree on the seed, so there is no random default
+        uint64_t seed = argc > 7 ? std::stoull(argv[7]) : 1;
+
+        return RunPeer(localPort, remotePort, frameCount, linkOptions, seed);
+    }
+
+    std::cerr << "Usage: VersusLoopback local [frames] [delay ms] [loss percent] [seed]" << std::endl;
+    std::cerr << "       VersusLoopback peer <local port> <remote port> [frames] [delay ms] [loss percent] [seed]" << std::endl;
+    return 1;
+}
@@ -0,0 +1,80 @@
+#include "TranspositionTable.h"
+
+#include <algorithm>
+#include <bit>
+
+namespace {
+// Set in every stored entry, so a zeroed slot never matches a hash, not even 0
+constexpr uint64_t OccupiedBit = uint64_t(1) << 63;
+
+uint64_t Pack(const TranspositionEntry& entry)
+{
+    return uint64_t(std::bit_cast<uint32_t>(entry.Value))
+        | (uint64_t(entry.BestMove) << 32)
+        | (uint64_t(entry.Depth) << 48)
+        | (uint64_t(entry.Flags & 0x7F) << 56)
+        | OccupiedBit;
+}
+
+TranspositionEntry Unpack(uint64_t data)
+{
+    return TranspositionEntry {
+        std::bit_cast<float>(uint32_t(data)),
+        uint16_t(data >> 32),
+        uint8_t(data >> 48),
+        uint8_t((data >> 56) & 0x7F),
+    };
+}
+
+uint8_t GetDepth(uint64_t data)
+{
+    return uint8_t(data >> 48);
+}
+}
+
+TranspositionTable::TranspositionTable(size_t sizeInBytes)
+    : _bucketMask(std::bit_floor(std::max(sizeInBytes / sizeof(Bucket), size_t(1))) - 1)
+    , _buckets(std::make_unique<Bucket[]>(_bucketMask + 1))
+{
+}
+
+std::optional<TranspositionEntry> TranspositionTable::Probe(uint64_t hash) const
+{
+    for (const auto& slot : GetBucket(hash).Slots) {
+        auto data = slot.Data.load(std::memory_order_relaxed);
+        auto check = slot.Check.load(std::memory_order_relaxed);
+
+        if ((data & OccupiedBit) != 0 && (check ^ data) == hash) {
+            return Unpack(data);
+        }
+    }
+
+    return std::nullopt;
+}
+
+void TranspositionTable::Store(uint64_t hash, const TranspositionEntry& entry)
+{
+    auto& bucket = GetBucket(hash);
+    auto data = Pack(entry);
+
+    // The first slot is only replaced by a result for the same position or one that searched at least as deep
+    auto& deepSlot = bucket.Slots[0];
+    auto deepData = deepSlot.Data.load(std::memory_order_relaxed);
+    auto deepCheck = deepSlot.Check.load(std::memory_order_relaxed);
+    bool isSamePosition = (deepCheck ^ deepData) == hash;
+    bool isEmpty = (deepData & OccupiedBit) == 0;
+
+    auto& slot = (isEmpty || isSamePosition || entry.Depth >= GetDepth(deepData)) ? deepSlot : bucket.Slots[1];
+    slot.Check.store(hash ^ data, std::memory_order_relaxed);
+    slot.Data.store(data, std::memory_order_relaxed);
+}
+
+void TranspositionTable::Clear()
+{
+    for (size_t i = 0; i <= _bucketMask; ++i) {
+        for (auto& slot : _buckets[i].Slots) {
+            slot.Check.store(0, std::memory_order_relaxed);
+            slot.Data.store(0, std::memory_order_relaxed);
+        }
+    }
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+
+// What a search learned about a position. Fits in 64 bits, so an entry can be written with a single atomic store.
+struct TranspositionEntry {
+    float Value = 0.0f;
+    uint16_t BestMove = 0;
+    uint8_t Depth = 0;
+    uint8_t Flags = 0; // Only the low 7 bits are kept
+};
+
+// A fixed size hash table of search results keyed by Zobrist hashes, shared by every search thread without locks.
+// Every slot stores the key XOR-ed with the data next to the data (Hyatt's lockless hashing), so an entry torn by
+// 2 threads writing at the same time just fails the key check and is treated as a miss.
+// Every bucket has a slot that keeps the deepest result and one that always takes the latest.
+class TranspositionTable {
+public:
+    // The memory is rounded down to a power of 2 number of buckets, but at least 1 bucket is always allocated
+    explicit TranspositionTable(size_t sizeInBytes);
+
+    std::optional<TranspositionEntry> Probe(uint64_t hash) const;
+    void Store(uint64_t hash, const TranspositionEntry& entry);
+
+    // Not safe to call while other threads are using the table
+    void Clear();
+
+    size_t GetCapacity() const { return (_bucketMask + 1) * SlotsPerBucket; }
+
+private:
+    static constexpr size_t SlotsPerBucket = 2;
+
+    struct Slot {
+        std::atomic<uint64_t> Check { 0 };
+        std::atomic<uint64_t> Data { 0 };
+    };
+
+    struct alignas(32) Bucket {
+        Slot Slots[SlotsPerBucket];
+    };
+
+    size_t _bucketMask;
+    std::unique_ptr<Bucket[]> _buckets;
+
+    const Bucket& GetBucket(uint64_t hash) const { return _buckets[hash & _bucketMask]; }
+    Bucket& GetBucket(uint64_t hash) { return _buckets[hash & _bucketMask]; }
+};
@@ -0,0 +1,104 @@
+#include "UdpSocket.h"
+
+#ifdef _WIN32
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#else
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+namespace {
+sockaddr_in MakeLoopbackAddress(uint16_t port)
+{
+    sockaddr_in address {};
+    address.sin_family = AF_INET;
+    address.sin_port = htons(port);
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    return address;
+}
+}
+
+UdpSocket::~UdpSocket()
+{
+    if (_socket == -1) {
+        return;
+    }
+
+#ifdef _WIN32
+    closesocket(SOCKET(_socket));
+    WSACleanup();
+#else
+    close(int(_socket));
+#endif
+}
+
+bool UdpSocket::Open(uint16_t localPort)
+{
+#ifdef _WIN32
+    WSADATA wsaData;
+    if (WSAStartup(MAKEWORD(2, 2), &wsaData) != 0) {
+        return false;
+    }
+
+    auto handle = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    if (handle == INVALID_SOCKET) {
+        WSACleanup();
+        return false;
+    }
+    _socket = intptr_t(handle);
+
+    u_long isNonBlocking = 1;
+    if (ioctlsocket(handle, FIONBIO, &isNonBlocking) != 0) {
+        return false;
+    }
+#else
+    int handle = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    if (handle < 0) {
+        return false;
+    }
+    _socket = handle;
+
+    if (fcntl(handle, F_SETFL, fcntl(handle, F_GETFL, 0) | O_NONBLOCK) != 0) {
+        return false;
+    }
+#endif
+
+    auto address = MakeLoopbackAddress(localPort);
+    return bind(handle, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) == 0;
+}
+
+bool UdpSocket::Send(uint16_t remotePort, std::span<const uint8_t> data)
+{
+    auto address = MakeLoopbackAddress(remotePort);
+
+#ifdef _WIN32
+    auto sentSize = sendto(SOCKET(_socket), reinterpret_cast<const char*>(data.data()), int(data.size()), 0, reinterpret_cast<const sockaddr*>(&address), sizeof(address));
+#else
+    auto sentSize = sendto(int(_socket), data.data(), data.size(), 0, reinterpret_cast<const sockaddr*>(&address), sizeof(address));
+#endif
+
+    return sentSize == decltype(sentSize)(data.size());
+}
+
+std::optional<size_t> UdpSocket::Receive(std::span<uint8_t> buffer)
+{
+#ifdef _WIN32
+    auto receivedSize = recv(SOCKET(_socket), reinterpret_cast<char*>(buffer.data()), int(buffer.size()), 0);
+    // A datagram that didn't fit is reported as an error on Windows, the part that fit is still in the buffer
+    if (receivedSize < 0 && WSAGetLastError() == WSAEMSGSIZE) {
+        return buffer.size();
+    }
+#else
+    auto receivedSize = recv(int(_socket), buffer.data(), buffer.size(), 0);
+#endif
+
+    if (receivedSize < 0) {
+        return std::nullopt;
+    }
+
+    return size_t(receivedSize);
+}
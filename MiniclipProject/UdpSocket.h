@@ -0,0 +1,25 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <span>
+
+// A non-blocking UDP socket on the loopback interface, for connecting two copies of the game on the same machine
+class UdpSocket {
+public:
+    UdpSocket() = default;
+    ~UdpSocket();
+
+    UdpSocket(const UdpSocket&) = delete;
+    UdpSocket& operator=(const UdpSocket&) = delete;
+
+    bool Open(uint16_t localPort);
+    bool Send(uint16_t remotePort, std::span<const uint8_t> data);
+    // The size of the datagram that was read, or nothing if none is waiting. Datagrams larger than the buffer are cut.
+    std::optional<size_t> Receive(std::span<uint8_t> buffer);
+
+private:
+    // A SOCKET on Windows, a file descriptor everywhere else
+    intptr_t _socket = -1;
+};
@@ -0,0 +1,129 @@
+#include "UndoHistory.h"
+
+#include <algorithm>
+#include <cassert>
+
+UndoHistory::UndoHistory(int colCount, int rowCount)
+    : _recordedCells(colCount, rowCount)
+    , _recordedRowCounts(size_t(colCount), 0)
+{
+}
+
+void UndoHistory::BeginMove(const RandomGenerator& randomGenerator, const IGameState& gameState)
+{
+    assert(!_isRecording);
+
+    _isRecording = true;
+    _currentMove.Changes.clear();
+    _currentMove.RandomStateBefore = randomGenerator.GetState();
+    _currentMove.GameStateBefore = gameState.GetValues();
+}
+
+void UndoHistory::RecordCell(const Board& board, Vec2 index)
+{
+    if (!_isRecording || _recordedCells.Test(index)) {
+        return;
+    }
+
+    // Only the first type counts, the cell may change several times during a cascade
+    _recordedCells.Set(index);
+    _currentMove.Changes.push_back(CellChange { index, board.Type(index), 0 });
+}
+
+void UndoHistory::RecordColumnTop(const Board& board, int col, int lowestRow)
+{
+    if (!_isRecording) {
+        return;
+    }
+
+    for (int row = _recordedRowCounts[col]; row <= lowestRow; ++row) {
+        RecordCell(board, Vec2 { col, row });
+    }
+    _recordedRowCounts[col] = std::max(_recordedRowCounts[col], lowestRow + 1);
+}
+
+void UndoHistory::RecordBoard(const Board& board)
+{
+    for (int col = 0; col < board.GetColCount(); ++col) {
+        RecordColumnTop(board, col, board.GetRowCount() - 1);
+    }
+}
+
+void UndoHistory::EndMove(const Board& board, const RandomGenerator& randomGenerator, const IGameState& gameState)
+{
+    if (!_isRecording) {
+        return;
+    }
+    _isRecording = false;
+
+    auto& changes = _currentMove.Changes;
+    for (auto& change : changes) {
+        _recordedCells.Reset(change.Index);
+        change.NewType = board.Type(change.Index);
+    }
+    std::fill(_recordedRowCounts.begin(), _recordedRowCounts.end(), 0);
+
+    // A cell that ended up with the type it started with doesn't have to be restored
+    std::erase_if(changes, [](const CellChange& change) { return change.OldType == change.NewType; });
+
+    _currentMove.RandomStateAfter = randomGenerator.GetState();
+    _currentMove.GameStateAfter = gameState.GetValues();
+
+    // A new move replaces the ones that were undone
+    _moves.resize(_undoCount);
+    if (_moves.size() == MaxMoveCount) {
+        _moves.pop_front();
+    }
+
+    _moves.push_back(std::move(_currentMove));
+    _undoCount = _moves.size();
+    _currentMove = Move {};
+}
+
+std::span<const CellChange> UndoHistory::Undo(Board& board, BoardGenerator& boardGenerator, IGameState& gameState)
+{
+    assert(CanUndo() && !_isRecording);
+
+    const auto& move = _moves[--_undoCount];
+    for (const auto& change : move.Changes) {
+        board.Type(change.Index) = change.OldType;
+    }
+
+    RandomGenerator randomGenerator;
+    randomGenerator.SetState(move.RandomStateBefore);
+    boardGenerator.SetRandomGenerator(randomGenerator);
+    gameState.SetValues(move.GameStateBefore);
+
+    return move.Changes;
+}
+
+std::span<const CellChange> UndoHistory::Redo(Board& board, BoardGenerator& boardGenerator, IGameState& gameState)
+{
+    assert(CanRedo() && !_isRecording);
+
+    const auto& move = _moves[_undoCount++];
+    for (const auto& change : move.Changes) {
+        board.Type(change.Index) = change.NewType;
+    }
+
+    RandomGenerator randomGenerator;
+    randomGenerator.SetState(move.RandomStateAfter);
+    boardGenerator.SetRandomGenerator(randomGenerator);
+    gameState.SetValues(move.GameStateAfter);
+
+    return move.Changes;
+}
+
+void UndoHistory::Clear()
+{
+    if (_isRecording) {
+        for (const auto& change : _currentMove.Changes) {
+            _recordedCells.Reset(change.Index);
+        }
+        std::fill(_recordedRowCounts.begin(), _recordedRowCounts.end(), 0);
+        _isRecording = false;
+    }
+
+    _moves.clear();
+    _undoCount = 0;
+}
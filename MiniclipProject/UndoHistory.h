@@ -0,0 +1,71 @@
+#pragma once
+
+#include "Board.h"
+#include "BoardGenerator.h"
+#include "CellMask.h"
+#include "GameState.h"
+#include "RandomGenerator.h"
+#include "Vec2.h"
+
+#include <array>
+#include <cstdint>
+#include <deque>
+#include <span>
+#include <vector>
+
+struct CellChange {
+    Vec2 Index;
+    uint8_t OldType;
+    uint8_t NewType;
+};
+
+// The moves of the player that can be taken back and played again.
+// A move only keeps the cells it has changed (switched, destroyed, fallen or spawned), with the types they had before
+// and after it, so undoing one doesn't depend on the size of the board. The random generator and the game state are
+// kept too, so an undone move plays out exactly the same way when it's made again.
+class UndoHistory {
+public:
+    static constexpr size_t MaxMoveCount = 256;
+
+    UndoHistory(int colCount, int rowCount);
+
+    // Called when a switch is accepted, before the board changes
+    void BeginMove(const RandomGenerator& randomGenerator, const IGameState& gameState);
+    // Called before the type of a cell changes during the move
+    void RecordCell(const Board& board, Vec2 index);
+    // Called before the rows [0, lowestRow] of a column change during the move, eg. when the cells fall down
+    void RecordColumnTop(const Board& board, int col, int lowestRow);
+    void RecordBoard(const Board& board);
+    // Called when the board has settled
+    void EndMove(const Board& board, const RandomGenerator& randomGenerator, const IGameState& gameState);
+
+    bool IsRecording() const { return _isRecording; }
+    bool CanUndo() const { return _undoCount > 0; }
+    bool CanRedo() const { return _undoCount < _moves.size(); }
+
+    // Put the board, the random generator and the game state back to how they were before (or after) the move.
+    // Returns the cells that have changed.
+    std::span<const CellChange> Undo(Board& board, BoardGenerator& boardGenerator, IGameState& gameState);
+    std::span<const CellChange> Redo(Board& board, BoardGenerator& boardGenerator, IGameState& gameState);
+
+    void Clear();
+
+private:
+    struct Move {
+        std::vector<CellChange> Changes;
+        std::array<uint64_t, 4> RandomStateBefore;
+        std::array<uint64_t, 4> RandomStateAfter;
+        GameStateValues GameStateBefore;
+        GameStateValues GameStateAfter;
+    };
+
+    // The moves that can be undone come first, followed by the ones that can be redone
+    std::deque<Move> _moves;
+    size_t _undoCount = 0;
+
+    bool _isRecording = false;
+    Move _currentMove;
+    CellMask _recordedCells;
+    // The number of rows from the top of every column that are already recorded
+    std::vector<int> _recordedRowCounts;
+};
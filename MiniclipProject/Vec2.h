@@ -1,6 +1,7 @@
 #pragma once
 
 #include <compare>
+#include <functional>
 
 struct Vec2 {
     int x;
@@ -0,0 +1,290 @@
+#include "VersusSession.h"
+
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+
+namespace {
+constexpr uint16_t PacketMagic = 0x5642; // "BV"
+constexpr uint32_t NoChecksumFrame = 0xFFFFFFFF;
+constexpr std::array<Vec2, 4> SwitchDirections = { Vec2 { 1, 0 }, Vec2 { -1, 0 }, Vec2 { 0, 1 }, Vec2 { 0, -1 } };
+
+void WriteInteger(std::vector<uint8_t>& packet, uint64_t value, int byteCount)
+{
+    for (int i = 0; i < byteCount; ++i) {
+        packet.push_back(uint8_t(value >> (8 * i)));
+    }
+}
+
+bool ReadInteger(std::span<const uint8_t> data, size_t& position, int byteCount, uint64_t& value)
+{
+    if (position + size_t(byteCount) > data.size()) {
+        return false;
+    }
+
+    value = 0;
+    for (int i = 0; i < byteCount; ++i) {
+        value |= uint64_t(data[position++]) << (8 * i);
+    }
+
+    return true;
+}
+}
+
+VersusSession::VersusSession(GameMode mode, uint64_t seed, IRenderer& renderer, IAudioSink& audioSink)
+    : _mode(mode)
+    , _localState(MakeGameState(mode))
+    , _remoteState(MakeGameState(mode))
+    , _localWorld(RowCount, ColCount, TileKindCount, renderer, audioSink, seed)
+    , _remoteWorld(RowCount, ColCount, TileKindCount, renderer, _remoteAudioSink, seed)
+{
+    _localWorld.Activate(*_localState, seed);
+    _remoteWorld.Activate(*_remoteState, seed);
+
+    // A frame's input holds a single switch, a second one would be made here but never reach the other side
+    _localWorld.SetMaxSwitchesPerFrame(1);
+    _remoteWorld.SetMaxSwitchesPerFrame(1);
+
+    _cellsSwitchedToken = _localWorld.CellsSwitched.Subscribe([this](Vec2 source, Vec2 destination) {
+        auto direction = std::find(SwitchDirections.begin(), SwitchDirections.end(), destination - source);
+        assert(direction != SwitchDirections.end());
+
+        _pendingLocalInput = FrameInput { uint8_t(direction - SwitchDirections.begin() + 1), uint16_t(source.x * RowCount + source.y) };
+    });
+}
+
+bool VersusSession::CanAdvance() const
+{
+    return _frame - _confirmedRemoteFrameCount < MaxPredictionFrames;
+}
+
+void VersusSession::AdvanceFrame()
+{
+    assert(CanAdvance());
+
+    // The switch has already been made on the local world, so it only has to be remembered for the other side
+    _localInputs[size_t(_frame % HistorySize)] = _pendingLocalInput;
+    _pendingLocalInput = FrameInput {};
+
+    _localWorld.Update(FrameTimeMs);
+    _localChecksums[size_t(_frame % HistorySize)] = GetChecksum(_localWorld, *_localState);
+    if (_localGameOverFrame < 0 && _localState->IsGameOver()) {
+        _localGameOverFrame = _frame;
+    }
+
+    SimulateRemoteFrame(_frame);
+    ++_frame;
+}
+
+bool VersusSession::ReceivePacket(std::span<const uint8_t> data)
+{
+    size_t position = 0;
+    uint64_t magic, firstFrame, inputCount;
+    if (!ReadInteger(data, position, 2, magic) || magic != PacketMagic || !ReadInteger(data, position, 4, firstFrame) || !ReadInteger(data, position, 1, inputCount)) {
+        return false;
+    }
+
+    int firstMispredictedFrame = -1;
+    for (int i = 0; i < int(inputCount); ++i) {
+        uint64_t direction, cell;
+        if (!ReadInteger(data, position, 1, direction) || !ReadInteger(data, position, 2, cell) || direction > SwitchDirections.size()) {
+            return false;
+        }
+
+        // Inputs are only taken in order, a gap is filled by the next packet
+        auto frame = int(firstFrame) + i;
+        if (frame != _confirmedRemoteFrameCount) {
+            continue;
+        }
+
+        FrameInput input { uint8_t(direction), uint16_t(cell) };
+        _remoteInputs[size_t(frame % HistorySize)] = input;
+        ++_confirmedRemoteFrameCount;
+
+        // The frames that were already played guessed that there was no switch
+        if (input.Direction != 0 && frame < _frame && firstMispredictedFrame < 0) {
+            firstMispredictedFrame = frame;
+        }
+    }
+
+    uint64_t ackedFrameCount, checksumFrame, checksum;
+    if (!ReadInteger(data, position, 4, ackedFrameCount) || !ReadInteger(data, position, 4, checksumFrame) || !ReadInteger(data, position, 8, checksum)) {
+        return false;
+    }
+    _peerAckedFrameCount = std::clamp(int(ackedFrameCount), _peerAckedFrameCount, _frame);
+
+    if (firstMispredictedFrame >= 0) {
+        Rollback(firstMispredictedFrame);
+    }
+
+    // The other side sends the checksum of its own world, compare it with ours once every input up to it is known
+    auto frame = int(checksumFrame);
+    if (checksumFrame != NoChecksumFrame && frame > _lastVerifiedFrame && frame < std::min(_frame, _confirmedRemoteFrameCount) && frame >= _frame - HistorySize) {
+        _lastVerifiedFrame = frame;
+        ++_stats.VerifiedFrameCount;
+        if (_remoteChecksums[size_t(frame % HistorySize)] != checksum) {
+            ++_stats.DesyncCount;
+        }
+    }
+
+    return true;
+}
+
+void VersusSession::WritePacket(std::vector<uint8_t>& packet) const
+{
+    // The other side can't be further behind than this, see CanAdvance
+    assert(_frame - _peerAckedFrameCount <= HistorySize);
+
+    packet.clear();
+    WriteInteger(packet, PacketMagic, 2);
+    WriteInteger(packet, uint64_t(_peerAckedFrameCount), 4);
+    WriteInteger(packet, uint64_t(_frame - _peerAckedFrameCount), 1);
+    for (int frame = _peerAckedFrameCount; frame < _frame; ++frame) {
+        const auto& input = _localInputs[size_t(frame % HistorySize)];
+        WriteInteger(packet, input.Direction, 1);
+        WriteInteger(packet, input.Cell, 2);
+    }
+
+    WriteInteger(packet, uint64_t(_confirmedRemoteFrameCount), 4);
+
+    // The last frame the other side has every input of
+    int checksumFrame = _peerAckedFrameCount - 1;
+    if (checksumFrame >= 0 && checksumFrame >= _frame - HistorySize) {
+        WriteInteger(packet, uint64_t(checksumFrame), 4);
+        WriteInteger(packet, _localChecksums[size_t(checksumFrame % HistorySize)], 8);
+    } else {
+        WriteInteger(packet, NoChecksumFrame, 4);
+        WriteInteger(packet, 0, 8);
+    }
+
+    assert(packet.size() <= MaxPacketSize);
+}
+
+GameWorld& VersusSession::GetLocalWorld()
+{
+    return _localWorld;
+}
+
+const GameWorld& VersusSession::GetRemoteWorld() const
+{
+    return _remoteWorld;
+}
+
+int VersusSession::GetFrame() const
+{
+    return _frame;
+}
+
+bool VersusSession::IsRemoteConfirmed() const
+{
+    return _confirmedRemoteFrameCount >= _frame;
+}
+
+int VersusSession::GetPeerAckedFrameCount() const
+{
+    return _peerAckedFrameCount;
+}
+
+uint64_t VersusSession::GetLocalChecksum() const
+{
+    return GetChecksum(_localWorld, *_localState);
+}
+
+uint64_t VersusSession::GetRemoteChecksum() const
+{
+    return GetChecksum(_remoteWorld, *_remoteState);
+}
+
+VersusResult VersusSession::GetResult() const
+{
+    // Only the frames of the opponent that aren't predictions count
+    int knownRemoteFrameCount = std::min(_confirmedRemoteFrameCount, _frame);
+    bool hasLocalEnded = _localGameOverFrame >= 0;
+    bool hasRemoteEnded = _remoteGameOverFrame >= 0 && _remoteGameOverFrame < knownRemoteFrameCount;
+
+    if (!hasLocalEnded && !hasRemoteEnded) {
+        return VersusResult::Undecided;
+    }
+    if (hasLocalEnded && hasRemoteEnded && _localGameOverFrame == _remoteGameOverFrame) {
+        return VersusResult::Draw;
+    }
+
+    bool hasLocalEndedFirst = hasLocalEnded && (!hasRemoteEnded || _localGameOverFrame < _remoteGameOverFrame);
+    if (hasLocalEndedFirst && !hasRemoteEnded && knownRemoteFrameCount <= _localGameOverFrame) {
+        // The opponent may still end on the same frame
+        return VersusResult::Undecided;
+    }
+
+    // Classic is a race to the score, in QuickDeath the one who survives longer wins
+    bool doesFirstToEndWin = _mode == GameMode::Classic;
+    return hasLocalEndedFirst == doesFirstToEndWin ? VersusResult::LocalWins : VersusResult::RemoteWins;
+}
+
+const VersusStats& VersusSession::GetStats() const
+{
+    return _stats;
+}
+
+void VersusSession::SimulateRemoteFrame(int frame)
+{
+    _remoteWorld.SaveSnapshot(_remoteSnapshots[size_t(frame % HistorySize)]);
+
+    if (frame < _confirmedRemoteFrameCount) {
+        ApplyInput(_remoteWorld, _remoteInputs[size_t(frame % HistorySize)]);
+    }
+
+    _remoteWorld.Update(FrameTimeMs);
+    _remoteChecksums[size_t(frame % HistorySize)] = GetChecksum(_remoteWorld, *_remoteState);
+    if (_remoteGameOverFrame < 0 && _remoteState->IsGameOver()) {
+        _remoteGameOverFrame = frame;
+    }
+}
+
+void VersusSession::Rollback(int frame)
+{
+    assert(frame < _frame && _frame - frame <= MaxPredictionFrames);
+
+    auto start = std::chrono::steady_clock::now();
+
+    _remoteWorld.RestoreSnapshot(_remoteSnapshots[size_t(frame % HistorySize)]);
+    if (_remoteGameOverFrame >= frame) {
+        _remoteGameOverFrame = -1;
+    }
+
+    for (int replayedFrame = frame; replayedFrame < _frame; ++replayedFrame) {
+        SimulateRemoteFrame(replayedFrame);
+    }
+
+    ++_stats.RollbackCount;
+    _stats.ResimulatedFrameCount += _frame - frame;
+    _stats.MaxRollbackFrames = std::max(_stats.MaxRollbackFrames, _frame - frame);
+    _stats.MaxRollbackMs = std::max(_stats.MaxRollbackMs, std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+}
+
+void VersusSession::ApplyInput(GameWorld& gameWorld, FrameInput input)
+{
+    if (input.Direction == 0) {
+        return;
+    }
+
+    Vec2 source { input.Cell / RowCount, input.Cell % RowCount };
+    Vec2 destination = source + SwitchDirections[input.Direction - 1];
+
+    // The other side only sends switches its world accepted, and this world is in the same state on that frame
+    bool isAccepted = gameWorld.IsInteractionEnabled() && gameWorld.IsIndexOnTheBoard(source) && gameWorld.IsIndexOnTheBoard(destination)
+        && gameWorld.TrySwitchCells(source, destination);
+    assert(isAccepted);
+    (void)isAccepted;
+}
+
+uint64_t VersusSession::GetChecksum(const GameWorld& gameWorld, const IGameState& gameState)
+{
+    auto values = gameState.GetValues();
+
+    uint64_t checksum = gameWorld.GetBoardHash();
+    for (auto value : { values.TimePassedMs, uint64_t(values.Score), uint64_t(values.TimeLeftMs) }) {
+        checksum = (checksum ^ value) * 0x9E3779B97F4A7C15ull;
+    }
+
+    return checksum;
+}
@@ -0,0 +1,112 @@
+#pragma once
+
+#include "Event.h"
+#include "GameMode.h"
+#include "GameState.h"
+#include "GameWorld.h"
+#include "HeadlessSinks.h"
+
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <vector>
+
+enum class VersusResult {
+    Undecided,
+    LocalWins,
+    RemoteWins,
+    Draw,
+};
+
+struct VersusStats {
+    int RollbackCount = 0;
+    int ResimulatedFrameCount = 0;
+    int MaxRollbackFrames = 0;
+    double MaxRollbackMs = 0.0;
+    // Frames of the remote world whose checksum was compared with the one the other side sent
+    int VerifiedFrameCount = 0;
+    int DesyncCount = 0;
+};
+
+// One side of a versus match: the player's own world and the opponent's, both started from the same seed.
+// The worlds only move on in whole frames of FrameTimeMs, so both sides play every frame the same way.
+// The opponent's moves arrive late, so its world is played ahead with the guess that it didn't move. When a move
+// arrives for a frame that was already played, the world is rolled back to its snapshot of that frame and the
+// frames since are played again straight away. A side can't get further than MaxPredictionFrames ahead of the
+// last move it has heard about (lockstep), which also bounds how many frames a rollback has to play again.
+//
+// The switch made on the local world (through GameWorld::TrySwitchCells, eg. by the Player or a Bot) between two
+// calls of AdvanceFrame is that frame's input. The worlds turn away any other switch until the frame is played. Packets carry every input the other side hasn't confirmed yet,
+// so a lost packet is covered by the next one.
+class VersusSession {
+public:
+    static constexpr int ColCount = 8;
+    static constexpr int RowCount = 8;
+    static constexpr int TileKindCount = 5;
+    static constexpr uint64_t FrameTimeMs = 16;
+    static constexpr int MaxPredictionFrames = 16;
+    static constexpr size_t MaxPacketSize = 64 + 3 * 4 * MaxPredictionFrames;
+
+    VersusSession(GameMode mode, uint64_t seed, IRenderer& renderer, IAudioSink& audioSink);
+
+    // False while the opponent is too far behind, the caller should keep exchanging packets and try again next frame
+    bool CanAdvance() const;
+    void AdvanceFrame();
+
+    // Returns false for packets that aren't from a versus session
+    bool ReceivePacket(std::span<const uint8_t> data);
+    // The packet to send after every frame, even if the session couldn't advance
+    void WritePacket(std::vector<uint8_t>& packet) const;
+
+    GameWorld& GetLocalWorld();
+    const GameWorld& GetRemoteWorld() const;
+    // The number of frames played so far
+    int GetFrame() const;
+    // True if every move of the opponent up to the current frame is known, so its world isn't a prediction
+    bool IsRemoteConfirmed() const;
+    // The number of local frames the other side has confirmed
+    int GetPeerAckedFrameCount() const;
+    uint64_t GetLocalChecksum() const;
+    uint64_t GetRemoteChecksum() const;
+    VersusResult GetResult() const;
+    const VersusStats& GetStats() const;
+
+private:
+    static constexpr int HistorySize = 4 * MaxPredictionFrames;
+
+    // Direction 0 is no switch, otherwise it's the index of the direction + 1 and Cell is the source
+    struct FrameInput {
+        uint8_t Direction = 0;
+        uint16_t Cell = 0;
+    };
+
+    GameMode _mode;
+    NullAudioSink _remoteAudioSink; // Frames that are played again would play their sounds again
+    std::unique_ptr<IGameState> _localState;
+    std::unique_ptr<IGameState> _remoteState;
+    GameWorld _localWorld;
+    GameWorld _remoteWorld;
+    std::unique_ptr<EventToken> _cellsSwitchedToken;
+
+    int _frame = 0;
+    FrameInput _pendingLocalInput;
+    std::array<FrameInput, HistorySize> _localInputs;
+    std::array<uint64_t, HistorySize> _localChecksums {};
+    int _localGameOverFrame = -1;
+    int _peerAckedFrameCount = 0;
+
+    int _confirmedRemoteFrameCount = 0;
+    std::array<FrameInput, HistorySize> _remoteInputs;
+    std::array<uint64_t, HistorySize> _remoteChecksums {};
+    std::array<GameWorld::Snapshot, HistorySize> _remoteSnapshots;
+    int _remoteGameOverFrame = -1;
+    int _lastVerifiedFrame = -1;
+
+    VersusStats _stats;
+
+    void SimulateRemoteFrame(int frame);
+    void Rollback(int frame);
+    static void ApplyInput(GameWorld& gameWorld, FrameInput input);
+    static uint64_t GetChecksum(const GameWorld& gameWorld, const IGameState& gameState);
+};
@@ -0,0 +1,162 @@
+#include "WorkStealingPool.h"
+
+#include <algorithm>
+#include <cassert>
+
+namespace {
+thread_local const WorkStealingPool* CurrentPool = nullptr;
+thread_local int CurrentWorkerIndex = -1;
+}
+
+WorkStealingPool::WorkStealingPool(int threadCount)
+{
+    if (threadCount <= 0) {
+        threadCount = std::max(1, int(std::thread::hardware_concurrency()));
+    }
+
+    for (int i = 0; i < threadCount; ++i) {
+        _workers.push_back(std::make_unique<Worker>());
+    }
+
+    for (int i = 0; i < threadCount; ++i) {
+        _threads.emplace_back([this, i]() { RunWorker(i); });
+    }
+}
+
+WorkStealingPool::~WorkStealingPool()
+{
+    Wait();
+
+    {
+        std::lock_guard lock(_sleepMutex);
+        _isStopping = true;
+    }
+    _taskAvailable.notify_all();
+
+    for (auto& thread : _threads) {
+        thread.join();
+    }
+}
+
+int WorkStealingPool::GetThreadCount() const
+{
+    return int(_threads.size());
+}
+
+int WorkStealingPool::GetCurrentWorkerIndex() const
+{
+    return CurrentPool == this ? CurrentWorkerIndex : -1;
+}
+
+void WorkStealingPool::Submit(std::function<void()> task)
+{
+    auto workerIndex = GetCurrentWorkerIndex();
+    if (workerIndex < 0) {
+        workerIndex = int(_nextExternalQueue++ % _workers.size());
+    }
+
+    _unfinishedTaskCount++;
+
+    // Counting under the lock makes sure that a worker which just found no tasks is either already waiting
+    // (and gets the notification) or sees the new count
+    {
+        std::lock_guard lock(_sleepMutex);
+        _queuedTaskCount++;
+    }
+
+    {
+        auto& worker = *_workers[workerIndex];
+        std::lock_guard lock(worker.Mutex);
+        worker.Tasks.push_back(std::move(task));
+    }
+
+    _taskAvailable.notify_one();
+}
+
+void WorkStealingPool::Wait()
+{
+    // A worker waiting for the other tasks could wait for itself
+    assert(GetCurrentWorkerIndex() < 0);
+
+    std::unique_lock lock(_sleepMutex);
+    _allTasksDone.wait(lock, [this]() { return _unfinishedTaskCount == 0; });
+}
+
+void WorkStealingPool::ParallelFor(size_t count, const std::function<void(size_t)>& body)
+{
+    if (count == 0) {
+        return;
+    }
+
+    Submit([this, count, &body]() { SplitRange(0, count, body); });
+    Wait();
+}
+
+void WorkStealingPool::RunWorker(int workerIndex)
+{
+    CurrentPool = this;
+    CurrentWorkerIndex = workerIndex;
+
+    std::function<void()> task;
+
+    while (true) {
+        if (TryPopTask(workerIndex, task)) {
+            task();
+            task = nullptr;
+
+            if (--_unfinishedTaskCount == 0) {
+                std::lock_guard lock(_sleepMutex);
+                _allTasksDone.notify_all();
+            }
+            continue;
+        }
+
+        std::unique_lock lock(_sleepMutex);
+        _taskAvailable.wait(lock, [this]() { return _isStopping || _queuedTaskCount > 0; });
+
+        if (_isStopping && _queuedTaskCount == 0) {
+            return;
+        }
+    }
+}
+
+bool WorkStealingPool::TryPopTask(int workerIndex, std::function<void()>& task)
+{
+    // Newest task of our own queue first, it is the most likely to still be in the cache
+    {
+        auto& worker = *_workers[workerIndex];
+        std::lock_guard lock(worker.Mutex);
+        if (!worker.Tasks.empty()) {
+            task = std::move(worker.Tasks.back());
+            worker.Tasks.pop_back();
+            _queuedTaskCount--;
+            return true;
+        }
+    }
+
+    // Then the oldest task of someone else, which is usually the biggest piece of a split range
+    for (size_t i = 1; i < _workers.size(); ++i) {
+        auto& victim = *_workers[(workerIndex + i) % _workers.size()];
+        std::lock_guard lock(victim.Mutex);
+        if (!victim.Tasks.empty()) {
+            task = std::move(victim.Tasks.front());
+            victim.Tasks.pop_front();
+            _queuedTaskCount--;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void WorkStealingPool::SplitRange(size_t begin, size_t end, const std::function<void(size_t)>& body)
+{
+    // Keep the first element for ourselves and offer the upper halves to the other workers
+    while (end - begin > 1) {
+        auto middle = begin + (end - begin) / 2;
+        Submit([this, middle, end, &body]() { SplitRange(middle, end, body); });
+        end = middle;
+    }
+
+    body(begin);
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// A fixed set of worker threads, each with its own task queue. Workers take their newest task first
+// and when they run out, they steal the oldest task of another worker. Tasks submitted from a worker go
+// to its own queue, so tasks that split their work keep the pieces local until someone else is idle.
+class WorkStealingPool {
+public:
+    // With 0 threads, one thread is started for every hardware thread
+    explicit WorkStealingPool(int threadCount = 0);
+    ~WorkStealingPool();
+
+    WorkStealingPool(const WorkStealingPool&) = delete;
+    WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+
+    int GetThreadCount() const;
+    // The index of the worker running the calling code, or -1 when called from outside of the pool
+    int GetCurrentWorkerIndex() const;
+
+    void Submit(std::function<void()> task);
+    // Blocks until every submitted task (and the tasks they submitted) has finished. Can't be called from a task.
+    void Wait();
+
+    // Calls body(i) for every i in [0, count) as a separate task and waits for all of them.
+    // The range is split in halves lazily, so only a few tasks are queued at any time.
+    void ParallelFor(size_t count, const std::function<void(size_t)>& body);
+
+private:
+    struct Worker {
+        std::mutex Mutex;
+        std::deque<std::function<void()>> Tasks;
+    };
+
+    std::vector<std::unique_ptr<Worker>> _workers;
+    std::vector<std::thread> _threads;
+
+    std::mutex _sleepMutex;
+    std::condition_variable _taskAvailable;
+    std::condition_variable _allTasksDone;
+    std::atomic<size_t> _queuedTaskCount = 0;
+    std::atomic<size_t> _unfinishedTaskCount = 0;
+    std::atomic<size_t> _nextExternalQueue = 0;
+    bool _isStopping = false;
+
+    void RunWorker(int workerIndex);
+    bool TryPopTask(int workerIndex, std::function<void()>& task);
+    void SplitRange(size_t begin, size_t end, const std::function<void(size_t)>& body);
+};
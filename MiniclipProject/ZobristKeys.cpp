@@ -0,0 +1,69 @@
+#include "ZobristKeys.h"
+
+#include "RandomGenerator.h"
+
+namespace {
+// Any constant would do, it only has to be the same in every run
+constexpr uint64_t KeySeed = 0x5A0B8157C0FFEE42ull;
+}
+
+ZobristKeys::ZobristKeys(int colCount, int rowCount, int tileKindCount)
+    : _colCount(colCount)
+    , _rowCount(rowCount)
+    , _tileKindCount(tileKindCount)
+    , _keys(size_t(colCount) * rowCount * tileKindCount)
+{
+    RandomGenerator random(KeySeed);
+    for (auto& key : _keys) {
+        key = random.Next();
+    }
+}
+
+uint64_t ZobristKeys::Hash(const Board& board) const
+{
+    assert(board.GetColCount() == _colCount && board.GetRowCount() == _rowCount);
+
+    uint64_t hash = 0;
+    const uint8_t* types = board.TypeData();
+    const CellState* states = board.StateData();
+
+    for (size_t cell = 0; cell < size_t(_colCount) * _rowCount; ++cell) {
+        if (states[cell] != CellState::Destroyed) {
+            hash ^= _keys[cell * _tileKindCount + types[cell]];
+        }
+    }
+
+    return hash;
+}
+
+uint64_t ZobristKeys::HashAfterSwap(uint64_t hash, const Board& board, Vec2 lhs, Vec2 rhs) const
+{
+    auto lhsType = board.Type(lhs);
+    auto rhsType = board.Type(rhs);
+
+    return hash ^ GetKey(lhs, lhsType) ^ GetKey(rhs, rhsType) ^ GetKey(lhs, rhsType) ^ GetKey(rhs, lhsType);
+}
+
+uint64_t ZobristKeys::HashAfterDestruction(uint64_t hash, const Board& board, const std::vector<Vec2>& destroyedCells) const
+{
+    for (auto cell : destroyedCells) {
+        hash ^= GetKey(cell, board.Type(cell));
+    }
+
+    return hash;
+}
+
+uint64_t ZobristKeys::HashAfterGravity(uint64_t hash, const Board& board, const GravityResult& gravityResult) const
+{
+    // A moved tile is now at To, so that's where its type is read from
+    for (const auto& [from, to] : gravityResult.GetMoves()) {
+        auto type = board.Type(to);
+        hash ^= GetKey(from, type) ^ GetKey(to, type);
+    }
+
+    for (const auto& [from, to, type] : gravityResult.GetSpawnedTiles()) {
+        hash ^= GetKey(to, type);
+    }
+
+    return hash;
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+#include "Board.h"
+#include "CascadeResolver.h"
+#include "Vec2.h"
+
+#include <cassert>
+#include <cstdint>
+#include <vector>
+
+// A random 64 bit key for every cell and tile kind of a board size. The hash of a board is the XOR of the keys of its tiles
+// (destroyed cells have no tile), so a change to a few cells updates the hash by XOR-ing just their keys in and out.
+// The keys only depend on the board size, so the same position has the same hash in every run.
+class ZobristKeys {
+public:
+    ZobristKeys(int colCount, int rowCount, int tileKindCount);
+
+    uint64_t GetKey(Vec2 index, uint8_t type) const
+    {
+        assert(index.x >= 0 && index.x < _colCount && index.y >= 0 && index.y < _rowCount && type < _tileKindCount);
+        return _keys[(size_t(index.x) * _rowCount + index.y) * _tileKindCount + type];
+    }
+
+    uint64_t Hash(const Board& board) const;
+
+    // The incremental versions below take the hash of the board before the change
+
+    // board is the one before the switch
+    uint64_t HashAfterSwap(uint64_t hash, const Board& board, Vec2 lhs, Vec2 rhs) const;
+    // board still holds the types of the destroyed cells
+    uint64_t HashAfterDestruction(uint64_t hash, const Board& board, const std::vector<Vec2>& destroyedCells) const;
+    // board is the one after the gravity, destroyed cells were already removed from the hash
+    uint64_t HashAfterGravity(uint64_t hash, const Board& board, const GravityResult& gravityResult) const;
+
+private:
+    int _colCount;
+    int _rowCount;
+    int _tileKindCount;
+
+    // Column major like Board, the keys of every kind of a cell one after the other
+    std::vector<uint64_t> _keys;
+};